@@ -619,6 +619,17 @@ static bool audiod_set_fb_params_freq(audiod_function_t* audio, uint32_t sample_
 static void audiod_fb_fifo_count_update(audiod_function_t* audio, uint16_t lvl_new);
 #endif
 
+// Audio API and packet math are 16-bit while fifo count is 32-bit with CFG_TUSB_FIFO_WIDE_INDEX
+TU_ATTR_ALWAYS_INLINE static inline uint16_t audiod_ff_count(tu_fifo_t* ff)
+{
+  return (uint16_t) tu_min32(tu_fifo_count(ff), UINT16_MAX);
+}
+
+TU_ATTR_ALWAYS_INLINE static inline uint16_t audiod_ff_depth(tu_fifo_t const* ff)
+{
+  return (uint16_t) tu_min32(ff->depth, UINT16_MAX);
+}
+
 bool tud_audio_n_mounted(uint8_t func_id)
 {
   TU_VERIFY(func_id < CFG_TUD_AUDIO);
@@ -636,13 +647,13 @@ bool tud_audio_n_mounted(uint8_t func_id)
 uint16_t tud_audio_n_available(uint8_t func_id)
 {
   TU_VERIFY(func_id < CFG_TUD_AUDIO && _audiod_fct[func_id].p_desc != NULL);
-  return tu_fifo_count(&_audiod_fct[func_id].ep_out_ff);
+  return audiod_ff_count(&_audiod_fct[func_id].ep_out_ff);
 }
 
 uint16_t tud_audio_n_read(uint8_t func_id, void* buffer, uint16_t bufsize)
 {
   TU_VERIFY(func_id < CFG_TUD_AUDIO && _audiod_fct[func_id].p_desc != NULL);
-  return tu_fifo_read_n(&_audiod_fct[func_id].ep_out_ff, buffer, bufsize);
+  return (uint16_t) tu_fifo_read_n(&_audiod_fct[func_id].ep_out_ff, buffer, bufsize);
 }
 
 bool tud_audio_n_clear_ep_out_ff(uint8_t func_id)
@@ -670,13 +681,13 @@ bool tud_audio_n_clear_rx_support_ff(uint8_t func_id, uint8_t ff_idx)
 uint16_t tud_audio_n_available_support_ff(uint8_t func_id, uint8_t ff_idx)
 {
   TU_VERIFY(func_id < CFG_TUD_AUDIO && _audiod_fct[func_id].p_desc != NULL && ff_idx < _audiod_fct[func_id].n_rx_supp_ff);
-  return tu_fifo_count(&_audiod_fct[func_id].rx_supp_ff[ff_idx]);
+  return audiod_ff_count(&_audiod_fct[func_id].rx_supp_ff[ff_idx]);
 }
 
 uint16_t tud_audio_n_read_support_ff(uint8_t func_id, uint8_t ff_idx, void* buffer, uint16_t bufsize)
 {
   TU_VERIFY(func_id < CFG_TUD_AUDIO && _audiod_fct[func_id].p_desc != NULL && ff_idx < _audiod_fct[func_id].n_rx_supp_ff);
-  return tu_fifo_read_n(&_audiod_fct[func_id].rx_supp_ff[ff_idx], buffer, bufsize);
+  return (uint16_t) tu_fifo_read_n(&_audiod_fct[func_id].rx_supp_ff[ff_idx], buffer, bufsize);
 }
 
 tu_fifo_t* tud_audio_n_get_rx_support_ff(uint8_t func_id, uint8_t ff_idx)
@@ -755,7 +766,7 @@ static bool audiod_rx_done_cb(uint8_t rhport, audiod_function_t* audio, uint16_t
 #if CFG_TUD_AUDIO_ENABLE_FEEDBACK_EP
   if(audio->feedback.compute_method == AUDIO_FEEDBACK_METHOD_FIFO_COUNT)
   {
-    audiod_fb_fifo_count_update(audio, tu_fifo_count(&audio->ep_out_ff));
+    audiod_fb_fifo_count_update(audio, audiod_ff_count(&audio->ep_out_ff));
   }
 #endif
 
@@ -847,13 +858,13 @@ static bool audiod_decode_type_I_pcm(uint8_t rhport, audiod_function_t* audio, u
 
     if (info.len_lin != 0)
     {
-      info.len_lin = tu_min16(nBytesPerFFToRead, info.len_lin);
+      info.len_lin = (tu_fifo_size_t) tu_min32(nBytesPerFFToRead, info.len_lin);
       src = &audio->lin_buf_out[cnt_ff*audio->n_channels_per_ff_rx * audio->n_bytes_per_sample_rx];
       dst_end = info.ptr_lin + info.len_lin;
       src = audiod_interleaved_copy_bytes_fast_decode(audio->n_bytes_per_sample_rx, info.ptr_lin, dst_end, src, n_ff_used);
 
       // Handle wrapped part of FIFO
-      info.len_wrap = tu_min16(nBytesPerFFToRead - info.len_lin, info.len_wrap);
+      info.len_wrap = (tu_fifo_size_t) tu_min32(nBytesPerFFToRead - info.len_lin, info.len_wrap);
       if (info.len_wrap != 0)
       {
         dst_end = info.ptr_wrap + info.len_wrap;
@@ -869,7 +880,7 @@ static bool audiod_decode_type_I_pcm(uint8_t rhport, audiod_function_t* audio, u
 #if CFG_TUD_AUDIO_ENABLE_FEEDBACK_EP
   if(audio->feedback.compute_method == AUDIO_FEEDBACK_METHOD_FIFO_COUNT)
   {
-    audiod_fb_fifo_count_update(audio, tu_fifo_count(&audio->rx_supp_ff[0]));
+    audiod_fb_fifo_count_update(audio, audiod_ff_count(&audio->rx_supp_ff[0]));
   }
 #endif
 
@@ -897,7 +908,7 @@ static bool audiod_decode_type_I_pcm(uint8_t rhport, audiod_function_t* audio, u
 uint16_t tud_audio_n_write(uint8_t func_id, const void * data, uint16_t len)
 {
   TU_VERIFY(func_id < CFG_TUD_AUDIO && _audiod_fct[func_id].p_desc != NULL);
-  return tu_fifo_write_n(&_audiod_fct[func_id].ep_in_ff, data, len);
+  return (uint16_t) tu_fifo_write_n(&_audiod_fct[func_id].ep_in_ff, data, len);
 }
 
 bool tud_audio_n_clear_ep_in_ff(uint8_t func_id)                          // Delete all content in the EP IN FIFO
@@ -921,14 +932,13 @@ uint16_t tud_audio_n_flush_tx_support_ff(uint8_t func_id)                 // For
   TU_VERIFY(func_id < CFG_TUD_AUDIO && _audiod_fct[func_id].p_desc != NULL);
   audiod_function_t* audio = &_audiod_fct[func_id];
 
-  uint16_t n_bytes_copied = tu_fifo_count(&audio->tx_supp_ff[0]);
+  tu_fifo_size_t const count = tu_fifo_count(&audio->tx_supp_ff[0]);
 
   TU_VERIFY(audiod_tx_done_cb(audio->rhport, audio));
 
-  n_bytes_copied -= tu_fifo_count(&audio->tx_supp_ff[0]);
-  n_bytes_copied = n_bytes_copied*audio->tx_supp_ff[0].item_size;
+  uint32_t const n_bytes_copied = (uint32_t) (count - tu_fifo_count(&audio->tx_supp_ff[0])) * audio->tx_supp_ff[0].item_size;
 
-  return n_bytes_copied;
+  return (uint16_t) tu_min32(n_bytes_copied, UINT16_MAX);
 }
 
 bool tud_audio_n_clear_tx_support_ff(uint8_t func_id, uint8_t ff_idx)
@@ -940,7 +950,7 @@ bool tud_audio_n_clear_tx_support_ff(uint8_t func_id, uint8_t ff_idx)
 uint16_t tud_audio_n_write_support_ff(uint8_t func_id, uint8_t ff_idx, const void * data, uint16_t len)
 {
   TU_VERIFY(func_id < CFG_TUD_AUDIO && _audiod_fct[func_id].p_desc != NULL && ff_idx < _audiod_fct[func_id].n_tx_supp_ff);
-  return tu_fifo_write_n(&_audiod_fct[func_id].tx_supp_ff[ff_idx], data, len);
+  return (uint16_t) tu_fifo_write_n(&_audiod_fct[func_id].tx_supp_ff[ff_idx], data, len);
 }
 
 tu_fifo_t* tud_audio_n_get_tx_support_ff(uint8_t func_id, uint8_t ff_idx)
@@ -1044,9 +1054,9 @@ static bool audiod_tx_done_cb(uint8_t rhport, audiod_function_t * audio)
   // No support FIFOs, if no linear buffer required schedule transmit, else put data into linear buffer and schedule
 #if CFG_TUD_AUDIO_EP_IN_FLOW_CONTROL
   // packet_sz_tx is based on total packet size, here we want size for each support buffer.
-  n_bytes_tx = audiod_tx_packet_size(audio->packet_sz_tx, tu_fifo_count(&audio->ep_in_ff), audio->ep_in_ff.depth, audio->ep_in_sz);
+  n_bytes_tx = audiod_tx_packet_size(audio->packet_sz_tx, audiod_ff_count(&audio->ep_in_ff), audiod_ff_depth(&audio->ep_in_ff), audio->ep_in_sz);
 #else
-  n_bytes_tx = tu_min16(tu_fifo_count(&audio->ep_in_ff), audio->ep_in_sz);      // Limit up to max packet size, more can not be done for ISO
+  n_bytes_tx = (uint16_t) tu_min32(tu_fifo_count(&audio->ep_in_ff), audio->ep_in_sz);      // Limit up to max packet size, more can not be done for ISO
 #endif
 #if USE_LINEAR_BUFFER_TX
   tu_fifo_read_n(&audio->ep_in_ff, audio->lin_buf_in, n_bytes_tx);
@@ -1146,12 +1156,12 @@ static uint16_t audiod_encode_type_I_pcm(uint8_t rhport, audiod_function_t* audi
 
   // Determine amount of samples
   uint8_t const n_ff_used               = audio->n_ff_used_tx;
-  uint16_t nBytesPerFFToSend            = tu_fifo_count(&audio->tx_supp_ff[0]);
+  uint16_t nBytesPerFFToSend            = audiod_ff_count(&audio->tx_supp_ff[0]);
   uint8_t cnt_ff;
 
   for (cnt_ff = 1; cnt_ff < n_ff_used; cnt_ff++)
   {
-    uint16_t const count = tu_fifo_count(&audio->tx_supp_ff[cnt_ff]);
+    uint16_t const count = audiod_ff_count(&audio->tx_supp_ff[cnt_ff]);
     if (count < nBytesPerFFToSend)
     {
       nBytesPerFFToSend = count;
@@ -1163,7 +1173,7 @@ static uint16_t audiod_encode_type_I_pcm(uint8_t rhport, audiod_function_t* audi
                                          audio->packet_sz_tx[1] / n_ff_used,
                                          audio->packet_sz_tx[2] / n_ff_used};
   // packet_sz_tx is based on total packet size, here we want size for each support buffer.
-  nBytesPerFFToSend = audiod_tx_packet_size(norm_packet_sz_tx, nBytesPerFFToSend, audio->tx_supp_ff[0].depth, audio->ep_in_sz / n_ff_used);
+  nBytesPerFFToSend = audiod_tx_packet_size(norm_packet_sz_tx, nBytesPerFFToSend, audiod_ff_depth(&audio->tx_supp_ff[0]), audio->ep_in_sz / n_ff_used);
   // Check if there is enough data
   if (nBytesPerFFToSend == 0)    return 0;
 #else
@@ -1190,12 +1200,12 @@ static uint16_t audiod_encode_type_I_pcm(uint8_t rhport, audiod_function_t* audi
 
     if (info.len_lin != 0)
     {
-      info.len_lin = tu_min16(nBytesPerFFToSend, info.len_lin);       // Limit up to desired length
+      info.len_lin = (tu_fifo_size_t) tu_min32(nBytesPerFFToSend, info.len_lin);       // Limit up to desired length
       src_end = (uint8_t *)info.ptr_lin + info.len_lin;
       dst = audiod_interleaved_copy_bytes_fast_encode(audio->n_bytes_per_sample_tx, info.ptr_lin, src_end, dst, n_ff_used);
 
       // Limit up to desired length
-      info.len_wrap = tu_min16(nBytesPerFFToSend - info.len_lin, info.len_wrap);
+      info.len_wrap = (tu_fifo_size_t) tu_min32(nBytesPerFFToSend - info.len_lin, info.len_wrap);
 
       // Handle wrapped part of FIFO
       if (info.len_wrap != 0)
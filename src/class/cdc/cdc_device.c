@@ -50,26 +50,48 @@ typedef struct {
   uint8_t ep_notif;
   uint8_t ep_in;
   uint8_t ep_out;
+  uint16_t ep_in_mps;
+#if CFG_TUD_CDC_RX_DIRECT
+  uint16_t ep_out_mps;
+#endif
 
   // Bit 0:  DTR (Data Terminal Ready), Bit 1: RTS (Request to Send)
   uint8_t line_state;
 
+#if CFG_TUD_CDC_TX_FLUSH_MS
+  // flush timer, started on first SOF after it is armed. Both volatile so that started is cleared before armed
+  // is seen by SOF handler
+  volatile bool tx_timer_armed;
+  volatile bool tx_timer_started;
+  uint16_t tx_timer_frame;
+#endif
+
   /*------------- From this point, data is not cleared by bus reset -------------*/
   char wanted_char;
+  uint8_t line_delim_count;
+  uint8_t line_delim[CFG_TUD_CDC_LINE_DELIM_MAX];
+  uint32_t rx_line_len; // bytes received since last line delimiter
   TU_ATTR_ALIGNED(4) cdc_line_coding_t line_coding;
 
   // FIFO
   tu_fifo_t rx_ff;
   tu_fifo_t tx_ff;
 
-  uint8_t rx_ff_buf[CFG_TUD_CDC_RX_BUFSIZE];
+  CFG_TUSB_MEM_ALIGN uint8_t rx_ff_buf[CFG_TUD_CDC_RX_BUFSIZE];
   uint8_t tx_ff_buf[CFG_TUD_CDC_TX_BUFSIZE];
 
   OSAL_MUTEX_DEF(rx_ff_mutex);
   OSAL_MUTEX_DEF(tx_ff_mutex);
 
+#if CFG_TUD_CDC_RX_DIRECT
+  // rx fifo space of current OUT transfer
+  tu_fifo_buffer_info_t rx_info;
+#endif
+
   // Endpoint Transfer buffer
+#if CFG_TUD_CDC_RX_DIRECT != 2
   CFG_TUSB_MEM_ALIGN uint8_t epout_buf[CFG_TUD_CDC_EP_BUFSIZE];
+#endif
   CFG_TUSB_MEM_ALIGN uint8_t epin_buf[CFG_TUD_CDC_EP_BUFSIZE];
 } cdcd_interface_t;
 
@@ -87,7 +109,45 @@ static bool _prep_out_transaction (cdcd_interface_t* p_cdc) {
   // Skip if usb is not ready yet
   TU_VERIFY(tud_ready() && p_cdc->ep_out);
 
-  uint16_t available = tu_fifo_remaining(&p_cdc->rx_ff);
+#if CFG_TUD_CDC_RX_DIRECT
+  // Transfer length must be multiple of packet size, arm as long as one packet fits
+  uint16_t const mps = p_cdc->ep_out_mps;
+  TU_VERIFY(tu_fifo_remaining(&p_cdc->rx_ff) >= mps);
+
+  // claim endpoint
+  TU_VERIFY(usbd_edpt_claim(rhport, p_cdc->ep_out));
+
+  // fifo can be changed before endpoint is claimed
+  tu_fifo_buffer_info_t* info = &p_cdc->rx_info;
+  tu_fifo_get_write_info(&p_cdc->rx_ff, info);
+  uint32_t const available = (uint32_t) info->len_lin + info->len_wrap;
+
+  #if CFG_TUD_CDC_RX_DIRECT == 2
+  if (available >= mps) {
+    uint16_t const len = (uint16_t) (tu_min32(available, UINT16_MAX) / mps * mps);
+    return usbd_edpt_xfer_fifo(rhport, p_cdc->ep_out, &p_cdc->rx_ff, len);
+  }
+  #else
+  // controller DMA may require aligned buffer, fifo position is unaligned after a short packet
+  if (info->len_lin >= mps && 0 == (((uintptr_t) info->ptr_lin) & 3u)) {
+    uint16_t const len = (uint16_t) (tu_min32(info->len_lin, UINT16_MAX) / mps * mps);
+    return usbd_edpt_xfer(rhport, p_cdc->ep_out, (uint8_t*) info->ptr_lin, len);
+  }
+
+  if (available >= mps) {
+    // less than a packet before wrap-around point or unaligned, receive one packet in endpoint buffer
+    info->ptr_lin  = p_cdc->epout_buf;
+    info->len_lin  = mps;
+    info->len_wrap = 0;
+    return usbd_edpt_xfer(rhport, p_cdc->ep_out, p_cdc->epout_buf, mps);
+  }
+  #endif
+
+  // Release endpoint since we don't make any transfer
+  usbd_edpt_release(rhport, p_cdc->ep_out);
+  return false;
+#else
+  uint32_t available = tu_fifo_remaining(&p_cdc->rx_ff);
 
   // Prepare for incoming data but only allow what we can store in the ring buffer.
   // TODO Actually we can still carry out the transfer, keeping count of received bytes
@@ -108,8 +168,116 @@ static bool _prep_out_transaction (cdcd_interface_t* p_cdc) {
     usbd_edpt_release(rhport, p_cdc->ep_out);
     return false;
   }
+#endif
 }
 
+//--------------------------------------------------------------------+
+// Receive scan
+//--------------------------------------------------------------------+
+
+TU_ATTR_WEAK uint32_t tud_cdc_rx_scan_cb(uint8_t const* buf, uint32_t len, uint8_t const* set, uint8_t set_count) {
+  if (set_count == 1) {
+    uint8_t const* found = (uint8_t const*) memchr(buf, set[0], len);
+    return found ? (uint32_t) (found - buf) : len;
+  }
+
+  uint32_t i = 0;
+
+  // skip words without any of set: a word has byte c if (word ^ c repeated) has a zero byte
+  for (; i + 4 <= len; i += 4) {
+    uint32_t word;
+    memcpy(&word, buf + i, 4);
+
+    uint32_t hit = 0;
+    for (uint8_t s = 0; s < set_count; s++) {
+      uint32_t const x = word ^ (0x01010101u * set[s]);
+      hit |= (x - 0x01010101u) & ~x & 0x80808080u;
+    }
+    if (hit) break;
+  }
+
+  for (; i < len; i++) {
+    if (memchr(set, buf[i], set_count)) return i;
+  }
+
+  return len;
+}
+
+// Invoke wanted char and line callbacks for received data already in rx fifo: buf holds count bytes followed by
+// (tail - count) more bytes of the same transfer
+static void _rx_scan(uint8_t itf, cdcd_interface_t* p_cdc, uint8_t const* buf, uint32_t count, uint32_t tail) {
+  uint8_t set[CFG_TUD_CDC_LINE_DELIM_MAX + 1];
+  uint8_t set_count = 0;
+
+  bool const wanted = tud_cdc_rx_wanted_cb && (((signed char) p_cdc->wanted_char) != -1);
+  if (wanted) set[set_count++] = (uint8_t) p_cdc->wanted_char;
+
+  bool const line = tud_cdc_rx_line_cb && p_cdc->line_delim_count;
+  if (line) {
+    memcpy(&set[set_count], p_cdc->line_delim, p_cdc->line_delim_count);
+    set_count += p_cdc->line_delim_count;
+  }
+
+  if (!set_count) return;
+
+  uint32_t line_start = 0;
+  uint32_t pos = 0;
+
+  while (pos < count) {
+    uint32_t const i = pos + tud_cdc_rx_scan_cb(buf + pos, count - pos, set, set_count);
+    if (i >= count) break;
+
+    if (wanted && (buf[i] == (uint8_t) p_cdc->wanted_char) && !tu_fifo_empty(&p_cdc->rx_ff)) {
+      tud_cdc_rx_wanted_cb(itf, p_cdc->wanted_char);
+    }
+
+    if (line && memchr(p_cdc->line_delim, buf[i], p_cdc->line_delim_count)) {
+      // offset is relative to read position, callbacks may have consumed data meanwhile
+      uint32_t const ff_count = tu_fifo_count(&p_cdc->rx_ff);
+      uint32_t const after = tail - i - 1;
+      uint32_t const end = (ff_count > after) ? (ff_count - after) : 0;
+      uint32_t const len = tu_min32(p_cdc->rx_line_len + i + 1 - line_start, end);
+
+      p_cdc->rx_line_len = 0;
+      line_start = i + 1;
+      if (len) tud_cdc_rx_line_cb(itf, end - len, len);
+    }
+
+    pos = i + 1;
+  }
+
+  if (line) p_cdc->rx_line_len += count - line_start;
+}
+
+#if CFG_TUD_CDC_TX_FLUSH_MS
+static bool _tx_timer_any_armed(void) {
+  for (uint8_t i = 0; i < CFG_TUD_CDC; i++) {
+    if (_cdcd_itf[i].tx_timer_armed) return true;
+  }
+  return false;
+}
+
+// Flush on timer expiry in task context, SOF is stopped once no interface waits for it
+static void _tx_timer_expired(void* param) {
+  cdcd_interface_t* p_cdc = (cdcd_interface_t*) param;
+  tud_cdc_n_write_flush((uint8_t) (p_cdc - _cdcd_itf));
+
+  if (_tx_timer_any_armed()) return;
+  usbd_sof_enable(0, SOF_CONSUMER_CDC, false);
+
+  // tud_cdc_n_write() in another task may arm between the scan and the disable. Arm sets tx_timer_armed before
+  // enabling SOF, check again so that its timer is not left without SOF
+  if (_tx_timer_any_armed()) usbd_sof_enable(0, SOF_CONSUMER_CDC, true);
+}
+
+static void _tx_timer_arm(cdcd_interface_t* p_cdc) {
+  if (p_cdc->tx_timer_armed) return;
+  p_cdc->tx_timer_started = false;
+  p_cdc->tx_timer_armed = true;
+  usbd_sof_enable(0, SOF_CONSUMER_CDC, true);
+}
+#endif
+
 //--------------------------------------------------------------------+
 // APPLICATION API
 //--------------------------------------------------------------------+
@@ -141,6 +309,16 @@ void tud_cdc_n_set_wanted_char(uint8_t itf, char wanted) {
   _cdcd_itf[itf].wanted_char = wanted;
 }
 
+bool tud_cdc_n_set_line_delimiters(uint8_t itf, char const* delims, uint8_t count) {
+  TU_VERIFY(count <= CFG_TUD_CDC_LINE_DELIM_MAX);
+  cdcd_interface_t* p_cdc = &_cdcd_itf[itf];
+  p_cdc->line_delim_count = 0;
+  if (count) memcpy(p_cdc->line_delim, delims, count);
+  p_cdc->rx_line_len = 0;
+  p_cdc->line_delim_count = count;
+  return true;
+}
+
 //--------------------------------------------------------------------+
 // READ API
 //--------------------------------------------------------------------+
@@ -150,7 +328,7 @@ uint32_t tud_cdc_n_available(uint8_t itf) {
 
 uint32_t tud_cdc_n_read(uint8_t itf, void* buffer, uint32_t bufsize) {
   cdcd_interface_t* p_cdc = &_cdcd_itf[itf];
-  uint32_t num_read = tu_fifo_read_n(&p_cdc->rx_ff, buffer, (uint16_t) TU_MIN(bufsize, UINT16_MAX));
+  uint32_t num_read = tu_fifo_read_n(&p_cdc->rx_ff, buffer, (tu_fifo_size_t) TU_MIN(bufsize, TU_FIFO_DEPTH_MAX));
   _prep_out_transaction(p_cdc);
   return num_read;
 }
@@ -159,9 +337,26 @@ bool tud_cdc_n_peek(uint8_t itf, uint8_t* chr) {
   return tu_fifo_peek(&_cdcd_itf[itf].rx_ff, chr);
 }
 
+uint32_t tud_cdc_n_read_reserve(uint8_t itf, void** ptr, uint32_t bufsize) {
+  return tu_fifo_read_reserve(&_cdcd_itf[itf].rx_ff, ptr, (tu_fifo_size_t) TU_MIN(bufsize, TU_FIFO_DEPTH_MAX));
+}
+
+uint32_t tud_cdc_n_read_commit(uint8_t itf, uint32_t count) {
+  cdcd_interface_t* p_cdc = &_cdcd_itf[itf];
+  uint32_t const num_read = tu_fifo_read_commit(&p_cdc->rx_ff, (tu_fifo_size_t) TU_MIN(count, TU_FIFO_DEPTH_MAX));
+  _prep_out_transaction(p_cdc);
+  return num_read;
+}
+
 void tud_cdc_n_read_flush(uint8_t itf) {
   cdcd_interface_t* p_cdc = &_cdcd_itf[itf];
+#if CFG_TUD_CDC_RX_DIRECT
+  // OUT transfer may be writing into fifo: only discard what is readable, write pointer must stay
+  tu_fifo_advance_read_pointer(&p_cdc->rx_ff, tu_fifo_count(&p_cdc->rx_ff));
+#else
   tu_fifo_clear(&p_cdc->rx_ff);
+#endif
+  p_cdc->rx_line_len = 0;
   _prep_out_transaction(p_cdc);
 }
 
@@ -170,8 +365,17 @@ void tud_cdc_n_read_flush(uint8_t itf) {
 //--------------------------------------------------------------------+
 uint32_t tud_cdc_n_write(uint8_t itf, void const* buffer, uint32_t bufsize) {
   cdcd_interface_t* p_cdc = &_cdcd_itf[itf];
-  uint16_t ret = tu_fifo_write_n(&p_cdc->tx_ff, buffer, (uint16_t) TU_MIN(bufsize, UINT16_MAX));
+  uint32_t ret = tu_fifo_write_n(&p_cdc->tx_ff, buffer, (tu_fifo_size_t) TU_MIN(bufsize, TU_FIFO_DEPTH_MAX));
+
+#if CFG_TUD_CDC_TX_FLUSH_MS
+  // flush if queue a full transfer, timer sends the rest
+  if (tu_fifo_count(&p_cdc->tx_ff) >= TU_MIN(CFG_TUD_CDC_EP_BUFSIZE, CFG_TUD_CDC_TX_BUFSIZE)) {
+    tud_cdc_n_write_flush(itf);
+  }
 
+  // data left while a transfer is in progress is sent on its completion
+  if (ret && tu_fifo_count(&p_cdc->tx_ff) && !usbd_edpt_busy(0, p_cdc->ep_in)) _tx_timer_arm(p_cdc);
+#else
   // flush if queue more than packet size
   if (tu_fifo_count(&p_cdc->tx_ff) >= BULK_PACKET_SIZE
       #if CFG_TUD_CDC_TX_BUFSIZE < BULK_PACKET_SIZE
@@ -180,6 +384,7 @@ uint32_t tud_cdc_n_write(uint8_t itf, void const* buffer, uint32_t bufsize) {
       ) {
     tud_cdc_n_write_flush(itf);
   }
+#endif
 
   return ret;
 }
@@ -199,7 +404,7 @@ uint32_t tud_cdc_n_write_flush(uint8_t itf) {
   TU_VERIFY(usbd_edpt_claim(rhport, p_cdc->ep_in), 0);
 
   // Pull data from FIFO
-  uint16_t const count = tu_fifo_read_n(&p_cdc->tx_ff, p_cdc->epin_buf, sizeof(p_cdc->epin_buf));
+  uint16_t const count = (uint16_t) tu_fifo_read_n(&p_cdc->tx_ff, p_cdc->epin_buf, sizeof(p_cdc->epin_buf));
 
   if (count) {
     TU_ASSERT(usbd_edpt_xfer(rhport, p_cdc->ep_in, p_cdc->epin_buf, count), 0);
@@ -286,10 +491,17 @@ void cdcd_reset(uint8_t rhport) {
     cdcd_interface_t* p_cdc = &_cdcd_itf[i];
 
     tu_memclr(p_cdc, ITF_MEM_RESET_SIZE);
-    if (!_cdcd_fifo_cfg.rx_persistent) tu_fifo_clear(&p_cdc->rx_ff);
+    if (!_cdcd_fifo_cfg.rx_persistent) {
+      tu_fifo_clear(&p_cdc->rx_ff);
+      p_cdc->rx_line_len = 0;
+    }
     if (!_cdcd_fifo_cfg.tx_persistent) tu_fifo_clear(&p_cdc->tx_ff);
     tu_fifo_set_overwritable(&p_cdc->tx_ff, true);
   }
+
+#if CFG_TUD_CDC_TX_FLUSH_MS
+  usbd_sof_enable(rhport, SOF_CONSUMER_CDC, false);
+#endif
 }
 
 uint16_t cdcd_open(uint8_t rhport, tusb_desc_interface_t const * itf_desc, uint16_t max_len) {
@@ -340,6 +552,19 @@ uint16_t cdcd_open(uint8_t rhport, tusb_desc_interface_t const * itf_desc, uint1
     // Open endpoint pair
     TU_ASSERT(usbd_open_edpt_pair(rhport, p_desc, 2, TUSB_XFER_BULK, &p_cdc->ep_out, &p_cdc->ep_in), 0);
 
+    for (uint8_t i = 0; i < 2; i++) {
+      tusb_desc_endpoint_t const* desc_ep = (tusb_desc_endpoint_t const*) p_desc;
+      if (desc_ep->bEndpointAddress == p_cdc->ep_in) {
+        p_cdc->ep_in_mps = tu_edpt_packet_size(desc_ep);
+      }
+#if CFG_TUD_CDC_RX_DIRECT
+      else {
+        p_cdc->ep_out_mps = tu_edpt_packet_size(desc_ep);
+      }
+#endif
+      p_desc = tu_desc_next(p_desc);
+    }
+
     drv_len += 2 * sizeof(tusb_desc_endpoint_t);
   }
 
@@ -438,16 +663,28 @@ bool cdcd_xfer_cb(uint8_t rhport, uint8_t ep_addr, xfer_result_t result, uint32_
 
   // Received new data
   if (ep_addr == p_cdc->ep_out) {
+#if CFG_TUD_CDC_RX_DIRECT
+    tu_fifo_buffer_info_t const* info = &p_cdc->rx_info;
+
+  #if CFG_TUD_CDC_RX_DIRECT == 1
+    if (info->ptr_lin == p_cdc->epout_buf) {
+      tu_fifo_write_n(&p_cdc->rx_ff, p_cdc->epout_buf, (uint16_t) xferred_bytes);
+    } else {
+      tu_fifo_advance_write_pointer(&p_cdc->rx_ff, (tu_fifo_size_t) xferred_bytes);
+    }
+  #endif
+    // with usbd_edpt_xfer_fifo() controller driver has already written to fifo
+
+    // Check for wanted char and line delimiters, invoke callbacks if needed
+    uint32_t const lin_count = tu_min32(xferred_bytes, info->len_lin);
+    _rx_scan(itf, p_cdc, (uint8_t const*) info->ptr_lin, lin_count, xferred_bytes);
+    _rx_scan(itf, p_cdc, (uint8_t const*) info->ptr_wrap, xferred_bytes - lin_count, xferred_bytes - lin_count);
+#else
     tu_fifo_write_n(&p_cdc->rx_ff, p_cdc->epout_buf, (uint16_t) xferred_bytes);
 
-    // Check for wanted char and invoke callback if needed
-    if (tud_cdc_rx_wanted_cb && (((signed char) p_cdc->wanted_char) != -1)) {
-      for (uint32_t i = 0; i < xferred_bytes; i++) {
-        if ((p_cdc->wanted_char == p_cdc->epout_buf[i]) && !tu_fifo_empty(&p_cdc->rx_ff)) {
-          tud_cdc_rx_wanted_cb(itf, p_cdc->wanted_char);
-        }
-      }
-    }
+    // Check for wanted char and line delimiters, invoke callbacks if needed
+    _rx_scan(itf, p_cdc, p_cdc->epout_buf, xferred_bytes, xferred_bytes);
+#endif
 
     // invoke receive callback (if there is still data)
     if (tud_cdc_rx_cb && !tu_fifo_empty(&p_cdc->rx_ff)) tud_cdc_rx_cb(itf);
@@ -466,7 +703,7 @@ bool cdcd_xfer_cb(uint8_t rhport, uint8_t ep_addr, xfer_result_t result, uint32_
     if (0 == tud_cdc_n_write_flush(itf)) {
       // If there is no data left, a ZLP should be sent if
       // xferred_bytes is multiple of EP Packet size and not zero
-      if (!tu_fifo_count(&p_cdc->tx_ff) && xferred_bytes && (0 == (xferred_bytes & (BULK_PACKET_SIZE - 1)))) {
+      if (!tu_fifo_count(&p_cdc->tx_ff) && xferred_bytes && (0 == (xferred_bytes & (p_cdc->ep_in_mps - 1u)))) {
         if (usbd_edpt_claim(rhport, p_cdc->ep_in)) {
           usbd_edpt_xfer(rhport, p_cdc->ep_in, NULL, 0);
         }
@@ -479,4 +716,25 @@ bool cdcd_xfer_cb(uint8_t rhport, uint8_t ep_addr, xfer_result_t result, uint32_
   return true;
 }
 
+#if CFG_TUD_CDC_TX_FLUSH_MS
+// Invoked in ISR context, frame number is in 1ms unit and 11-bit wide
+void cdcd_sof_isr(uint8_t rhport, uint32_t frame_count) {
+  (void) rhport;
+  uint16_t const frame = (uint16_t) (frame_count & 0x7FFu);
+
+  for (uint8_t i = 0; i < CFG_TUD_CDC; i++) {
+    cdcd_interface_t* p_cdc = &_cdcd_itf[i];
+    if (!p_cdc->tx_timer_armed) continue;
+
+    if (!p_cdc->tx_timer_started) {
+      p_cdc->tx_timer_started = true;
+      p_cdc->tx_timer_frame = frame;
+    } else if (((frame - p_cdc->tx_timer_frame) & 0x7FFu) >= CFG_TUD_CDC_TX_FLUSH_MS) {
+      p_cdc->tx_timer_armed = false;
+      usbd_defer_func(_tx_timer_expired, p_cdc, true);
+    }
+  }
+}
+#endif
+
 #endif
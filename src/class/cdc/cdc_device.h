@@ -41,6 +41,29 @@
   #define CFG_TUD_CDC_EP_BUFSIZE    (TUD_OPT_HIGH_SPEED ? 512 : 64)
 #endif
 
+// Receive OUT data directly into rx fifo instead of copying every transfer from endpoint buffer. Endpoint is armed
+// whenever a packet fits in fifo.
+//   0: copy from endpoint buffer
+//   1: transfer into linear free space of fifo when it is 4-byte aligned, a packet at the wrap-around point or after
+//      a short packet is copied from endpoint buffer
+//   2: transfer with usbd_edpt_xfer_fifo(), controller driver must implement dcd_edpt_xfer_fifo() and handle any
+//      fifo position, i.e unaligned and wrapped around
+#ifndef CFG_TUD_CDC_RX_DIRECT
+  #define CFG_TUD_CDC_RX_DIRECT     0
+#endif
+
+// Written data is sent at most this many milliseconds later without tud_cdc_write_flush(), timer is driven by SOF.
+// Small writes are then batched: tud_cdc_write() only starts a transfer once a full endpoint buffer is queued.
+// 0 to start a transfer once a packet is queued
+#ifndef CFG_TUD_CDC_TX_FLUSH_MS
+  #define CFG_TUD_CDC_TX_FLUSH_MS   0
+#endif
+
+// Max number of line delimiters, see tud_cdc_n_set_line_delimiters()
+#ifndef CFG_TUD_CDC_LINE_DELIM_MAX
+  #define CFG_TUD_CDC_LINE_DELIM_MAX 4
+#endif
+
 #ifdef __cplusplus
  extern "C" {
 #endif
@@ -76,6 +99,10 @@ void tud_cdc_n_get_line_coding(uint8_t itf, cdc_line_coding_t* coding);
 // Set special character that will trigger tud_cdc_rx_wanted_cb() callback on receiving
 void tud_cdc_n_set_wanted_char(uint8_t itf, char wanted);
 
+// Set characters ending a line e.g CR, LF and NUL, each received one triggers tud_cdc_rx_line_cb().
+// Count 0 disables line reporting. Return false if count is more than CFG_TUD_CDC_LINE_DELIM_MAX
+bool tud_cdc_n_set_line_delimiters(uint8_t itf, char const* delims, uint8_t count);
+
 // Get the number of bytes available for reading
 uint32_t tud_cdc_n_available(uint8_t itf);
 
@@ -94,6 +121,13 @@ void tud_cdc_n_read_flush(uint8_t itf);
 // Get a byte from FIFO without removing it
 bool tud_cdc_n_peek(uint8_t itf, uint8_t* ui8);
 
+// Zero-copy read: get a pointer to up to bufsize bytes of received FIFO to parse in place, return number of bytes.
+// Data never wraps, reserve again after commit to get the wrapped part
+uint32_t tud_cdc_n_read_reserve(uint8_t itf, void** ptr, uint32_t bufsize);
+
+// Remove count bytes parsed after tud_cdc_n_read_reserve() from received FIFO
+uint32_t tud_cdc_n_read_commit(uint8_t itf, uint32_t count);
+
 // Write bytes to TX FIFO, data may remain in the FIFO for a while
 uint32_t tud_cdc_n_write(uint8_t itf, void const* buffer, uint32_t bufsize);
 
@@ -140,6 +174,10 @@ TU_ATTR_ALWAYS_INLINE static inline void tud_cdc_set_wanted_char(char wanted) {
   tud_cdc_n_set_wanted_char(0, wanted);
 }
 
+TU_ATTR_ALWAYS_INLINE static inline bool tud_cdc_set_line_delimiters(char const* delims, uint8_t count) {
+  return tud_cdc_n_set_line_delimiters(0, delims, count);
+}
+
 TU_ATTR_ALWAYS_INLINE static inline uint32_t tud_cdc_available(void) {
   return tud_cdc_n_available(0);
 }
@@ -160,6 +198,14 @@ TU_ATTR_ALWAYS_INLINE static inline bool tud_cdc_peek(uint8_t* ui8) {
   return tud_cdc_n_peek(0, ui8);
 }
 
+TU_ATTR_ALWAYS_INLINE static inline uint32_t tud_cdc_read_reserve(void** ptr, uint32_t bufsize) {
+  return tud_cdc_n_read_reserve(0, ptr, bufsize);
+}
+
+TU_ATTR_ALWAYS_INLINE static inline uint32_t tud_cdc_read_commit(uint32_t count) {
+  return tud_cdc_n_read_commit(0, count);
+}
+
 TU_ATTR_ALWAYS_INLINE static inline uint32_t tud_cdc_write_char(char ch) {
   return tud_cdc_n_write_char(0, ch);
 }
@@ -194,6 +240,16 @@ TU_ATTR_WEAK void tud_cdc_rx_cb(uint8_t itf);
 // Invoked when received `wanted_char`
 TU_ATTR_WEAK void tud_cdc_rx_wanted_cb(uint8_t itf, char wanted_char);
 
+// Invoked when received a line delimiter. Line starts offset bytes after read position of RX FIFO and is len bytes
+// including its delimiter, a delimiter right after another one is a line of its own e.g LF of CR LF.
+// Line can be parsed in place with tud_cdc_n_read_reserve(). Note: data is only received while RX FIFO has room for
+// a packet, so it must hold longest line plus one packet if a partial line is left in it
+TU_ATTR_WEAK void tud_cdc_rx_line_cb(uint8_t itf, uint32_t offset, uint32_t len);
+
+// Invoked to find first byte of buf which is one of set_count characters in set, return its index or len if none.
+// Default uses memchr() for a single character and a word-at-a-time scan otherwise, can be replaced by e.g a SIMD one
+uint32_t tud_cdc_rx_scan_cb(uint8_t const* buf, uint32_t len, uint8_t const* set, uint8_t set_count);
+
 // Invoked when a TX is complete and therefore space becomes available in TX buffer
 TU_ATTR_WEAK void tud_cdc_tx_complete_cb(uint8_t itf);
 
@@ -215,6 +271,7 @@ void     cdcd_reset           (uint8_t rhport);
 uint16_t cdcd_open            (uint8_t rhport, tusb_desc_interface_t const * itf_desc, uint16_t max_len);
 bool     cdcd_control_xfer_cb (uint8_t rhport, uint8_t stage, tusb_control_request_t const * request);
 bool     cdcd_xfer_cb         (uint8_t rhport, uint8_t ep_addr, xfer_result_t result, uint32_t xferred_bytes);
+void     cdcd_sof_isr         (uint8_t rhport, uint32_t frame_count);
 
 #ifdef __cplusplus
  }
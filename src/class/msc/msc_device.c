@@ -59,6 +59,7 @@ typedef struct
   CFG_TUSB_MEM_ALIGN msc_cbw_t cbw;
   CFG_TUSB_MEM_ALIGN msc_csw_t csw;
 
+  uint8_t  rhport;
   uint8_t  itf_num;
   uint8_t  ep_in;
   uint8_t  ep_out;
@@ -68,6 +69,18 @@ typedef struct
   uint32_t total_len;   // byte to be transferred, can be smaller than total_bytes in cbw
   uint32_t xferred_len; // numbered of bytes transferred so far in the Data Stage
 
+  // READ10/WRITE10 data buffers, a ring of CFG_TUD_MSC_BUF_COUNT starting at buf_head
+  uint32_t prep_len;    // READ10: bytes read from storage, WRITE10: bytes queued to receive from host
+  uint16_t buf_len[CFG_TUD_MSC_BUF_COUNT];
+  uint16_t buf_offset;  // WRITE10: bytes of head buffer already written to storage
+  uint8_t  buf_head;    // READ10: buffer to send, WRITE10: buffer to write to storage
+  uint8_t  buf_count;   // buffers holding data, not including the one being received for WRITE10
+  bool     xfer_busy;   // data transfer is queued on endpoint, otherwise a completion is simulated to retry
+  bool     async_io;    // read10/write10 callback returned TUD_MSC_RET_ASYNC, waiting for tud_msc_async_io_done()
+  bool     io_failed;   // read10/write10 callback failed, status is sent once queued transfer completes
+  volatile bool    async_done;   // tud_msc_async_io_done() from ISR, posted to usbd task by next SOF
+  volatile int32_t async_nbytes;
+
   // Sense Response Data
   uint8_t sense_key;
   uint8_t add_sense_code;
@@ -75,7 +88,7 @@ typedef struct
 }mscd_interface_t;
 
 CFG_TUD_MEM_SECTION CFG_TUSB_MEM_ALIGN tu_static mscd_interface_t _mscd_itf;
-CFG_TUD_MEM_SECTION CFG_TUSB_MEM_ALIGN tu_static uint8_t _mscd_buf[CFG_TUD_MSC_EP_BUFSIZE];
+CFG_TUD_MEM_SECTION CFG_TUSB_MEM_ALIGN tu_static uint8_t _mscd_buf[CFG_TUD_MSC_BUF_COUNT][CFG_TUD_MSC_EP_BUFSIZE];
 
 //--------------------------------------------------------------------+
 // INTERNAL OBJECT & FUNCTION DECLARATION
@@ -84,7 +97,12 @@ static int32_t proc_builtin_scsi(uint8_t lun, uint8_t const scsi_cmd[16], uint8_
 static void proc_read10_cmd(uint8_t rhport, mscd_interface_t* p_msc);
 
 static void proc_write10_cmd(uint8_t rhport, mscd_interface_t* p_msc);
+static void proc_write10_xfer(uint8_t rhport, mscd_interface_t* p_msc);
 static void proc_write10_new_data(uint8_t rhport, mscd_interface_t* p_msc, uint32_t xferred_bytes);
+static void proc_write10_storage(uint8_t rhport, mscd_interface_t* p_msc);
+static bool proc_rdwr10_result(uint8_t rhport, mscd_interface_t* p_msc, int32_t nbytes);
+static void proc_rdwr10_failed(uint8_t rhport, mscd_interface_t* p_msc);
+static void proc_stage_status(uint8_t rhport, mscd_interface_t* p_msc);
 
 TU_ATTR_ALWAYS_INLINE static inline bool is_data_in(uint8_t dir)
 {
@@ -248,6 +266,61 @@ static inline void set_sense_medium_not_present(uint8_t lun)
   tud_msc_set_sense(lun, SCSI_SENSE_NOT_READY, 0x3A, 0x00);
 }
 
+// Resume data stage in usbd task once background I/O is done
+static void proc_async_io_done(void* param)
+{
+  (void) param;
+  mscd_interface_t* p_msc = &_mscd_itf;
+  uint8_t const rhport = p_msc->rhport;
+
+  // data stage may be aborted by bus or BOT reset meanwhile
+  TU_VERIFY(p_msc->async_io && p_msc->stage == MSC_STAGE_DATA, );
+  p_msc->async_io = false;
+  usbd_sof_enable(rhport, SOF_CONSUMER_MSC, false);
+
+  if ( proc_rdwr10_result(rhport, p_msc, p_msc->async_nbytes) )
+  {
+    if ( SCSI_CMD_READ_10 == p_msc->cbw.command[0] )
+    {
+      proc_read10_cmd(rhport, p_msc);
+    }else
+    {
+      proc_write10_storage(rhport, p_msc);
+    }
+  }
+
+  proc_stage_status(rhport, p_msc);
+}
+
+bool tud_msc_async_io_done(uint8_t lun, int32_t nbytes, bool in_isr)
+{
+  (void) lun;
+  mscd_interface_t* p_msc = &_mscd_itf;
+
+  TU_VERIFY(p_msc->async_io);
+  p_msc->async_nbytes = nbytes;
+
+  if ( in_isr )
+  {
+    // Only USB ISR may push into usbd queue next to tasks (OPT_OS_NONE SPSC queue, defer queue),
+    // usbd_lock() does not mask e.g DMA interrupt. Post from next SOF instead.
+    p_msc->async_done = true;
+  }else
+  {
+    usbd_defer_func(proc_async_io_done, NULL, false);
+  }
+
+  return true;
+}
+
+// Background I/O started, SOF is needed to post its completion from ISR
+static void async_io_start(uint8_t rhport, mscd_interface_t* p_msc)
+{
+  p_msc->async_done = false;
+  p_msc->async_io   = true;
+  usbd_sof_enable(rhport, SOF_CONSUMER_MSC, true);
+}
+
 //--------------------------------------------------------------------+
 // USBD Driver API
 //--------------------------------------------------------------------+
@@ -262,8 +335,8 @@ bool mscd_deinit(void) {
 
 void mscd_reset(uint8_t rhport)
 {
-  (void) rhport;
   tu_memclr(&_mscd_itf, sizeof(mscd_interface_t));
+  usbd_sof_enable(rhport, SOF_CONSUMER_MSC, false);
 }
 
 uint16_t mscd_open(uint8_t rhport, tusb_desc_interface_t const * itf_desc, uint16_t max_len)
@@ -280,6 +353,7 @@ uint16_t mscd_open(uint8_t rhport, tusb_desc_interface_t const * itf_desc, uint1
   TU_ASSERT(max_len >= drv_len, 0);
 
   mscd_interface_t * p_msc = &_mscd_itf;
+  p_msc->rhport  = rhport;
   p_msc->itf_num = itf_desc->bInterfaceNumber;
 
   // Open endpoint pair
@@ -291,11 +365,30 @@ uint16_t mscd_open(uint8_t rhport, tusb_desc_interface_t const * itf_desc, uint1
   return drv_len;
 }
 
+TU_ATTR_ALWAYS_INLINE static inline void data_buf_reset(mscd_interface_t* p_msc)
+{
+  p_msc->prep_len   = 0;
+  p_msc->buf_offset = 0;
+  p_msc->buf_head   = 0;
+  p_msc->buf_count  = 0;
+  p_msc->xfer_busy  = false;
+  p_msc->io_failed  = false;
+
+  if ( p_msc->async_io )
+  {
+    // pending background I/O is abandoned, its completion is ignored
+    p_msc->async_io   = false;
+    p_msc->async_done = false;
+    usbd_sof_enable(p_msc->rhport, SOF_CONSUMER_MSC, false);
+  }
+}
+
 static void proc_bot_reset(mscd_interface_t* p_msc)
 {
   p_msc->stage       = MSC_STAGE_CMD;
   p_msc->total_len   = 0;
   p_msc->xferred_len = 0;
+  data_buf_reset(p_msc);
 
   p_msc->sense_key           = 0;
   p_msc->add_sense_code      = 0;
@@ -431,6 +524,7 @@ bool mscd_xfer_cb(uint8_t rhport, uint8_t ep_addr, xfer_result_t event, uint32_t
       p_msc->stage = MSC_STAGE_DATA;
       p_msc->total_len = p_cbw->total_bytes;
       p_msc->xferred_len = 0;
+      data_buf_reset(p_msc);
 
       // Read10 or Write10
       if ( (SCSI_CMD_READ_10 == p_cbw->command[0]) || (SCSI_CMD_WRITE_10 == p_cbw->command[0]) )
@@ -462,7 +556,7 @@ bool mscd_xfer_cb(uint8_t rhport, uint8_t ep_addr, xfer_result_t event, uint32_t
         // 2. IN & Zero: Process if is built-in, else Invoke app callback. Skip DATA if zero length
         if ( (p_cbw->total_bytes > 0 ) && !is_data_in(p_cbw->dir) )
         {
-          if (p_cbw->total_bytes > sizeof(_mscd_buf))
+          if (p_cbw->total_bytes > sizeof(_mscd_buf[0]))
           {
             TU_LOG_DRV("  SCSI reject non READ10/WRITE10 with large data\r\n");
             fail_scsi_op(rhport, p_msc, MSC_CSW_STATUS_FAILED);
@@ -470,17 +564,17 @@ bool mscd_xfer_cb(uint8_t rhport, uint8_t ep_addr, xfer_result_t event, uint32_t
           {
             // Didn't check for case 9 (Ho > Dn), which requires examining scsi command first
             // but it is OK to just receive data then responded with failed status
-            TU_ASSERT( usbd_edpt_xfer(rhport, p_msc->ep_out, _mscd_buf, (uint16_t) p_msc->total_len) );
+            TU_ASSERT( usbd_edpt_xfer(rhport, p_msc->ep_out, _mscd_buf[0], (uint16_t) p_msc->total_len) );
           }
         }else
         {
           // First process if it is a built-in commands
-          int32_t resplen = proc_builtin_scsi(p_cbw->lun, p_cbw->command, _mscd_buf, sizeof(_mscd_buf));
+          int32_t resplen = proc_builtin_scsi(p_cbw->lun, p_cbw->command, _mscd_buf[0], sizeof(_mscd_buf[0]));
 
           // Invoke user callback if not built-in
           if ( (resplen < 0) && (p_msc->sense_key == 0) )
           {
-            resplen = tud_msc_scsi_cb(p_cbw->lun, p_cbw->command, _mscd_buf, (uint16_t) p_msc->total_len);
+            resplen = tud_msc_scsi_cb(p_cbw->lun, p_cbw->command, _mscd_buf[0], (uint16_t) p_msc->total_len);
           }
 
           if ( resplen < 0 )
@@ -513,7 +607,7 @@ bool mscd_xfer_cb(uint8_t rhport, uint8_t ep_addr, xfer_result_t event, uint32_t
             {
               // cannot return more than host expect
               p_msc->total_len = tu_min32((uint32_t) resplen, p_cbw->total_bytes);
-              TU_ASSERT( usbd_edpt_xfer(rhport, p_msc->ep_in, _mscd_buf, (uint16_t) p_msc->total_len) );
+              TU_ASSERT( usbd_edpt_xfer(rhport, p_msc->ep_in, _mscd_buf[0], (uint16_t) p_msc->total_len) );
             }
           }
         }
@@ -526,7 +620,14 @@ bool mscd_xfer_cb(uint8_t rhport, uint8_t ep_addr, xfer_result_t event, uint32_t
 
       if (SCSI_CMD_READ_10 == p_cbw->command[0])
       {
-        p_msc->xferred_len += xferred_bytes;
+        // otherwise it is a simulated completion to retry tud_msc_read10_cb()
+        if ( p_msc->xfer_busy )
+        {
+          p_msc->xfer_busy = false;
+          p_msc->xferred_len += xferred_bytes;
+          p_msc->buf_head = (uint8_t) ((p_msc->buf_head + 1) % CFG_TUD_MSC_BUF_COUNT);
+          p_msc->buf_count--;
+        }
 
         if ( p_msc->xferred_len >= p_msc->total_len )
         {
@@ -548,7 +649,7 @@ bool mscd_xfer_cb(uint8_t rhport, uint8_t ep_addr, xfer_result_t event, uint32_t
         // OUT transfer, invoke callback if needed
         if ( !is_data_in(p_cbw->dir) )
         {
-          int32_t cb_result = tud_msc_scsi_cb(p_cbw->lun, p_cbw->command, _mscd_buf, (uint16_t) p_msc->total_len);
+          int32_t cb_result = tud_msc_scsi_cb(p_cbw->lun, p_cbw->command, _mscd_buf[0], (uint16_t) p_msc->total_len);
 
           if ( cb_result < 0 )
           {
@@ -614,6 +715,30 @@ bool mscd_xfer_cb(uint8_t rhport, uint8_t ep_addr, xfer_result_t event, uint32_t
     default : break;
   }
 
+  proc_stage_status(rhport, p_msc);
+
+  return true;
+}
+
+// Post completion of background I/O signalled from another ISR, USB ISR context
+void mscd_sof_isr(uint8_t rhport, uint32_t frame_count)
+{
+  (void) rhport;
+  (void) frame_count;
+  mscd_interface_t* p_msc = &_mscd_itf;
+
+  if ( p_msc->async_done )
+  {
+    p_msc->async_done = false;
+    usbd_defer_func(proc_async_io_done, NULL, true);
+  }
+}
+
+// Send status if data stage is complete or failed
+static void proc_stage_status(uint8_t rhport, mscd_interface_t* p_msc)
+{
+  msc_cbw_t const * p_cbw = &p_msc->cbw;
+
   if ( p_msc->stage == MSC_STAGE_STATUS )
   {
     // skip status if epin is currently stalled, will do it when received Clear Stall request
@@ -626,7 +751,7 @@ bool mscd_xfer_cb(uint8_t rhport, uint8_t ep_addr, xfer_result_t event, uint32_t
         usbd_edpt_stall(rhport, p_msc->ep_in);
       }else
       {
-        TU_ASSERT( send_csw(rhport, p_msc) );
+        TU_ASSERT( send_csw(rhport, p_msc), );
       }
     }
 
@@ -641,8 +766,6 @@ bool mscd_xfer_cb(uint8_t rhport, uint8_t ep_addr, xfer_result_t event, uint32_t
     }
     #endif
   }
-
-  return true;
 }
 
 /*------------------------------------------------------------------*/
@@ -857,35 +980,43 @@ static void proc_read10_cmd(uint8_t rhport, mscd_interface_t* p_msc)
   // block size already verified not zero
   uint16_t const block_sz = rdwr10_get_blocksize(p_cbw);
 
-  // Adjust lba with transferred bytes
-  uint32_t const lba = rdwr10_get_lba(p_cbw->command) + (p_msc->xferred_len / block_sz);
+  while (1)
+  {
+    // send oldest buffer as soon as endpoint is free
+    if ( !p_msc->xfer_busy && p_msc->buf_count )
+    {
+      p_msc->xfer_busy = true;
+      TU_ASSERT( usbd_edpt_xfer(rhport, p_msc->ep_in, _mscd_buf[p_msc->buf_head], p_msc->buf_len[p_msc->buf_head]), );
+    }
 
-  // remaining bytes capped at class buffer
-  int32_t nbytes = (int32_t) tu_min32(sizeof(_mscd_buf), p_cbw->total_bytes-p_msc->xferred_len);
+    // read ahead into free buffers while previous ones are sent
+    if ( p_msc->async_io || p_msc->io_failed || (p_msc->buf_count == CFG_TUD_MSC_BUF_COUNT) ||
+         (p_msc->prep_len >= p_cbw->total_bytes) ) break;
 
-  // Application can consume smaller bytes
-  uint32_t const offset = p_msc->xferred_len % block_sz;
-  nbytes = tud_msc_read10_cb(p_cbw->lun, lba, offset, _mscd_buf, (uint32_t) nbytes);
+    uint8_t const idx = (uint8_t) ((p_msc->buf_head + p_msc->buf_count) % CFG_TUD_MSC_BUF_COUNT);
 
-  if ( nbytes < 0 )
-  {
-    // negative means error -> endpoint is stalled & status in CSW set to failed
-    TU_LOG_DRV("  tud_msc_read10_cb() return -1\r\n");
+    // Adjust lba with bytes read so far
+    uint32_t const lba = rdwr10_get_lba(p_cbw->command) + (p_msc->prep_len / block_sz);
 
-    // set sense
-    set_sense_medium_not_present(p_cbw->lun);
+    // remaining bytes capped at class buffer
+    int32_t nbytes = (int32_t) tu_min32(sizeof(_mscd_buf[0]), p_cbw->total_bytes - p_msc->prep_len);
 
-    fail_scsi_op(rhport, p_msc, MSC_CSW_STATUS_FAILED);
-  }
-  else if ( nbytes == 0 )
-  {
-    // zero means not ready -> simulate an transfer complete so that this driver callback will fired again
-    dcd_event_xfer_complete(rhport, p_msc->ep_in, 0, XFER_RESULT_SUCCESS, false);
-  }
-  else
-  {
-    TU_ASSERT( usbd_edpt_xfer(rhport, p_msc->ep_in, _mscd_buf, (uint16_t) nbytes), );
+    // Application can consume smaller bytes
+    uint32_t const offset = p_msc->prep_len % block_sz;
+    nbytes = tud_msc_read10_cb(p_cbw->lun, lba, offset, _mscd_buf[idx], (uint32_t) nbytes);
+
+    if ( nbytes == TUD_MSC_RET_ASYNC )
+    {
+      // resumed by tud_msc_async_io_done(), queued transfer can still complete meanwhile
+      async_io_start(rhport, p_msc);
+      break;
+    }
+
+    if ( !proc_rdwr10_result(rhport, p_msc, nbytes) ) return;
   }
+
+  // buffers read before failure are sent first
+  proc_rdwr10_failed(rhport, p_msc);
 }
 
 static void proc_write10_cmd(uint8_t rhport, mscd_interface_t* p_msc)
@@ -907,71 +1038,177 @@ static void proc_write10_cmd(uint8_t rhport, mscd_interface_t* p_msc)
     return;
   }
 
+  proc_write10_xfer(rhport, p_msc);
+}
+
+// queue receiving from host into next free buffer
+static void proc_write10_xfer(uint8_t rhport, mscd_interface_t* p_msc)
+{
+  msc_cbw_t const * p_cbw = &p_msc->cbw;
+
+  if ( p_msc->xfer_busy || p_msc->io_failed || (p_msc->buf_count == CFG_TUD_MSC_BUF_COUNT) ||
+       (p_msc->prep_len >= p_cbw->total_bytes) ) return;
+
+  uint8_t const idx = (uint8_t) ((p_msc->buf_head + p_msc->buf_count) % CFG_TUD_MSC_BUF_COUNT);
+
   // remaining bytes capped at class buffer
-  uint16_t nbytes = (uint16_t) tu_min32(sizeof(_mscd_buf), p_cbw->total_bytes-p_msc->xferred_len);
+  uint16_t const nbytes = (uint16_t) tu_min32(sizeof(_mscd_buf[0]), p_cbw->total_bytes - p_msc->prep_len);
+
+  p_msc->buf_len[idx] = nbytes;
+  p_msc->prep_len += nbytes;
+  p_msc->xfer_busy = true;
 
   // Write10 callback will be called later when usb transfer complete
-  TU_ASSERT( usbd_edpt_xfer(rhport, p_msc->ep_out, _mscd_buf, nbytes), );
+  TU_ASSERT( usbd_edpt_xfer(rhport, p_msc->ep_out, _mscd_buf[idx], nbytes), );
 }
 
 // process new data arrived from WRITE10
 static void proc_write10_new_data(uint8_t rhport, mscd_interface_t* p_msc, uint32_t xferred_bytes)
+{
+  // otherwise it is a simulated completion to retry tud_msc_write10_cb()
+  if ( p_msc->xfer_busy && p_msc->io_failed )
+  {
+    // data received after failure is discarded
+    p_msc->xfer_busy = false;
+    p_msc->xferred_len += xferred_bytes;
+  }
+  else if ( p_msc->xfer_busy )
+  {
+    uint8_t const idx = (uint8_t) ((p_msc->buf_head + p_msc->buf_count) % CFG_TUD_MSC_BUF_COUNT);
+
+    // host can send less than queued
+    p_msc->prep_len -= p_msc->buf_len[idx] - xferred_bytes;
+    p_msc->buf_len[idx] = (uint16_t) xferred_bytes;
+    p_msc->buf_count++;
+    p_msc->xfer_busy = false;
+
+    // receive next data while this one is written to storage
+    proc_write10_xfer(rhport, p_msc);
+  }
+
+  proc_write10_storage(rhport, p_msc);
+}
+
+// write received buffers to storage
+static void proc_write10_storage(uint8_t rhport, mscd_interface_t* p_msc)
 {
   msc_cbw_t const * p_cbw = &p_msc->cbw;
 
   // block size already verified not zero
   uint16_t const block_sz = rdwr10_get_blocksize(p_cbw);
 
-  // Adjust lba with transferred bytes
-  uint32_t const lba = rdwr10_get_lba(p_cbw->command) + (p_msc->xferred_len / block_sz);
+  while ( p_msc->buf_count && !p_msc->async_io )
+  {
+    // Adjust lba with transferred bytes
+    uint32_t const lba = rdwr10_get_lba(p_cbw->command) + (p_msc->xferred_len / block_sz);
 
-  // Invoke callback to consume new data
-  uint32_t const offset = p_msc->xferred_len % block_sz;
-  int32_t nbytes = tud_msc_write10_cb(p_cbw->lun, lba, offset, _mscd_buf, xferred_bytes);
+    // Invoke callback to consume new data
+    uint32_t const offset = p_msc->xferred_len % block_sz;
+    uint32_t const len = (uint32_t) (p_msc->buf_len[p_msc->buf_head] - p_msc->buf_offset);
+    int32_t const nbytes = tud_msc_write10_cb(p_cbw->lun, lba, offset, _mscd_buf[p_msc->buf_head] + p_msc->buf_offset, len);
 
-  if ( nbytes < 0 )
+    if ( nbytes == TUD_MSC_RET_ASYNC )
+    {
+      // resumed by tud_msc_async_io_done(), next data can still be received meanwhile
+      async_io_start(rhport, p_msc);
+      return;
+    }
+
+    if ( !proc_rdwr10_result(rhport, p_msc, nbytes) ) return;
+  }
+
+  if ( p_msc->io_failed )
   {
-    // negative means error -> failed this scsi op
-    TU_LOG_DRV("  tud_msc_write10_cb() return -1\r\n");
+    proc_rdwr10_failed(rhport, p_msc);
+  }
+  else if ( p_msc->xferred_len >= p_msc->total_len )
+  {
+    // Data Stage is complete
+    p_msc->stage = MSC_STAGE_STATUS;
+  }
+}
 
-    // update actual byte before failed
-    p_msc->xferred_len += xferred_bytes;
+// process bytes read from or written to storage by read10/write10 callback, return false if data stage cannot continue
+// until next transfer completes or failed
+static bool proc_rdwr10_result(uint8_t rhport, mscd_interface_t* p_msc, int32_t nbytes)
+{
+  msc_cbw_t const * p_cbw = &p_msc->cbw;
+  bool const is_read = (SCSI_CMD_READ_10 == p_cbw->command[0]);
 
-    // Set sense
+  if ( nbytes < 0 )
+  {
+    // negative means error -> endpoint is stalled & status in CSW set to failed
+    TU_LOG_DRV("  tud_msc_%s10_cb() return -1\r\n", is_read ? "read" : "write");
+
+    // set sense
     set_sense_medium_not_present(p_cbw->lun);
 
-    fail_scsi_op(rhport, p_msc, MSC_CSW_STATUS_FAILED);
-  }else
-  {
-    // Application consume less than what we got (including zero)
-    if ( (uint32_t) nbytes < xferred_bytes )
+    // READ10: buffers already read are still sent. WRITE10: data received from host counts as transferred
+    if ( !is_read )
     {
-      uint32_t const left_over = xferred_bytes - (uint32_t) nbytes;
-      if ( nbytes > 0 )
+      while ( p_msc->buf_count )
       {
-        p_msc->xferred_len += (uint16_t) nbytes;
-        memmove(_mscd_buf, _mscd_buf+nbytes, left_over);
+        p_msc->xferred_len += (uint32_t) (p_msc->buf_len[p_msc->buf_head] - p_msc->buf_offset);
+        p_msc->buf_offset = 0;
+        p_msc->buf_head = (uint8_t) ((p_msc->buf_head + 1) % CFG_TUD_MSC_BUF_COUNT);
+        p_msc->buf_count--;
       }
+    }
+
+    p_msc->io_failed = true;
+    proc_rdwr10_failed(rhport, p_msc);
+    return false;
+  }
 
-      // simulate an transfer complete with adjusted parameters --> callback will be invoked with adjusted parameter
-      dcd_event_xfer_complete(rhport, p_msc->ep_out, left_over, XFER_RESULT_SUCCESS, false);
+  if ( is_read )
+  {
+    if ( nbytes == 0 )
+    {
+      // zero means not ready -> callback is fired again when queued transfer completes, simulate an transfer complete
+      // if there is none
+      if ( !p_msc->xfer_busy ) dcd_event_xfer_complete(rhport, p_msc->ep_in, 0, XFER_RESULT_SUCCESS, false);
+      return false;
     }
-    else
+
+    uint8_t const idx = (uint8_t) ((p_msc->buf_head + p_msc->buf_count) % CFG_TUD_MSC_BUF_COUNT);
+    p_msc->buf_len[idx] = (uint16_t) nbytes;
+    p_msc->buf_count++;
+    p_msc->prep_len += (uint32_t) nbytes;
+  }
+  else
+  {
+    p_msc->xferred_len += (uint32_t) nbytes;
+
+    // Application consume less than what we got (including zero)
+    if ( (uint32_t) nbytes < (uint32_t) (p_msc->buf_len[p_msc->buf_head] - p_msc->buf_offset) )
     {
-      // Application consume all bytes in our buffer
-      p_msc->xferred_len += xferred_bytes;
+      p_msc->buf_offset = (uint16_t) (p_msc->buf_offset + nbytes);
 
-      if ( p_msc->xferred_len >= p_msc->total_len )
-      {
-        // Data Stage is complete
-        p_msc->stage = MSC_STAGE_STATUS;
-      }else
-      {
-        // prepare to receive more data from host
-        proc_write10_cmd(rhport, p_msc);
-      }
+      // callback is invoked with remaining data when queued transfer completes, simulate an transfer complete if
+      // there is none
+      if ( !p_msc->xfer_busy ) dcd_event_xfer_complete(rhport, p_msc->ep_out, 0, XFER_RESULT_SUCCESS, false);
+      return false;
     }
+
+    // Application consume all bytes of head buffer, it can receive more data from host
+    p_msc->buf_offset = 0;
+    p_msc->buf_head = (uint8_t) ((p_msc->buf_head + 1) % CFG_TUD_MSC_BUF_COUNT);
+    p_msc->buf_count--;
+
+    proc_write10_xfer(rhport, p_msc);
   }
+
+  return true;
+}
+
+// fail data stage once no transfer is queued and no buffer is left to send: endpoint can't be stalled under an
+// active transfer and residue must count all data transferred
+static void proc_rdwr10_failed(uint8_t rhport, mscd_interface_t* p_msc)
+{
+  if ( !p_msc->io_failed || p_msc->xfer_busy || p_msc->buf_count ) return;
+
+  p_msc->io_failed = false;
+  fail_scsi_op(rhport, p_msc, MSC_CSW_STATUS_FAILED);
 }
 
 #endif
@@ -50,6 +50,21 @@
 
 TU_VERIFY_STATIC(CFG_TUD_MSC_EP_BUFSIZE < UINT16_MAX, "Size is not correct");
 
+// Number of CFG_TUD_MSC_EP_BUFSIZE buffers for READ10/WRITE10 data stage. With 2 or more, next chunk is read from or
+// written to storage while previous one is transferred on USB
+#ifndef CFG_TUD_MSC_BUF_COUNT
+  #define CFG_TUD_MSC_BUF_COUNT   1
+#endif
+
+TU_VERIFY_STATIC(CFG_TUD_MSC_BUF_COUNT >= 1 && CFG_TUD_MSC_BUF_COUNT <= 16, "Buffer count is not correct");
+
+// Return value of tud_msc_read10_cb() and tud_msc_write10_cb()
+enum {
+  TUD_MSC_RET_ERROR = -1,
+  TUD_MSC_RET_BUSY  = 0,
+  TUD_MSC_RET_ASYNC = -16, // I/O is running in background, complete it with tud_msc_async_io_done()
+};
+
 //--------------------------------------------------------------------+
 // Application API
 //--------------------------------------------------------------------+
@@ -57,6 +72,12 @@ TU_VERIFY_STATIC(CFG_TUD_MSC_EP_BUFSIZE < UINT16_MAX, "Size is not correct");
 // Set SCSI sense response
 bool tud_msc_set_sense(uint8_t lun, uint8_t sense_key, uint8_t add_sense_code, uint8_t add_sense_qualifier);
 
+// Complete a tud_msc_read10_cb() or tud_msc_write10_cb() which returned TUD_MSC_RET_ASYNC, nbytes is what callback
+// would have returned otherwise: number of read/written byte, 0 if not ready or negative for error.
+// Can be called from ISR e.g DMA complete: completion is then posted to usbd task by the next SOF (up to 1 ms
+// later on full speed) since only USB ISR may post events. Return false if no I/O is pending
+bool tud_msc_async_io_done(uint8_t lun, int32_t nbytes, bool in_isr);
+
 //--------------------------------------------------------------------+
 // Application Callbacks (WEAK is optional)
 //--------------------------------------------------------------------+
@@ -73,6 +94,11 @@ bool tud_msc_set_sense(uint8_t lun, uint8_t sense_key, uint8_t add_sense_code, u
 //
 //   - read < 0       : Indicate application error e.g invalid address. This request will be STALLed
 //                      and return failed status in command status wrapper phase.
+//
+//   - TUD_MSC_RET_ASYNC : Application started reading in background e.g DMA, buffer must be filled before calling
+//                      tud_msc_async_io_done(). Task is free to process other events meanwhile.
+//
+// - With CFG_TUD_MSC_BUF_COUNT > 1, callback is invoked for next data while previous buffers are still being sent
 int32_t tud_msc_read10_cb (uint8_t lun, uint32_t lba, uint32_t offset, void* buffer, uint32_t bufsize);
 
 // Invoked when received SCSI WRITE10 command
@@ -88,6 +114,11 @@ int32_t tud_msc_read10_cb (uint8_t lun, uint32_t lba, uint32_t offset, void* buf
 //   - write < 0       : Indicate application error e.g invalid address. This request will be STALLed
 //                       and return failed status in command status wrapper phase.
 //
+//   - TUD_MSC_RET_ASYNC : Application started writing in background e.g DMA, buffer is kept until
+//                       tud_msc_async_io_done() is called. Task is free to process other events meanwhile.
+//
+// - With CFG_TUD_MSC_BUF_COUNT > 1, next data is received from host while callback writes previous buffer
+//
 // TODO change buffer to const uint8_t*
 int32_t tud_msc_write10_cb (uint8_t lun, uint32_t lba, uint32_t offset, uint8_t* buffer, uint32_t bufsize);
 
@@ -158,6 +189,7 @@ void     mscd_reset           (uint8_t rhport);
 uint16_t mscd_open            (uint8_t rhport, tusb_desc_interface_t const * itf_desc, uint16_t max_len);
 bool     mscd_control_xfer_cb (uint8_t rhport, uint8_t stage, tusb_control_request_t const * p_request);
 bool     mscd_xfer_cb         (uint8_t rhport, uint8_t ep_addr, xfer_result_t event, uint32_t xferred_bytes);
+void     mscd_sof_isr         (uint8_t rhport, uint32_t frame_count);
 
 #ifdef __cplusplus
  }
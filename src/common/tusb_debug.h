@@ -164,6 +164,65 @@ static inline const char* tu_lookup_find(tu_lookup_table_t const* p_table, uint3
   #define TU_LOG3_HEX(...)
 #endif
 
+//--------------------------------------------------------------------+
+// Trace
+//--------------------------------------------------------------------+
+
+// Trace record ID, layout of arguments must be kept in sync with tools/trace_decode.py
+enum {
+  TU_TRACE_LOST = 0,       // arg2: number of records overwritten before being read
+
+  // Device
+  TU_TRACE_USBD_EVENT,     // arg0: dcd event id, arg1: bus speed (bus reset) or remote wakeup (suspend), arg3: skipped
+  TU_TRACE_USBD_SETUP,     // arg0: skipped, arg2-arg3: setup packet
+  TU_TRACE_USBD_XFER,      // arg0: ep addr, arg1: driver id or 0xFF (EP0/skipped), arg2: length
+  TU_TRACE_USBD_QUEUE,     // arg0: ep addr, arg1: pending, arg2: length, arg3: tu_trace_queue_t
+  TU_TRACE_USBD_STALL,     // arg0: ep addr, arg1: 0 clear, 1 stall, 2 control request stall
+
+  // Host
+  TU_TRACE_USBH_ATTACH,    // arg0: rhport, arg1: deferred
+  TU_TRACE_USBH_REMOVE,    // arg0: rhport, arg1: hub addr | hub port << 8
+  TU_TRACE_USBH_XFER,      // arg0: ep addr, arg1: dev addr, arg2: length, arg3: result
+  TU_TRACE_USBH_XFER_CB,   // arg0: driver id
+  TU_TRACE_USBH_QUEUE,     // arg0: ep addr, arg1: dev addr, arg2: length, arg3: tu_trace_queue_t
+
+  // Application and class drivers, decoded as raw values
+  TU_TRACE_USER = 0x80
+};
+
+typedef enum {
+  TU_TRACE_QUEUE_STARTED = 0,
+  TU_TRACE_QUEUE_PENDING,     // queued behind busy endpoint
+  TU_TRACE_QUEUE_FAILED,
+  TU_TRACE_QUEUE_START_FAILED, // queued transfer failed to start
+  TU_TRACE_QUEUE_ISO_STARTED,
+  TU_TRACE_QUEUE_ISO_FAILED
+} tu_trace_queue_t;
+
+typedef struct {
+  uint32_t time; // tusb_timestamp_cb()
+  uint8_t  id;
+  uint8_t  arg0;
+  uint16_t arg1;
+  uint32_t arg2;
+  uint32_t arg3;
+} tu_trace_record_t;
+
+TU_VERIFY_STATIC(sizeof(tu_trace_record_t) == 16, "size is not correct");
+
+#if CFG_TUSB_TRACE
+TU_VERIFY_STATIC((CFG_TUSB_TRACE_SIZE & (CFG_TUSB_TRACE_SIZE - 1)) == 0, "CFG_TUSB_TRACE_SIZE must be power of 2");
+
+// Write one record, callable from ISR. Slot is reserved with a single index increment without locking: a record
+// written by ISR preempting another write in the middle may be overwritten.
+void tu_trace_write(uint8_t id, uint8_t arg0, uint16_t arg1, uint32_t arg2, uint32_t arg3);
+
+#define TU_TRACE(_id, _arg0, _arg1, _arg2, _arg3) \
+  tu_trace_write(_id, (uint8_t) (_arg0), (uint16_t) (_arg1), (uint32_t) (_arg2), (uint32_t) (_arg3))
+#else
+#define TU_TRACE(_id, _arg0, _arg1, _arg2, _arg3)
+#endif
+
 #ifdef __cplusplus
  }
 #endif
@@ -27,6 +27,7 @@
 
 #include "osal/osal.h"
 #include "tusb_fifo.h"
+#include "tusb_fifo_copy.h"
 
 #define TU_FIFO_DBG   0
 
@@ -55,6 +56,17 @@ TU_ATTR_ALWAYS_INLINE static inline void _ff_unlock(osal_mutex_t mutex)
 
 #endif
 
+// Index access shared between consumer and multiple producers running on other cores: consumer must
+// see the data before the new wr_idx, producer must not overwrite slots before consumer releases them.
+// Fields stay plain volatile in tu_fifo_t (usable from C++), ordering is only added here.
+#if CFG_TUSB_FIFO_MULTI_PRODUCER
+#define _ff_idx_load_acquire(_idx)        __atomic_load_n(&(_idx), __ATOMIC_ACQUIRE)
+#define _ff_idx_store_release(_idx, _v)   __atomic_store_n(&(_idx), (_v), __ATOMIC_RELEASE)
+#else
+#define _ff_idx_load_acquire(_idx)        (_idx)
+#define _ff_idx_store_release(_idx, _v)   ((_idx) = (_v))
+#endif
+
 /** \enum tu_fifo_copy_mode_t
  * \brief Write modes intended to allow special read and write functions to be able to
  *        copy data to and from USB hardware FIFOs as needed for e.g. STM32s and others
@@ -67,22 +79,28 @@ typedef enum
 #endif
 } tu_fifo_copy_mode_t;
 
-bool tu_fifo_config(tu_fifo_t *f, void* buffer, uint16_t depth, uint16_t item_size, bool overwritable)
+bool tu_fifo_config(tu_fifo_t *f, void* buffer, tu_fifo_size_t depth, uint16_t item_size, bool overwritable)
 {
   // Limit index space to 2*depth - this allows for a fast "modulo" calculation
-  // but limits the maximum depth to 2^16/2 = 2^15 and buffer overflows are detectable
+  // but limits the maximum depth to TU_FIFO_DEPTH_MAX and buffer overflows are detectable
   // only if overflow happens once (important for unsupervised DMA applications)
-  if (depth > 0x8000) return false;
+  if (depth > TU_FIFO_DEPTH_MAX) return false;
+  TU_VERIFY(item_size <= TU_FIFO_ITEM_SIZE_MAX);
+  TU_VERIFY(!CFG_TUSB_FIFO_POW2 || TU_FIFO_IS_POW2(depth));
 
   _ff_lock(f->mutex_wr);
   _ff_lock(f->mutex_rd);
 
   f->buffer       = (uint8_t*) buffer;
   f->depth        = depth;
-  f->item_size    = (uint16_t) (item_size & 0x7FFF);
+  f->item_size    = (uint16_t) (item_size & TU_FIFO_ITEM_SIZE_MAX);
   f->overwritable = overwritable;
   f->rd_idx       = 0;
   f->wr_idx       = 0;
+#if CFG_TUSB_FIFO_MULTI_PRODUCER
+  f->wr_claim       = 0;
+  f->multi_producer = false;
+#endif
 
   _ff_unlock(f->mutex_wr);
   _ff_unlock(f->mutex_rd);
@@ -98,12 +116,22 @@ bool tu_fifo_config(tu_fifo_t *f, void* buffer, uint16_t depth, uint16_t item_si
 // Intended to be used to read from hardware USB FIFO in e.g. STM32 where all data is read from a constant address
 // Code adapted from dcd_synopsys.c
 // TODO generalize with configurable 1 byte or 4 byte each read
-static void _ff_push_const_addr(uint8_t * ff_buf, const void * app_buf, uint16_t len)
+static void _ff_push_const_addr(uint8_t * ff_buf, const void * app_buf, uint32_t len)
 {
   volatile const uint32_t * reg_rx = (volatile const uint32_t *) app_buf;
 
   // Reading full available 32 bit words from const app address
-  uint16_t full_words = len >> 2;
+  uint32_t full_words = len >> 2;
+#if CFG_TUSB_FIFO_COPY >= OPT_FIFO_COPY_UNROLLED
+  for(; full_words >= 4; full_words -= 4)
+  {
+    tu_unaligned_write32(ff_buf     , *reg_rx);
+    tu_unaligned_write32(ff_buf +  4, *reg_rx);
+    tu_unaligned_write32(ff_buf +  8, *reg_rx);
+    tu_unaligned_write32(ff_buf + 12, *reg_rx);
+    ff_buf += 16;
+  }
+#endif
   while(full_words--)
   {
     tu_unaligned_write32(ff_buf, *reg_rx);
@@ -121,12 +149,22 @@ static void _ff_push_const_addr(uint8_t * ff_buf, const void * app_buf, uint16_t
 
 // Intended to be used to write to hardware USB FIFO in e.g. STM32
 // where all data is written to a constant address in full word copies
-static void _ff_pull_const_addr(void * app_buf, const uint8_t * ff_buf, uint16_t len)
+static void _ff_pull_const_addr(void * app_buf, const uint8_t * ff_buf, uint32_t len)
 {
   volatile uint32_t * reg_tx = (volatile uint32_t *) app_buf;
 
   // Write full available 32 bit words to const address
-  uint16_t full_words = len >> 2;
+  uint32_t full_words = len >> 2;
+#if CFG_TUSB_FIFO_COPY >= OPT_FIFO_COPY_UNROLLED
+  for(; full_words >= 4; full_words -= 4)
+  {
+    *reg_tx = tu_unaligned_read32(ff_buf     );
+    *reg_tx = tu_unaligned_read32(ff_buf +  4);
+    *reg_tx = tu_unaligned_read32(ff_buf +  8);
+    *reg_tx = tu_unaligned_read32(ff_buf + 12);
+    ff_buf += 16;
+  }
+#endif
   while(full_words--)
   {
     *reg_tx = tu_unaligned_read32(ff_buf);
@@ -146,19 +184,19 @@ static void _ff_pull_const_addr(void * app_buf, const uint8_t * ff_buf, uint16_t
 #endif
 
 // send one item to fifo WITHOUT updating write pointer
-static inline void _ff_push(tu_fifo_t* f, void const * app_buf, uint16_t rel)
+static inline void _ff_push(tu_fifo_t* f, void const * app_buf, tu_fifo_size_t rel)
 {
   memcpy(f->buffer + (rel * f->item_size), app_buf, f->item_size);
 }
 
 // send n items to fifo WITHOUT updating write pointer
-static void _ff_push_n(tu_fifo_t* f, void const * app_buf, uint16_t n, uint16_t wr_ptr, tu_fifo_copy_mode_t copy_mode)
+static void _ff_push_n(tu_fifo_t* f, void const * app_buf, tu_fifo_size_t n, tu_fifo_size_t wr_ptr, tu_fifo_copy_mode_t copy_mode)
 {
-  uint16_t const lin_count = f->depth - wr_ptr;
-  uint16_t const wrap_count = n - lin_count;
+  tu_fifo_size_t const lin_count = f->depth - wr_ptr;
+  tu_fifo_size_t const wrap_count = n - lin_count;
 
-  uint16_t lin_bytes = lin_count * f->item_size;
-  uint16_t wrap_bytes = wrap_count * f->item_size;
+  uint32_t lin_bytes = lin_count * f->item_size;
+  uint32_t wrap_bytes = wrap_count * f->item_size;
 
   // current buffer of fifo
   uint8_t* ff_buf = f->buffer + (wr_ptr * f->item_size);
@@ -169,18 +207,18 @@ static void _ff_push_n(tu_fifo_t* f, void const * app_buf, uint16_t n, uint16_t
       if(n <= lin_count)
       {
         // Linear only
-        memcpy(ff_buf, app_buf, n*f->item_size);
+        tu_fifo_copy(ff_buf, app_buf, n*f->item_size);
       }
       else
       {
         // Wrap around
 
         // Write data to linear part of buffer
-        memcpy(ff_buf, app_buf, lin_bytes);
+        tu_fifo_copy(ff_buf, app_buf, lin_bytes);
 
         // Write data wrapped around
         // TU_ASSERT(nWrap_bytes <= f->depth, );
-        memcpy(f->buffer, ((uint8_t const*) app_buf) + lin_bytes, wrap_bytes);
+        tu_fifo_copy(f->buffer, ((uint8_t const*) app_buf) + lin_bytes, wrap_bytes);
       }
       break;
 #ifdef TUP_MEM_CONST_ADDR
@@ -196,7 +234,7 @@ static void _ff_push_n(tu_fifo_t* f, void const * app_buf, uint16_t n, uint16_t
         // Wrap around case
 
         // Write full words to linear part of buffer
-        uint16_t nLin_4n_bytes = lin_bytes & 0xFFFC;
+        uint32_t nLin_4n_bytes = lin_bytes & ~3u;
         _ff_push_const_addr(ff_buf, app_buf, nLin_4n_bytes);
         ff_buf += nLin_4n_bytes;
 
@@ -206,7 +244,7 @@ static void _ff_push_n(tu_fifo_t* f, void const * app_buf, uint16_t n, uint16_t
         {
           volatile const uint32_t * rx_fifo = (volatile const uint32_t *) app_buf;
 
-          uint8_t remrem = (uint8_t) tu_min16(wrap_bytes, 4-rem);
+          uint8_t remrem = (uint8_t) tu_min32(wrap_bytes, 4-rem);
           wrap_bytes -= remrem;
 
           uint32_t tmp32 = *rx_fifo;
@@ -234,19 +272,19 @@ static void _ff_push_n(tu_fifo_t* f, void const * app_buf, uint16_t n, uint16_t
 }
 
 // get one item from fifo WITHOUT updating read pointer
-static inline void _ff_pull(tu_fifo_t* f, void * app_buf, uint16_t rel)
+static inline void _ff_pull(tu_fifo_t* f, void * app_buf, tu_fifo_size_t rel)
 {
   memcpy(app_buf, f->buffer + (rel * f->item_size), f->item_size);
 }
 
 // get n items from fifo WITHOUT updating read pointer
-static void _ff_pull_n(tu_fifo_t* f, void* app_buf, uint16_t n, uint16_t rd_ptr, tu_fifo_copy_mode_t copy_mode)
+static void _ff_pull_n(tu_fifo_t* f, void* app_buf, tu_fifo_size_t n, tu_fifo_size_t rd_ptr, tu_fifo_copy_mode_t copy_mode)
 {
-  uint16_t const lin_count = f->depth - rd_ptr;
-  uint16_t const wrap_count = n - lin_count; // only used if wrapped
+  tu_fifo_size_t const lin_count = f->depth - rd_ptr;
+  tu_fifo_size_t const wrap_count = n - lin_count; // only used if wrapped
 
-  uint16_t lin_bytes = lin_count * f->item_size;
-  uint16_t wrap_bytes = wrap_count * f->item_size;
+  uint32_t lin_bytes = lin_count * f->item_size;
+  uint32_t wrap_bytes = wrap_count * f->item_size;
 
   // current buffer of fifo
   uint8_t* ff_buf = f->buffer + (rd_ptr * f->item_size);
@@ -257,17 +295,17 @@ static void _ff_pull_n(tu_fifo_t* f, void* app_buf, uint16_t n, uint16_t rd_ptr,
       if ( n <= lin_count )
       {
         // Linear only
-        memcpy(app_buf, ff_buf, n*f->item_size);
+        tu_fifo_copy(app_buf, ff_buf, n*f->item_size);
       }
       else
       {
         // Wrap around
 
         // Read data from linear part of buffer
-        memcpy(app_buf, ff_buf, lin_bytes);
+        tu_fifo_copy(app_buf, ff_buf, lin_bytes);
 
         // Read data wrapped part
-        memcpy((uint8_t*) app_buf + lin_bytes, f->buffer, wrap_bytes);
+        tu_fifo_copy((uint8_t*) app_buf + lin_bytes, f->buffer, wrap_bytes);
       }
     break;
 #ifdef TUP_MEM_CONST_ADDR
@@ -282,7 +320,7 @@ static void _ff_pull_n(tu_fifo_t* f, void* app_buf, uint16_t n, uint16_t rd_ptr,
         // Wrap around case
 
         // Read full words from linear part of buffer
-        uint16_t lin_4n_bytes = lin_bytes & 0xFFFC;
+        uint32_t lin_4n_bytes = lin_bytes & ~3u;
         _ff_pull_const_addr(app_buf, ff_buf, lin_4n_bytes);
         ff_buf += lin_4n_bytes;
 
@@ -292,7 +330,7 @@ static void _ff_pull_n(tu_fifo_t* f, void* app_buf, uint16_t n, uint16_t rd_ptr,
         {
           volatile uint32_t * reg_tx = (volatile uint32_t *) app_buf;
 
-          uint8_t remrem = (uint8_t) tu_min16(wrap_bytes, 4-rem);
+          uint8_t remrem = (uint8_t) tu_min32(wrap_bytes, 4-rem);
           wrap_bytes -= remrem;
 
           uint32_t tmp32=0;
@@ -325,26 +363,37 @@ static void _ff_pull_n(tu_fifo_t* f, void* app_buf, uint16_t n, uint16_t rd_ptr,
 // Helper
 //--------------------------------------------------------------------+
 
+TU_ATTR_ALWAYS_INLINE static inline
+tu_fifo_size_t _ff_min(tu_fifo_size_t x, tu_fifo_size_t y)
+{
+  return (x < y) ? x : y;
+}
+
 // return only the index difference and as such can be used to determine an overflow i.e overflowable count
 TU_ATTR_ALWAYS_INLINE static inline
-uint16_t _ff_count(uint16_t depth, uint16_t wr_idx, uint16_t rd_idx)
+tu_fifo_size_t _ff_count(tu_fifo_t const* f, tu_fifo_size_t wr_idx, tu_fifo_size_t rd_idx)
 {
+#if CFG_TUSB_FIFO_POW2
+  // index space [0..2*depth) is a mask away
+  return (tu_fifo_size_t) ((wr_idx - rd_idx) & (2*f->depth - 1));
+#else
   // In case we have non-power of two depth we need a further modification
   if (wr_idx >= rd_idx)
   {
-    return (uint16_t) (wr_idx - rd_idx);
+    return (tu_fifo_size_t) (wr_idx - rd_idx);
   } else
   {
-    return (uint16_t) (2*depth - (rd_idx - wr_idx));
+    return (tu_fifo_size_t) (2*f->depth - (rd_idx - wr_idx));
   }
+#endif
 }
 
 // return remaining slot in fifo
 TU_ATTR_ALWAYS_INLINE static inline
-uint16_t _ff_remaining(uint16_t depth, uint16_t wr_idx, uint16_t rd_idx)
+tu_fifo_size_t _ff_remaining(tu_fifo_t const* f, tu_fifo_size_t wr_idx, tu_fifo_size_t rd_idx)
 {
-  uint16_t const count = _ff_count(depth, wr_idx, rd_idx);
-  return (depth > count) ? (depth - count) : 0;
+  tu_fifo_size_t const count = _ff_count(f, wr_idx, rd_idx);
+  return (f->depth > count) ? (f->depth - count) : 0;
 }
 
 //--------------------------------------------------------------------+
@@ -353,33 +402,37 @@ uint16_t _ff_remaining(uint16_t depth, uint16_t wr_idx, uint16_t rd_idx)
 
 // Advance an absolute index
 // "absolute" index is only in the range of [0..2*depth)
-static uint16_t advance_index(uint16_t depth, uint16_t idx, uint16_t offset)
+static tu_fifo_size_t advance_index(tu_fifo_t const* f, tu_fifo_size_t idx, tu_fifo_size_t offset)
 {
+#if CFG_TUSB_FIFO_POW2
+  return (tu_fifo_size_t) ((idx + offset) & (2*f->depth - 1));
+#else
   // We limit the index space of p such that a correct wrap around happens
   // Check for a wrap around or if we are in unused index space - This has to be checked first!!
   // We are exploiting the wrap around to the correct index
-  uint16_t new_idx = (uint16_t) (idx + offset);
-  if ( (idx > new_idx) || (new_idx >= 2*depth) )
+  tu_fifo_size_t new_idx = (tu_fifo_size_t) (idx + offset);
+  if ( (idx > new_idx) || (new_idx >= 2*f->depth) )
   {
-    uint16_t const non_used_index_space = (uint16_t) (UINT16_MAX - (2*depth-1));
-    new_idx = (uint16_t) (new_idx + non_used_index_space);
+    tu_fifo_size_t const non_used_index_space = (tu_fifo_size_t) (TU_FIFO_INDEX_MAX - (2*f->depth-1));
+    new_idx = (tu_fifo_size_t) (new_idx + non_used_index_space);
   }
 
   return new_idx;
+#endif
 }
 
 #if 0 // not used but
 // Backward an absolute index
-static uint16_t backward_index(uint16_t depth, uint16_t idx, uint16_t offset)
+static tu_fifo_size_t backward_index(tu_fifo_size_t depth, tu_fifo_size_t idx, tu_fifo_size_t offset)
 {
   // We limit the index space of p such that a correct wrap around happens
   // Check for a wrap around or if we are in unused index space - This has to be checked first!!
   // We are exploiting the wrap around to the correct index
-  uint16_t new_idx = (uint16_t) (idx - offset);
+  tu_fifo_size_t new_idx = (tu_fifo_size_t) (idx - offset);
   if ( (idx < new_idx) || (new_idx >= 2*depth) )
   {
-    uint16_t const non_used_index_space = (uint16_t) (UINT16_MAX - (2*depth-1));
-    new_idx = (uint16_t) (new_idx - non_used_index_space);
+    tu_fifo_size_t const non_used_index_space = (tu_fifo_size_t) (TU_FIFO_INDEX_MAX - (2*depth-1));
+    new_idx = (tu_fifo_size_t) (new_idx - non_used_index_space);
   }
 
   return new_idx;
@@ -388,20 +441,24 @@ static uint16_t backward_index(uint16_t depth, uint16_t idx, uint16_t offset)
 
 // index to pointer, simply an modulo with minus.
 TU_ATTR_ALWAYS_INLINE static inline
-uint16_t idx2ptr(uint16_t depth, uint16_t idx)
+tu_fifo_size_t idx2ptr(tu_fifo_t const* f, tu_fifo_size_t idx)
 {
+#if CFG_TUSB_FIFO_POW2
+  return (tu_fifo_size_t) (idx & (f->depth - 1));
+#else
   // Only run at most 3 times since index is limit in the range of [0..2*depth)
-  while ( idx >= depth ) idx -= depth;
+  while ( idx >= f->depth ) idx -= f->depth;
   return idx;
+#endif
 }
 
 // Works on local copies of w
 // When an overwritable fifo is overflowed, rd_idx will be re-index so that it forms
 // an full fifo i.e _ff_count() = depth
 TU_ATTR_ALWAYS_INLINE static inline
-uint16_t _ff_correct_read_index(tu_fifo_t* f, uint16_t wr_idx)
+tu_fifo_size_t _ff_correct_read_index(tu_fifo_t* f, tu_fifo_size_t wr_idx)
 {
-  uint16_t rd_idx;
+  tu_fifo_size_t rd_idx;
   if ( wr_idx >= f->depth )
   {
     rd_idx = wr_idx - f->depth;
@@ -417,9 +474,9 @@ uint16_t _ff_correct_read_index(tu_fifo_t* f, uint16_t wr_idx)
 
 // Works on local copies of w and r
 // Must be protected by mutexes since in case of an overflow read pointer gets modified
-static bool _tu_fifo_peek(tu_fifo_t* f, void * p_buffer, uint16_t wr_idx, uint16_t rd_idx)
+static bool _tu_fifo_peek(tu_fifo_t* f, void * p_buffer, tu_fifo_size_t wr_idx, tu_fifo_size_t rd_idx)
 {
-  uint16_t cnt = _ff_count(f->depth, wr_idx, rd_idx);
+  tu_fifo_size_t cnt = _ff_count(f, wr_idx, rd_idx);
 
   // nothing to peek
   if ( cnt == 0 ) return false;
@@ -431,7 +488,7 @@ static bool _tu_fifo_peek(tu_fifo_t* f, void * p_buffer, uint16_t wr_idx, uint16
     cnt = f->depth;
   }
 
-  uint16_t rd_ptr = idx2ptr(f->depth, rd_idx);
+  tu_fifo_size_t rd_ptr = idx2ptr(f, rd_idx);
 
   // Peek data
   _ff_pull(f, p_buffer, rd_ptr);
@@ -441,9 +498,9 @@ static bool _tu_fifo_peek(tu_fifo_t* f, void * p_buffer, uint16_t wr_idx, uint16
 
 // Works on local copies of w and r
 // Must be protected by mutexes since in case of an overflow read pointer gets modified
-static uint16_t _tu_fifo_peek_n(tu_fifo_t* f, void * p_buffer, uint16_t n, uint16_t wr_idx, uint16_t rd_idx, tu_fifo_copy_mode_t copy_mode)
+static tu_fifo_size_t _tu_fifo_peek_n(tu_fifo_t* f, void * p_buffer, tu_fifo_size_t n, tu_fifo_size_t wr_idx, tu_fifo_size_t rd_idx, tu_fifo_copy_mode_t copy_mode)
 {
-  uint16_t cnt = _ff_count(f->depth, wr_idx, rd_idx);
+  tu_fifo_size_t cnt = _ff_count(f, wr_idx, rd_idx);
 
   // nothing to peek
   if ( cnt == 0 ) return 0;
@@ -458,7 +515,7 @@ static uint16_t _tu_fifo_peek_n(tu_fifo_t* f, void * p_buffer, uint16_t n, uint1
   // Check if we can read something at and after offset - if too less is available we read what remains
   if ( cnt < n ) n = cnt;
 
-  uint16_t rd_ptr = idx2ptr(f->depth, rd_idx);
+  tu_fifo_size_t rd_ptr = idx2ptr(f, rd_idx);
 
   // Peek data
   _ff_pull_n(f, p_buffer, n, rd_ptr, copy_mode);
@@ -466,25 +523,81 @@ static uint16_t _tu_fifo_peek_n(tu_fifo_t* f, void * p_buffer, uint16_t n, uint1
   return n;
 }
 
-static uint16_t _tu_fifo_write_n(tu_fifo_t* f, const void * data, uint16_t n, tu_fifo_copy_mode_t copy_mode)
+#if CFG_TUSB_FIFO_MULTI_PRODUCER
+
+// Number of polls before yielding to a preempted producer which has not published yet
+#define TU_FIFO_MP_SPIN_MAX   64
+
+// Multiple producers without mutex:
+// - Claim: producers reserve [wr_claim, wr_claim+n) by compare-and-swap on wr_claim.
+// - Copy : data is copied into claimed slots concurrently.
+// - Publish: wr_idx is advanced in claim order, each producer waits until wr_idx reaches the start
+//   of its claim i.e all preceding producers have published, then stores the end of its claim.
+// Consumer only ever sees wr_idx therefore read functions work unmodified.
+static tu_fifo_size_t _tu_fifo_write_n_mp(tu_fifo_t* f, const void * data, tu_fifo_size_t n, tu_fifo_copy_mode_t copy_mode)
+{
+  tu_fifo_size_t wr_idx = __atomic_load_n(&f->wr_claim, __ATOMIC_RELAXED);
+  tu_fifo_size_t new_idx;
+  tu_fifo_size_t count;
+
+  do
+  {
+    // limit up to full, in-flight claims are counted as used. Acquire: consumer is done with the
+    // slots below rd_idx before we overwrite them
+    count = _ff_min(n, _ff_remaining(f, wr_idx, _ff_idx_load_acquire(f->rd_idx)));
+    if ( count == 0 ) return 0;
+
+    new_idx = advance_index(f, wr_idx, count);
+  } while ( !__atomic_compare_exchange_n(&f->wr_claim, &wr_idx, new_idx, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED) );
+
+  _ff_push_n(f, data, count, idx2ptr(f, wr_idx), copy_mode);
+
+  // wait for preceding producers, yield in case one of them is preempted by us. Without RTOS there
+  // is nothing to yield to: a preceding producer must be running on another core (see tusb_fifo.h).
+  // Acquire pairs with predecessor's release so that our release below also covers its slots
+  uint32_t spin = 0;
+  while ( _ff_idx_load_acquire(f->wr_idx) != wr_idx )
+  {
+    if ( ++spin >= TU_FIFO_MP_SPIN_MAX )
+    {
+      spin = 0;
+#if CFG_TUSB_OS != OPT_OS_NONE
+      osal_task_delay(1);
+#endif
+    }
+  }
+
+  // release: data must be visible before consumer sees new index
+  _ff_idx_store_release(f->wr_idx, new_idx);
+
+  return count;
+}
+
+#endif
+
+static tu_fifo_size_t _tu_fifo_write_n(tu_fifo_t* f, const void * data, tu_fifo_size_t n, tu_fifo_copy_mode_t copy_mode)
 {
   if ( n == 0 ) return 0;
 
+#if CFG_TUSB_FIFO_MULTI_PRODUCER
+  if ( f->multi_producer ) return _tu_fifo_write_n_mp(f, data, n, copy_mode);
+#endif
+
   _ff_lock(f->mutex_wr);
 
-  uint16_t wr_idx = f->wr_idx;
-  uint16_t rd_idx = f->rd_idx;
+  tu_fifo_size_t wr_idx = f->wr_idx;
+  tu_fifo_size_t rd_idx = f->rd_idx;
 
   uint8_t const* buf8 = (uint8_t const*) data;
 
   TU_LOG(TU_FIFO_DBG, "rd = %3u, wr = %3u, count = %3u, remain = %3u, n = %3u:  ",
-                       rd_idx, wr_idx, _ff_count(f->depth, wr_idx, rd_idx), _ff_remaining(f->depth, wr_idx, rd_idx), n);
+                       rd_idx, wr_idx, _ff_count(f, wr_idx, rd_idx), _ff_remaining(f, wr_idx, rd_idx), n);
 
   if ( !f->overwritable )
   {
     // limit up to full
-    uint16_t const remain = _ff_remaining(f->depth, wr_idx, rd_idx);
-    n = tu_min16(n, remain);
+    tu_fifo_size_t const remain = _ff_remaining(f, wr_idx, rd_idx);
+    n = _ff_min(n, remain);
   }
   else
   {
@@ -511,13 +624,13 @@ static uint16_t _tu_fifo_write_n(tu_fifo_t* f, const void * data, uint16_t n, tu
     }
     else
     {
-      uint16_t const overflowable_count = _ff_count(f->depth, wr_idx, rd_idx);
+      tu_fifo_size_t const overflowable_count = _ff_count(f, wr_idx, rd_idx);
       if (overflowable_count + n >= 2*f->depth)
       {
         // Double overflowed
         // Index is bigger than the allowed range [0,2*depth)
         // re-position write index to have a full fifo after pushed
-        wr_idx = advance_index(f->depth, rd_idx, f->depth - n);
+        wr_idx = advance_index(f, rd_idx, f->depth - n);
 
         // TODO we should also shift out n bytes from read index since we avoid changing rd index !!
         // However memmove() is expensive due to actual copying + wrapping consideration.
@@ -535,7 +648,7 @@ static uint16_t _tu_fifo_write_n(tu_fifo_t* f, const void * data, uint16_t n, tu
 
   if (n)
   {
-    uint16_t wr_ptr = idx2ptr(f->depth, wr_idx);
+    tu_fifo_size_t wr_ptr = idx2ptr(f, wr_idx);
 
     TU_LOG(TU_FIFO_DBG, "actual_n = %u, wr_ptr = %u", n, wr_ptr);
 
@@ -543,7 +656,7 @@ static uint16_t _tu_fifo_write_n(tu_fifo_t* f, const void * data, uint16_t n, tu
     _ff_push_n(f, buf8, n, wr_ptr, copy_mode);
 
     // Advance index
-    f->wr_idx = advance_index(f->depth, wr_idx, n);
+    f->wr_idx = advance_index(f, wr_idx, n);
 
     TU_LOG(TU_FIFO_DBG, "\tnew_wr = %u\r\n", f->wr_idx);
   }
@@ -553,16 +666,16 @@ static uint16_t _tu_fifo_write_n(tu_fifo_t* f, const void * data, uint16_t n, tu
   return n;
 }
 
-static uint16_t _tu_fifo_read_n(tu_fifo_t* f, void * buffer, uint16_t n, tu_fifo_copy_mode_t copy_mode)
+static tu_fifo_size_t _tu_fifo_read_n(tu_fifo_t* f, void * buffer, tu_fifo_size_t n, tu_fifo_copy_mode_t copy_mode)
 {
   _ff_lock(f->mutex_rd);
 
   // Peek the data
   // f->rd_idx might get modified in case of an overflow so we can not use a local variable
-  n = _tu_fifo_peek_n(f, buffer, n, f->wr_idx, f->rd_idx, copy_mode);
+  n = _tu_fifo_peek_n(f, buffer, n, _ff_idx_load_acquire(f->wr_idx), f->rd_idx, copy_mode);
 
   // Advance read pointer
-  f->rd_idx = advance_index(f->depth, f->rd_idx, n);
+  _ff_idx_store_release(f->rd_idx, advance_index(f, f->rd_idx, n));
 
   _ff_unlock(f->mutex_rd);
   return n;
@@ -587,9 +700,9 @@ static uint16_t _tu_fifo_read_n(tu_fifo_t* f, void * buffer, uint16_t n, tu_fifo
     @returns Number of items in FIFO
  */
 /******************************************************************************/
-uint16_t tu_fifo_count(tu_fifo_t* f)
+tu_fifo_size_t tu_fifo_count(tu_fifo_t* f)
 {
-  return tu_min16(_ff_count(f->depth, f->wr_idx, f->rd_idx), f->depth);
+  return _ff_min(_ff_count(f, f->wr_idx, f->rd_idx), f->depth);
 }
 
 /******************************************************************************/
@@ -625,7 +738,7 @@ bool tu_fifo_empty(tu_fifo_t* f)
 /******************************************************************************/
 bool tu_fifo_full(tu_fifo_t* f)
 {
-  return _ff_count(f->depth, f->wr_idx, f->rd_idx) >= f->depth;
+  return _ff_count(f, f->wr_idx, f->rd_idx) >= f->depth;
 }
 
 /******************************************************************************/
@@ -641,9 +754,9 @@ bool tu_fifo_full(tu_fifo_t* f)
     @returns Number of items in FIFO
  */
 /******************************************************************************/
-uint16_t tu_fifo_remaining(tu_fifo_t* f)
+tu_fifo_size_t tu_fifo_remaining(tu_fifo_t* f)
 {
-  return _ff_remaining(f->depth, f->wr_idx, f->rd_idx);
+  return _ff_remaining(f, f->wr_idx, f->rd_idx);
 }
 
 /******************************************************************************/
@@ -669,7 +782,7 @@ uint16_t tu_fifo_remaining(tu_fifo_t* f)
 /******************************************************************************/
 bool tu_fifo_overflowed(tu_fifo_t* f)
 {
-  return _ff_count(f->depth, f->wr_idx, f->rd_idx) > f->depth;
+  return _ff_count(f, f->wr_idx, f->rd_idx) > f->depth;
 }
 
 // Only use in case tu_fifo_overflow() returned true!
@@ -702,10 +815,10 @@ bool tu_fifo_read(tu_fifo_t* f, void * buffer)
 
   // Peek the data
   // f->rd_idx might get modified in case of an overflow so we can not use a local variable
-  bool ret = _tu_fifo_peek(f, buffer, f->wr_idx, f->rd_idx);
+  bool ret = _tu_fifo_peek(f, buffer, _ff_idx_load_acquire(f->wr_idx), f->rd_idx);
 
   // Advance pointer
-  f->rd_idx = advance_index(f->depth, f->rd_idx, ret);
+  _ff_idx_store_release(f->rd_idx, advance_index(f, f->rd_idx, ret));
 
   _ff_unlock(f->mutex_rd);
   return ret;
@@ -727,7 +840,7 @@ bool tu_fifo_read(tu_fifo_t* f, void * buffer)
     @returns number of items read from the FIFO
  */
 /******************************************************************************/
-uint16_t tu_fifo_read_n(tu_fifo_t* f, void * buffer, uint16_t n)
+tu_fifo_size_t tu_fifo_read_n(tu_fifo_t* f, void * buffer, tu_fifo_size_t n)
 {
   return _tu_fifo_read_n(f, buffer, n, TU_FIFO_COPY_INC);
 }
@@ -750,7 +863,7 @@ uint16_t tu_fifo_read_n(tu_fifo_t* f, void * buffer, uint16_t n)
     @returns number of items read from the FIFO
  */
 /******************************************************************************/
-uint16_t tu_fifo_read_n_const_addr_full_words(tu_fifo_t* f, void * buffer, uint16_t n)
+tu_fifo_size_t tu_fifo_read_n_const_addr_full_words(tu_fifo_t* f, void * buffer, tu_fifo_size_t n)
 {
   return _tu_fifo_read_n(f, buffer, n, TU_FIFO_COPY_CST_FULL_WORDS);
 }
@@ -772,7 +885,7 @@ uint16_t tu_fifo_read_n_const_addr_full_words(tu_fifo_t* f, void * buffer, uint1
 bool tu_fifo_peek(tu_fifo_t* f, void * p_buffer)
 {
   _ff_lock(f->mutex_rd);
-  bool ret = _tu_fifo_peek(f, p_buffer, f->wr_idx, f->rd_idx);
+  bool ret = _tu_fifo_peek(f, p_buffer, _ff_idx_load_acquire(f->wr_idx), f->rd_idx);
   _ff_unlock(f->mutex_rd);
   return ret;
 }
@@ -792,10 +905,10 @@ bool tu_fifo_peek(tu_fifo_t* f, void * p_buffer)
     @returns Number of bytes written to p_buffer
  */
 /******************************************************************************/
-uint16_t tu_fifo_peek_n(tu_fifo_t* f, void * p_buffer, uint16_t n)
+tu_fifo_size_t tu_fifo_peek_n(tu_fifo_t* f, void * p_buffer, tu_fifo_size_t n)
 {
   _ff_lock(f->mutex_rd);
-  uint16_t ret = _tu_fifo_peek_n(f, p_buffer, n, f->wr_idx, f->rd_idx, TU_FIFO_COPY_INC);
+  tu_fifo_size_t ret = _tu_fifo_peek_n(f, p_buffer, n, _ff_idx_load_acquire(f->wr_idx), f->rd_idx, TU_FIFO_COPY_INC);
   _ff_unlock(f->mutex_rd);
   return ret;
 }
@@ -818,23 +931,27 @@ uint16_t tu_fifo_peek_n(tu_fifo_t* f, void * p_buffer, uint16_t n)
 /******************************************************************************/
 bool tu_fifo_write(tu_fifo_t* f, const void * data)
 {
+#if CFG_TUSB_FIFO_MULTI_PRODUCER
+  if ( f->multi_producer ) return _tu_fifo_write_n_mp(f, data, 1, TU_FIFO_COPY_INC) == 1;
+#endif
+
   _ff_lock(f->mutex_wr);
 
   bool ret;
-  uint16_t const wr_idx = f->wr_idx;
+  tu_fifo_size_t const wr_idx = f->wr_idx;
 
   if ( tu_fifo_full(f) && !f->overwritable )
   {
     ret = false;
   }else
   {
-    uint16_t wr_ptr = idx2ptr(f->depth, wr_idx);
+    tu_fifo_size_t wr_ptr = idx2ptr(f, wr_idx);
 
     // Write data
     _ff_push(f, data, wr_ptr);
 
     // Advance pointer
-    f->wr_idx = advance_index(f->depth, wr_idx, 1);
+    f->wr_idx = advance_index(f, wr_idx, 1);
 
     ret = true;
   }
@@ -858,7 +975,7 @@ bool tu_fifo_write(tu_fifo_t* f, const void * data)
     @return Number of written elements
  */
 /******************************************************************************/
-uint16_t tu_fifo_write_n(tu_fifo_t* f, const void * data, uint16_t n)
+tu_fifo_size_t tu_fifo_write_n(tu_fifo_t* f, const void * data, tu_fifo_size_t n)
 {
   return _tu_fifo_write_n(f, data, n, TU_FIFO_COPY_INC);
 }
@@ -879,7 +996,7 @@ uint16_t tu_fifo_write_n(tu_fifo_t* f, const void * data, uint16_t n)
     @return Number of written elements
  */
 /******************************************************************************/
-uint16_t tu_fifo_write_n_const_addr_full_words(tu_fifo_t* f, const void * data, uint16_t n)
+tu_fifo_size_t tu_fifo_write_n_const_addr_full_words(tu_fifo_t* f, const void * data, tu_fifo_size_t n)
 {
   return _tu_fifo_write_n(f, data, n, TU_FIFO_COPY_CST_FULL_WORDS);
 }
@@ -900,6 +1017,9 @@ bool tu_fifo_clear(tu_fifo_t *f)
 
   f->rd_idx = 0;
   f->wr_idx = 0;
+#if CFG_TUSB_FIFO_MULTI_PRODUCER
+  f->wr_claim = 0;
+#endif
 
   _ff_unlock(f->mutex_wr);
   _ff_unlock(f->mutex_rd);
@@ -918,6 +1038,11 @@ bool tu_fifo_clear(tu_fifo_t *f)
 /******************************************************************************/
 bool tu_fifo_set_overwritable(tu_fifo_t *f, bool overwritable)
 {
+#if CFG_TUSB_FIFO_MULTI_PRODUCER
+  // overwriting is not supported with multiple producers
+  TU_VERIFY(!(overwritable && f->multi_producer));
+#endif
+
   _ff_lock(f->mutex_wr);
   _ff_lock(f->mutex_rd);
 
@@ -929,6 +1054,35 @@ bool tu_fifo_set_overwritable(tu_fifo_t *f, bool overwritable)
   return true;
 }
 
+#if CFG_TUSB_FIFO_MULTI_PRODUCER
+/******************************************************************************/
+/*!
+    @brief Allow multiple producers to write to the fifo concurrently without
+    mutex. Should be changed while no producer is writing.
+
+    @param[in]  f
+                Pointer to the FIFO buffer to manipulate
+    @param[in]  multi_producer
+                Enable or disable multiple producer mode
+
+    @returns false if fifo is overwritable
+ */
+/******************************************************************************/
+bool tu_fifo_set_multi_producer(tu_fifo_t *f, bool multi_producer)
+{
+  TU_VERIFY(!(multi_producer && f->overwritable));
+
+  _ff_lock(f->mutex_wr);
+
+  f->wr_claim       = f->wr_idx;
+  f->multi_producer = multi_producer;
+
+  _ff_unlock(f->mutex_wr);
+
+  return true;
+}
+#endif
+
 /******************************************************************************/
 /*!
     @brief Advance write pointer - intended to be used in combination with DMA.
@@ -945,9 +1099,13 @@ bool tu_fifo_set_overwritable(tu_fifo_t *f, bool overwritable)
                 Number of items the write pointer moves forward
  */
 /******************************************************************************/
-void tu_fifo_advance_write_pointer(tu_fifo_t *f, uint16_t n)
+void tu_fifo_advance_write_pointer(tu_fifo_t *f, tu_fifo_size_t n)
 {
-  f->wr_idx = advance_index(f->depth, f->wr_idx, n);
+#if CFG_TUSB_FIFO_MULTI_PRODUCER
+  TU_VERIFY(!f->multi_producer, );
+#endif
+
+  f->wr_idx = advance_index(f, f->wr_idx, n);
 }
 
 /******************************************************************************/
@@ -966,9 +1124,9 @@ void tu_fifo_advance_write_pointer(tu_fifo_t *f, uint16_t n)
                 Number of items the read pointer moves forward
  */
 /******************************************************************************/
-void tu_fifo_advance_read_pointer(tu_fifo_t *f, uint16_t n)
+void tu_fifo_advance_read_pointer(tu_fifo_t *f, tu_fifo_size_t n)
 {
-  f->rd_idx = advance_index(f->depth, f->rd_idx, n);
+  _ff_idx_store_release(f->rd_idx, advance_index(f, f->rd_idx, n));
 }
 
 /******************************************************************************/
@@ -989,10 +1147,10 @@ void tu_fifo_advance_read_pointer(tu_fifo_t *f, uint16_t n)
 void tu_fifo_get_read_info(tu_fifo_t *f, tu_fifo_buffer_info_t *info)
 {
   // Operate on temporary values in case they change in between
-  uint16_t wr_idx = f->wr_idx;
-  uint16_t rd_idx = f->rd_idx;
+  tu_fifo_size_t wr_idx = _ff_idx_load_acquire(f->wr_idx);
+  tu_fifo_size_t rd_idx = f->rd_idx;
 
-  uint16_t cnt = _ff_count(f->depth, wr_idx, rd_idx);
+  tu_fifo_size_t cnt = _ff_count(f, wr_idx, rd_idx);
 
   // Check overflow and correct if required - may happen in case a DMA wrote too fast
   if (cnt > f->depth)
@@ -1015,8 +1173,8 @@ void tu_fifo_get_read_info(tu_fifo_t *f, tu_fifo_buffer_info_t *info)
   }
 
   // Get relative pointers
-  uint16_t wr_ptr = idx2ptr(f->depth, wr_idx);
-  uint16_t rd_ptr = idx2ptr(f->depth, rd_idx);
+  tu_fifo_size_t wr_ptr = idx2ptr(f, wr_idx);
+  tu_fifo_size_t rd_ptr = idx2ptr(f, rd_idx);
 
   // Copy pointer to buffer to start reading from
   info->ptr_lin = &f->buffer[rd_ptr];
@@ -1056,9 +1214,14 @@ void tu_fifo_get_read_info(tu_fifo_t *f, tu_fifo_buffer_info_t *info)
 /******************************************************************************/
 void tu_fifo_get_write_info(tu_fifo_t *f, tu_fifo_buffer_info_t *info)
 {
-  uint16_t wr_idx = f->wr_idx;
-  uint16_t rd_idx = f->rd_idx;
-  uint16_t remain = _ff_remaining(f->depth, wr_idx, rd_idx);
+  tu_fifo_size_t wr_idx = f->wr_idx;
+  tu_fifo_size_t rd_idx = f->rd_idx;
+  tu_fifo_size_t remain = _ff_remaining(f, wr_idx, rd_idx);
+
+#if CFG_TUSB_FIFO_MULTI_PRODUCER
+  // writing outside of claim is not supported with multiple producers
+  if (f->multi_producer) remain = 0;
+#endif
 
   if (remain == 0)
   {
@@ -1070,8 +1233,8 @@ void tu_fifo_get_write_info(tu_fifo_t *f, tu_fifo_buffer_info_t *info)
   }
 
   // Get relative pointers
-  uint16_t wr_ptr = idx2ptr(f->depth, wr_idx);
-  uint16_t rd_ptr = idx2ptr(f->depth, rd_idx);
+  tu_fifo_size_t wr_ptr = idx2ptr(f, wr_idx);
+  tu_fifo_size_t rd_ptr = idx2ptr(f, rd_idx);
 
   // Copy pointer to buffer to start writing to
   info->ptr_lin = &f->buffer[wr_ptr];
@@ -1090,3 +1253,175 @@ void tu_fifo_get_write_info(tu_fifo_t *f, tu_fifo_buffer_info_t *info)
     info->ptr_wrap = f->buffer;              // Always start of buffer
   }
 }
+
+//--------------------------------------------------------------------+
+// Zero-copy Reserve & Commit API
+//--------------------------------------------------------------------+
+
+/******************************************************************************/
+/*!
+   @brief Reserve a linear region to write into
+
+   Returns a pointer to the write position and the number of items (at most n)
+   that can be written there without wrapping. In overwritable mode the oldest
+   items may be reserved as well. Nothing is modified until
+   tu_fifo_write_commit() is invoked.
+   @param[in]       f
+                    Pointer to FIFO
+   @param[out]      ptr
+                    Start of the reserved region, NULL if nothing can be written
+   @param[in]       n
+                    Number of items wanted
+
+   @returns Number of items reserved
+ */
+/******************************************************************************/
+tu_fifo_size_t tu_fifo_write_reserve(tu_fifo_t* f, void** ptr, tu_fifo_size_t n)
+{
+  *ptr = NULL;
+#if CFG_TUSB_FIFO_MULTI_PRODUCER
+  TU_VERIFY(!f->multi_producer, 0);
+#endif
+
+  // Operate on temporary values in case they change in between
+  tu_fifo_size_t const wr_idx = f->wr_idx;
+  tu_fifo_size_t const rd_idx = f->rd_idx;
+  tu_fifo_size_t const wr_ptr = idx2ptr(f, wr_idx);
+
+  tu_fifo_size_t const avail = f->overwritable ? f->depth : _ff_remaining(f, wr_idx, rd_idx);
+  n = _ff_min(n, _ff_min(avail, (tu_fifo_size_t) (f->depth - wr_ptr)));
+
+  *ptr = n ? (f->buffer + (wr_ptr * f->item_size)) : NULL;
+  return n;
+}
+
+/******************************************************************************/
+/*!
+   @brief Commit items written into the region returned by tu_fifo_write_reserve()
+
+   Advance write pointer by n, n is limited to what could have been reserved.
+   In overwritable mode, write index is re-positioned in case of double overflow
+   so that read functions can recover the latest depth items.
+   @param[in]       f
+                    Pointer to FIFO
+   @param[in]       n
+                    Number of items written
+
+   @returns Number of items committed
+ */
+/******************************************************************************/
+tu_fifo_size_t tu_fifo_write_commit(tu_fifo_t* f, tu_fifo_size_t n)
+{
+  if ( n == 0 ) return 0;
+#if CFG_TUSB_FIFO_MULTI_PRODUCER
+  TU_VERIFY(!f->multi_producer, 0);
+#endif
+
+  _ff_lock(f->mutex_wr);
+
+  tu_fifo_size_t wr_idx = f->wr_idx;
+  tu_fifo_size_t const rd_idx = f->rd_idx;
+
+  n = _ff_min(n, (tu_fifo_size_t) (f->depth - idx2ptr(f, wr_idx)));
+
+  if ( !f->overwritable )
+  {
+    n = _ff_min(n, _ff_remaining(f, wr_idx, rd_idx));
+  }
+  else if ( _ff_count(f, wr_idx, rd_idx) + n >= 2*f->depth )
+  {
+    // Double overflowed: data is already in place, so skip a whole depth instead of moving
+    // write index back as write_n() does. Index points to the same slot but count is now in
+    // the recoverable range [depth, 2*depth) and read index is corrected by the reader.
+    wr_idx = advance_index(f, wr_idx, f->depth);
+  }
+
+  f->wr_idx = advance_index(f, wr_idx, n);
+
+  _ff_unlock(f->mutex_wr);
+
+  return n;
+}
+
+/******************************************************************************/
+/*!
+   @brief Reserve a linear region to read from
+
+   Returns a pointer to the read position and the number of items (at most n)
+   that can be read there without wrapping. This function checks for an overflow
+   and corrects read pointer if required. Nothing is consumed until
+   tu_fifo_read_commit() is invoked.
+   @param[in]       f
+                    Pointer to FIFO
+   @param[out]      ptr
+                    Start of the reserved region, NULL if fifo is empty
+   @param[in]       n
+                    Number of items wanted
+
+   @returns Number of items reserved
+ */
+/******************************************************************************/
+tu_fifo_size_t tu_fifo_read_reserve(tu_fifo_t* f, void** ptr, tu_fifo_size_t n)
+{
+  _ff_lock(f->mutex_rd);
+
+  tu_fifo_size_t const wr_idx = _ff_idx_load_acquire(f->wr_idx);
+  tu_fifo_size_t rd_idx = f->rd_idx;
+  tu_fifo_size_t cnt = _ff_count(f, wr_idx, rd_idx);
+
+  // Check overflow and correct if required
+  if ( cnt > f->depth )
+  {
+    rd_idx = _ff_correct_read_index(f, wr_idx);
+    cnt = f->depth;
+  }
+
+  tu_fifo_size_t const rd_ptr = idx2ptr(f, rd_idx);
+  n = _ff_min(n, _ff_min(cnt, (tu_fifo_size_t) (f->depth - rd_ptr)));
+
+  _ff_unlock(f->mutex_rd);
+
+  *ptr = n ? (f->buffer + (rd_ptr * f->item_size)) : NULL;
+  return n;
+}
+
+/******************************************************************************/
+/*!
+   @brief Release items consumed from the region returned by tu_fifo_read_reserve()
+
+   Advance read pointer by n, n is limited to what could have been reserved.
+   If an overwritable fifo was overflowed in the meantime, the consumed items are
+   already lost: read pointer is corrected to the oldest valid item instead.
+   @param[in]       f
+                    Pointer to FIFO
+   @param[in]       n
+                    Number of items consumed
+
+   @returns Number of items released
+ */
+/******************************************************************************/
+tu_fifo_size_t tu_fifo_read_commit(tu_fifo_t* f, tu_fifo_size_t n)
+{
+  if ( n == 0 ) return 0;
+
+  _ff_lock(f->mutex_rd);
+
+  tu_fifo_size_t const wr_idx = f->wr_idx;
+  tu_fifo_size_t const rd_idx = f->rd_idx;
+  tu_fifo_size_t const cnt = _ff_count(f, wr_idx, rd_idx);
+
+  if ( cnt > f->depth )
+  {
+    _ff_correct_read_index(f, wr_idx);
+    n = 0;
+  }
+  else
+  {
+    n = _ff_min(n, _ff_min(cnt, (tu_fifo_size_t) (f->depth - idx2ptr(f, rd_idx))));
+    _ff_idx_store_release(f->rd_idx, advance_index(f, rd_idx, n));
+  }
+
+  _ff_unlock(f->mutex_rd);
+
+  return n;
+}
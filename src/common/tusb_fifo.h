@@ -48,6 +48,21 @@ extern "C" {
 // for OS None, we don't get preempted
 #define CFG_FIFO_MUTEX      OSAL_MUTEX_REQUIRED
 
+// Index and item count type. 16-bit index limits depth to 0x8000 items, CFG_TUSB_FIFO_WIDE_INDEX
+// switches all fifos to 32-bit index for large buffers e.g high speed bulk streaming.
+#if CFG_TUSB_FIFO_WIDE_INDEX
+typedef uint32_t tu_fifo_size_t;
+#define TU_FIFO_INDEX_MAX   UINT32_MAX
+#define TU_FIFO_DEPTH_MAX   0x40000000u // keep 2*depth within 32-bit
+#else
+typedef uint16_t tu_fifo_size_t;
+#define TU_FIFO_INDEX_MAX   UINT16_MAX
+#define TU_FIFO_DEPTH_MAX   0x8000u
+#endif
+
+// item_size shares 16 bits with overwritable flag, larger item is rejected by tu_fifo_config()
+#define TU_FIFO_ITEM_SIZE_MAX   0x7FFFu
+
 /* Write/Read index is always in the range of:
  *      0 .. 2*depth-1
  * The extra window allow us to determine the fifo state of empty or full with only 2 indices
@@ -105,15 +120,20 @@ extern "C" {
  */
 typedef struct {
   uint8_t* buffer          ; // buffer pointer
-  uint16_t depth           ; // max items
+  tu_fifo_size_t depth     ; // max items
 
   struct TU_ATTR_PACKED {
-    uint16_t item_size : 15; // size of each item
+    uint16_t item_size : 15; // size of each item, at most TU_FIFO_ITEM_SIZE_MAX (32767) bytes
     bool overwritable  : 1 ; // ovwerwritable when full
   };
 
-  volatile uint16_t wr_idx ; // write index
-  volatile uint16_t rd_idx ; // read index
+  volatile tu_fifo_size_t wr_idx  ; // write index, in multi producer mode published in claim order
+  volatile tu_fifo_size_t rd_idx  ; // read index
+
+#if CFG_TUSB_FIFO_MULTI_PRODUCER
+  volatile tu_fifo_size_t wr_claim; // index claimed by producers, ahead of wr_idx while data is being copied
+  bool multi_producer;
+#endif
 
 #if OSAL_MUTEX_REQUIRED
   osal_mutex_t mutex_wr;
@@ -123,12 +143,16 @@ typedef struct {
 } tu_fifo_t;
 
 typedef struct {
-  uint16_t len_lin  ; ///< linear length in item size
-  uint16_t len_wrap ; ///< wrapped length in item size
+  tu_fifo_size_t len_lin  ; ///< linear length in item size
+  tu_fifo_size_t len_wrap ; ///< wrapped length in item size
   void * ptr_lin    ; ///< linear part start pointer
   void * ptr_wrap   ; ///< wrapped part start pointer
 } tu_fifo_buffer_info_t;
 
+// Depth that can use mask instead of modulo for index math, required by CFG_TUSB_FIFO_POW2
+#define TU_FIFO_IS_POW2(_depth)   (((_depth) != 0) && (((_depth) & ((_depth) - 1)) == 0))
+
+// sizeof(_type) must not exceed TU_FIFO_ITEM_SIZE_MAX, _depth must be power of two with CFG_TUSB_FIFO_POW2
 #define TU_FIFO_INIT(_buffer, _depth, _type, _overwritable){\
   .buffer               = _buffer,                          \
   .depth                = _depth,                           \
@@ -142,7 +166,17 @@ typedef struct {
 
 bool tu_fifo_set_overwritable(tu_fifo_t *f, bool overwritable);
 bool tu_fifo_clear(tu_fifo_t *f);
-bool tu_fifo_config(tu_fifo_t *f, void* buffer, uint16_t depth, uint16_t item_size, bool overwritable);
+bool tu_fifo_config(tu_fifo_t *f, void* buffer, tu_fifo_size_t depth, uint16_t item_size, bool overwritable);
+
+#if CFG_TUSB_FIFO_MULTI_PRODUCER
+// Multiple producers (tasks or cores) can write concurrently without taking mutex_wr. Only
+// tu_fifo_write() and tu_fifo_write_n() are supported, fifo must not be overwritable. Other write
+// functions (reserve/commit, write info, advance write pointer) do nothing while it is enabled.
+// A producer waits for the ones which claimed before it to publish, therefore a producer must never
+// preempt another one on the same core: no ISR producer, and with OPT_OS_NONE only one producer
+// per core. Otherwise it spins forever.
+bool tu_fifo_set_multi_producer(tu_fifo_t *f, bool multi_producer);
+#endif
 
 #if OSAL_MUTEX_REQUIRED
 TU_ATTR_ALWAYS_INLINE static inline
@@ -154,37 +188,37 @@ void tu_fifo_config_mutex(tu_fifo_t *f, osal_mutex_t wr_mutex, osal_mutex_t rd_m
 #define tu_fifo_config_mutex(_f, _wr_mutex, _rd_mutex)
 #endif
 
-bool     tu_fifo_write                  (tu_fifo_t* f, void const * data);
-uint16_t tu_fifo_write_n                (tu_fifo_t* f, void const * data, uint16_t n);
+bool           tu_fifo_write                 (tu_fifo_t* f, void const * data);
+tu_fifo_size_t tu_fifo_write_n               (tu_fifo_t* f, void const * data, tu_fifo_size_t n);
 #ifdef TUP_MEM_CONST_ADDR
-uint16_t tu_fifo_write_n_const_addr_full_words    (tu_fifo_t* f, const void * data, uint16_t n);
+tu_fifo_size_t tu_fifo_write_n_const_addr_full_words (tu_fifo_t* f, const void * data, tu_fifo_size_t n);
 #endif
 
-bool     tu_fifo_read                   (tu_fifo_t* f, void * buffer);
-uint16_t tu_fifo_read_n                 (tu_fifo_t* f, void * buffer, uint16_t n);
+bool           tu_fifo_read                  (tu_fifo_t* f, void * buffer);
+tu_fifo_size_t tu_fifo_read_n                (tu_fifo_t* f, void * buffer, tu_fifo_size_t n);
 #ifdef TUP_MEM_CONST_ADDR
-uint16_t tu_fifo_read_n_const_addr_full_words     (tu_fifo_t* f, void * buffer, uint16_t n);
+tu_fifo_size_t tu_fifo_read_n_const_addr_full_words (tu_fifo_t* f, void * buffer, tu_fifo_size_t n);
 #endif
 
-bool     tu_fifo_peek                   (tu_fifo_t* f, void * p_buffer);
-uint16_t tu_fifo_peek_n                 (tu_fifo_t* f, void * p_buffer, uint16_t n);
+bool           tu_fifo_peek                  (tu_fifo_t* f, void * p_buffer);
+tu_fifo_size_t tu_fifo_peek_n                (tu_fifo_t* f, void * p_buffer, tu_fifo_size_t n);
 
-uint16_t tu_fifo_count                  (tu_fifo_t* f);
-uint16_t tu_fifo_remaining              (tu_fifo_t* f);
-bool     tu_fifo_empty                  (tu_fifo_t* f);
-bool     tu_fifo_full                   (tu_fifo_t* f);
-bool     tu_fifo_overflowed             (tu_fifo_t* f);
-void     tu_fifo_correct_read_pointer   (tu_fifo_t* f);
+tu_fifo_size_t tu_fifo_count                 (tu_fifo_t* f);
+tu_fifo_size_t tu_fifo_remaining             (tu_fifo_t* f);
+bool           tu_fifo_empty                 (tu_fifo_t* f);
+bool           tu_fifo_full                  (tu_fifo_t* f);
+bool           tu_fifo_overflowed            (tu_fifo_t* f);
+void           tu_fifo_correct_read_pointer  (tu_fifo_t* f);
 
 TU_ATTR_ALWAYS_INLINE static inline
-uint16_t tu_fifo_depth(tu_fifo_t* f) {
+tu_fifo_size_t tu_fifo_depth(tu_fifo_t* f) {
   return f->depth;
 }
 
 // Pointer modifications intended to be used in combinations with DMAs.
 // USE WITH CARE - NO SAFETY CHECKS CONDUCTED HERE! NOT MUTEX PROTECTED!
-void tu_fifo_advance_write_pointer(tu_fifo_t *f, uint16_t n);
-void tu_fifo_advance_read_pointer (tu_fifo_t *f, uint16_t n);
+void tu_fifo_advance_write_pointer(tu_fifo_t *f, tu_fifo_size_t n);
+void tu_fifo_advance_read_pointer (tu_fifo_t *f, tu_fifo_size_t n);
 
 // If you want to read/write from/to the FIFO by use of a DMA, you may need to conduct two copies
 // to handle a possible wrapping part. These functions deliver a pointer to start
@@ -192,6 +226,15 @@ void tu_fifo_advance_read_pointer (tu_fifo_t *f, uint16_t n);
 void tu_fifo_get_read_info (tu_fifo_t *f, tu_fifo_buffer_info_t *info);
 void tu_fifo_get_write_info(tu_fifo_t *f, tu_fifo_buffer_info_t *info);
 
+// Zero-copy producer/consumer API: reserve up to n contiguous items, fill/parse them in place then
+// commit the number of items actually produced/consumed. A span never wraps, when the region is
+// split at the end of the buffer, commit the first part and reserve again to get the wrapped part.
+// There must be only one producer (writer) and one consumer (reader) between reserve and commit.
+tu_fifo_size_t tu_fifo_write_reserve(tu_fifo_t* f, void** ptr, tu_fifo_size_t n);
+tu_fifo_size_t tu_fifo_write_commit (tu_fifo_t* f, tu_fifo_size_t n);
+tu_fifo_size_t tu_fifo_read_reserve (tu_fifo_t* f, void** ptr, tu_fifo_size_t n);
+tu_fifo_size_t tu_fifo_read_commit  (tu_fifo_t* f, tu_fifo_size_t n);
+
 #ifdef __cplusplus
 }
 #endif
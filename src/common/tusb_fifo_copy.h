@@ -0,0 +1,170 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Ha Thach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * This file is part of the TinyUSB stack.
+ */
+
+#ifndef _TUSB_FIFO_COPY_H_
+#define _TUSB_FIFO_COPY_H_
+
+#include "common/tusb_common.h"
+
+#if defined(__SSE2__)
+  #include <emmintrin.h>
+  #define TU_FIFO_COPY_SIMD_WIDTH   16
+#elif defined(__ARM_NEON)
+  #include <arm_neon.h>
+  #define TU_FIFO_COPY_SIMD_WIDTH   16
+#else
+  #define TU_FIFO_COPY_SIMD_WIDTH   0 // not available, fall back to unrolled word loop
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Copy kernels used by tu_fifo to move data between application buffer and fifo buffer, all of them
+// have memcpy() semantics (no overlap). The one used by fifo is selected with CFG_TUSB_FIFO_COPY.
+// Word kernels only access words when source and destination are equally aligned within a word,
+// which is the case for fifo buffer and most application buffers. Otherwise they fall back to memcpy().
+
+typedef uint32_t TU_ATTR_MAY_ALIAS tu_fifo_word_t;
+
+//--------------------------------------------------------------------+
+// Helper
+//--------------------------------------------------------------------+
+
+// Copy bytes until destination is word aligned, return false if words can't be used
+TU_ATTR_ALWAYS_INLINE static inline
+bool _tu_fifo_copy_head(uint8_t** dst, uint8_t const** src, uint32_t* len) {
+  if ( (((uintptr_t) *dst) ^ ((uintptr_t) *src)) & 3u ) {
+    memcpy(*dst, *src, *len);
+    return false;
+  }
+
+  while ( *len && (((uintptr_t) *dst) & 3u) ) {
+    *(*dst)++ = *(*src)++;
+    (*len)--;
+  }
+
+  return true;
+}
+
+TU_ATTR_ALWAYS_INLINE static inline
+void _tu_fifo_copy_tail(uint8_t* dst, uint8_t const* src, uint32_t len) {
+  while ( len-- ) *dst++ = *src++;
+}
+
+//--------------------------------------------------------------------+
+// Kernels
+//--------------------------------------------------------------------+
+
+TU_ATTR_ALWAYS_INLINE static inline
+void tu_fifo_copy_memcpy(void* dst, void const* src, uint32_t len) {
+  memcpy(dst, src, len);
+}
+
+TU_ATTR_ALWAYS_INLINE static inline
+void tu_fifo_copy_word(void* dst, void const* src, uint32_t len) {
+  uint8_t* d8 = (uint8_t*) dst;
+  uint8_t const* s8 = (uint8_t const*) src;
+  if ( !_tu_fifo_copy_head(&d8, &s8, &len) ) return;
+
+  tu_fifo_word_t* d32 = (tu_fifo_word_t*) (void*) d8;
+  tu_fifo_word_t const* s32 = (tu_fifo_word_t const*) (void const*) s8;
+
+  for ( ; len >= 4; len -= 4 ) *d32++ = *s32++;
+
+  _tu_fifo_copy_tail((uint8_t*) d32, (uint8_t const*) s32, len);
+}
+
+TU_ATTR_ALWAYS_INLINE static inline
+void tu_fifo_copy_unrolled(void* dst, void const* src, uint32_t len) {
+  uint8_t* d8 = (uint8_t*) dst;
+  uint8_t const* s8 = (uint8_t const*) src;
+  if ( !_tu_fifo_copy_head(&d8, &s8, &len) ) return;
+
+  tu_fifo_word_t* d32 = (tu_fifo_word_t*) (void*) d8;
+  tu_fifo_word_t const* s32 = (tu_fifo_word_t const*) (void const*) s8;
+
+  // load all 4 words before storing, allow compiler to use ldm/stm
+  for ( ; len >= 16; len -= 16 ) {
+    uint32_t const w0 = s32[0];
+    uint32_t const w1 = s32[1];
+    uint32_t const w2 = s32[2];
+    uint32_t const w3 = s32[3];
+    d32[0] = w0;
+    d32[1] = w1;
+    d32[2] = w2;
+    d32[3] = w3;
+    d32 += 4;
+    s32 += 4;
+  }
+
+  for ( ; len >= 4; len -= 4 ) *d32++ = *s32++;
+
+  _tu_fifo_copy_tail((uint8_t*) d32, (uint8_t const*) s32, len);
+}
+
+TU_ATTR_ALWAYS_INLINE static inline
+void tu_fifo_copy_simd(void* dst, void const* src, uint32_t len) {
+#if TU_FIFO_COPY_SIMD_WIDTH
+  // vector load/store has no alignment requirement
+  uint8_t* d8 = (uint8_t*) dst;
+  uint8_t const* s8 = (uint8_t const*) src;
+
+  for ( ; len >= 16; len -= 16 ) {
+  #if defined(__SSE2__)
+    _mm_storeu_si128((__m128i*) (void*) d8, _mm_loadu_si128((__m128i const*) (void const*) s8));
+  #else
+    vst1q_u8(d8, vld1q_u8(s8));
+  #endif
+    d8 += 16;
+    s8 += 16;
+  }
+
+  tu_fifo_copy_word(d8, s8, len);
+#else
+  tu_fifo_copy_unrolled(dst, src, len);
+#endif
+}
+
+// Kernel used by tu_fifo
+TU_ATTR_ALWAYS_INLINE static inline
+void tu_fifo_copy(void* dst, void const* src, uint32_t len) {
+#if CFG_TUSB_FIFO_COPY == OPT_FIFO_COPY_WORD
+  tu_fifo_copy_word(dst, src, len);
+#elif CFG_TUSB_FIFO_COPY == OPT_FIFO_COPY_UNROLLED
+  tu_fifo_copy_unrolled(dst, src, len);
+#elif CFG_TUSB_FIFO_COPY == OPT_FIFO_COPY_SIMD
+  tu_fifo_copy_simd(dst, src, len);
+#else
+  tu_fifo_copy_memcpy(dst, src, len);
+#endif
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
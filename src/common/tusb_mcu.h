@@ -483,6 +483,14 @@
   #define TUP_RHPORT_HIGHSPEED    1
   #define TUD_ENDPOINT_ONE_DIRECTION_ONLY
 
+//--------------------------------------------------------------------+
+// Software loopback: device and host port wired together in-process
+//--------------------------------------------------------------------+
+#elif TU_CHECK_MCU(OPT_MCU_SIM)
+  #define TUP_USBIP_SIM
+  #define TUP_DCD_ENDPOINT_MAX    16
+  #define TUP_RHPORT_HIGHSPEED    1
+
 #endif
 
 //--------------------------------------------------------------------+
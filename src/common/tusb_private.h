@@ -75,13 +75,65 @@ bool tu_edpt_claim(tu_edpt_state_t* ep_state, osal_mutex_t mutex);
 // Release an endpoint with provided mutex
 bool tu_edpt_release(tu_edpt_state_t* ep_state, osal_mutex_t mutex);
 
+//--------------------------------------------------------------------+
+// Latency histogram
+//--------------------------------------------------------------------+
+TU_ATTR_ALWAYS_INLINE static inline void tu_latency_hist_add(tu_latency_hist_t* hist, uint32_t delay) {
+  uint8_t const bin = delay ? tu_min8((uint8_t) (tu_log2(delay) + 1), TU_LATENCY_BINS - 1) : 0;
+  hist->count[bin]++;
+  if (delay > hist->max) hist->max = delay;
+}
+
+//--------------------------------------------------------------------+
+// Deferred function call queue
+//--------------------------------------------------------------------+
+
+typedef struct {
+  osal_task_func_t func;
+  void* param;
+} tu_defer_call_t;
+
+// Calls pending from usbd/usbh_defer_func(). A single wake-up event is queued to the task when the first call is
+// pushed, task then runs all pending calls in one pass. Not thread-safe: caller must have exclusive access.
+typedef struct {
+  tu_defer_call_t* calls;
+  uint8_t depth;
+  uint8_t rd_idx;
+  uint8_t count;
+  bool armed; // wake-up event is queued and not yet drained
+} tu_defer_queue_t;
+
+#define TU_DEFER_QUEUE_DEF(_name, _depth)                  \
+  static tu_defer_call_t _name##_calls[_depth];            \
+  static tu_defer_queue_t _name = { .calls = _name##_calls, .depth = _depth }
+
+// Push a call, a duplicate of one still pending is coalesced. Return false if queue is full.
+// wake is set if caller must queue the wake-up event
+bool tu_defer_push(tu_defer_queue_t* dq, osal_task_func_t func, void* param, bool* wake);
+
+// Pop oldest pending call
+bool tu_defer_pop(tu_defer_queue_t* dq, tu_defer_call_t* call);
+
+// Start draining on wake-up event: calls pushed from now on queue a new wake-up event.
+// Return number of calls to run in this pass
+TU_ATTR_ALWAYS_INLINE static inline uint8_t tu_defer_drain_begin(tu_defer_queue_t* dq) {
+  dq->armed = false;
+  return dq->count;
+}
+
+TU_ATTR_ALWAYS_INLINE static inline void tu_defer_clear(tu_defer_queue_t* dq) {
+  dq->rd_idx = 0;
+  dq->count = 0;
+  dq->armed = false;
+}
+
 //--------------------------------------------------------------------+
 // Endpoint Stream
 //--------------------------------------------------------------------+
 
 // Init an endpoint stream
 bool tu_edpt_stream_init(tu_edpt_stream_t* s, bool is_host, bool is_tx, bool overwritable,
-                         void* ff_buf, uint16_t ff_bufsize, uint8_t* ep_buf, uint16_t ep_bufsize);
+                         void* ff_buf, tu_fifo_size_t ff_bufsize, uint8_t* ep_buf, uint16_t ep_bufsize);
 
 // Deinit an endpoint stream
 bool tu_edpt_stream_deinit(tu_edpt_stream_t* s);
@@ -537,6 +537,31 @@ uint8_t const * tu_desc_find2(uint8_t const* desc, uint8_t const* end, uint8_t b
 // find descriptor that match byte1 (type) and byte2
 uint8_t const * tu_desc_find3(uint8_t const* desc, uint8_t const* end, uint8_t byte1, uint8_t byte2, uint8_t byte3);
 
+//--------------------------------------------------------------------+
+// Stats counters shared by tud_stats_t and tuh_stats_t
+//--------------------------------------------------------------------+
+typedef struct {
+  uint32_t xfers;  // completed transfers
+  uint32_t bytes;  // transferred bytes
+  uint32_t errors; // transfers completed with other result than success
+  uint32_t stalls; // device: stalled by device stack, host: stall received
+} tu_stats_edpt_t;
+
+typedef struct {
+  uint32_t calls;     // transfer complete callbacks
+  uint32_t time;      // total time spent in callback, in unit of tusb_timestamp_cb()
+  uint32_t time_max;  // longest callback
+  uint32_t isr_calls; // device: completions handled by xfer_isr(), not timed and not counted in calls
+} tu_stats_driver_t;
+
+// Log2 histogram: bin 0 counts zero delay, bin n counts delay in [2^(n-1), 2^n), last bin counts anything longer
+#define TU_LATENCY_BINS  32
+
+typedef struct {
+  uint32_t count[TU_LATENCY_BINS];
+  uint32_t max;
+} tu_latency_hist_t;
+
 #ifdef __cplusplus
  }
 #endif
@@ -74,6 +74,8 @@ typedef struct TU_ATTR_ALIGNED(4) {
     struct {
       uint8_t  ep_addr;
       uint8_t  result;
+      uint8_t  bus_gen;      // set by usbd
+      uint8_t  next_started; // set by usbd: next queued transfer is already started
       uint32_t len;
     }xfer_complete;
 
@@ -83,6 +85,10 @@ typedef struct TU_ATTR_ALIGNED(4) {
       void* param;
     }func_call;
   };
+
+#if CFG_TUD_EVENT_LATENCY
+  uint32_t timestamp; // set by usbd when queued
+#endif
 } dcd_event_t;
 
 //TU_VERIFY_STATIC(sizeof(dcd_event_t) <= 12, "size is not correct");
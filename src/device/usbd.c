@@ -42,6 +42,34 @@
   #define CFG_TUD_TASK_QUEUE_SZ   16
 #endif
 
+// Queue bus, SETUP and control endpoint events separately from data endpoint events. Control queue is
+// always drained first so that SETUP is not delayed by a backlog of bulk transfer complete events.
+#ifndef CFG_TUD_TASK_CTRL_QUEUE
+  #define CFG_TUD_TASK_CTRL_QUEUE    0
+#endif
+
+#ifndef CFG_TUD_TASK_CTRL_QUEUE_SZ
+  #define CFG_TUD_TASK_CTRL_QUEUE_SZ 8
+#endif
+
+// Number of transfers per endpoint that usbd_edpt_xfer_queue() can hold while endpoint is busy. Next one is
+// handed to controller as soon as current transfer completes. 0 to disable
+#ifndef CFG_TUD_EDPT_XFER_QUEUE
+  #define CFG_TUD_EDPT_XFER_QUEUE    0
+#endif
+
+// Number of usbd_defer_func() calls that can be pending. A call with same function and parameter as a pending one is
+// coalesced, task runs all pending calls in one pass per wake-up event. 0 to queue each call as its own event
+#ifndef CFG_TUD_DEFER_QUEUE_SZ
+  #define CFG_TUD_DEFER_QUEUE_SZ     0
+#endif
+
+// Remember which driver opened each interface of the last SET_CONFIGURATION. Re-configuring with the same
+// descriptor opens those drivers directly instead of probing every driver for every interface.
+#ifndef CFG_TUD_SET_CONFIG_CACHE
+  #define CFG_TUD_SET_CONFIG_CACHE   0
+#endif
+
 //--------------------------------------------------------------------+
 // Weak stubs: invoked if no strong implementation is available
 //--------------------------------------------------------------------+
@@ -108,6 +136,19 @@ TU_ATTR_WEAK void dcd_disconnect(uint8_t rhport) {
 // Invalid driver ID in itf2drv[] ep2drv[][] mapping
 enum { DRVID_INVALID = 0xFFu };
 
+#if CFG_TUD_EDPT_XFER_QUEUE
+// Transfers waiting for a busy endpoint
+typedef struct {
+  struct {
+    uint8_t* buffer;
+    uint16_t total_bytes;
+  } xfer[CFG_TUD_EDPT_XFER_QUEUE];
+
+  uint8_t rd_idx;
+  volatile uint8_t count;
+} usbd_xfer_queue_t;
+#endif
+
 typedef struct {
   struct TU_ATTR_PACKED {
     volatile uint8_t connected    : 1;
@@ -127,11 +168,60 @@ typedef struct {
 
   tu_edpt_state_t ep_status[CFG_TUD_ENDPPOINT_MAX][2];
 
+#if CFG_TUD_EDPT_XFER_QUEUE
+  usbd_xfer_queue_t xfer_queue[CFG_TUD_ENDPPOINT_MAX][2];
+#endif
+
 }usbd_device_t;
 
 tu_static usbd_device_t _usbd_dev;
 static volatile uint8_t _usbd_queued_setup;
 
+// Set while driver's xfer_isr() runs, endpoint API called from it must not log since printf is not ISR safe
+static bool _usbd_xfer_isr_active;
+#define TU_LOG_USBD_EDPT(...)  do { if (!_usbd_xfer_isr_active) { TU_LOG_USBD(__VA_ARGS__); } } while (0)
+
+#if CFG_TUD_STATS
+tu_static tud_stats_t _usbd_stats;
+
+CFG_TUD_MEM_SECTION CFG_TUSB_MEM_ALIGN
+tu_static tud_stats_t _usbd_stats_snapshot;
+
+// Event queue depth is posted - received, each counter is written by one side only: events are posted from ISR and
+// task context (e.g usbd_defer_func()), received by task. Index 1 is control queue
+tu_static volatile uint16_t _usbd_stats_posted_isr[2];
+tu_static volatile uint16_t _usbd_stats_posted_task[2];
+tu_static volatile uint16_t _usbd_stats_received[2];
+#endif
+
+#if CFG_TUD_EVENT_LATENCY
+TU_VERIFY_STATIC(TU_ARRAY_SIZE(((tud_event_latency_t*) 0)->event) == DCD_EVENT_COUNT, "event count mismatch");
+tu_static tud_event_latency_t _usbd_latency;
+#endif
+
+#if CFG_TUD_SET_CONFIG_CACHE
+// Driver binding of the last parsed configuration, kept across bus reset and configuration switch.
+// Keyed by descriptor address and length: application must not modify a configuration descriptor in place
+// while keeping its wTotalLength.
+typedef struct {
+  void const* desc_cfg;
+  uint16_t total_len;
+  uint8_t  cfg_num;
+  uint8_t  count; // number of bindings, 0 is invalid
+
+  struct {
+    uint16_t offset; // interface descriptor offset within configuration
+    uint16_t len;    // length returned by driver open()
+    uint8_t  drv_id;
+  } bind[CFG_TUD_INTERFACE_MAX];
+
+  uint8_t itf2drv[CFG_TUD_INTERFACE_MAX];
+  uint8_t ep2drv[CFG_TUD_ENDPPOINT_MAX][2];
+} usbd_config_cache_t;
+
+tu_static usbd_config_cache_t _usbd_cfg_cache;
+#endif
+
 //--------------------------------------------------------------------+
 // Class Driver
 //--------------------------------------------------------------------+
@@ -152,7 +242,11 @@ tu_static usbd_class_driver_t const _usbd_driver[] = {
         .open             = cdcd_open,
         .control_xfer_cb  = cdcd_control_xfer_cb,
         .xfer_cb          = cdcd_xfer_cb,
+      #if CFG_TUD_CDC_TX_FLUSH_MS
+        .sof              = cdcd_sof_isr
+      #else
         .sof              = NULL
+      #endif
     },
     #endif
 
@@ -165,7 +259,7 @@ tu_static usbd_class_driver_t const _usbd_driver[] = {
         .open             = mscd_open,
         .control_xfer_cb  = mscd_control_xfer_cb,
         .xfer_cb          = mscd_xfer_cb,
-        .sof              = NULL
+        .sof              = mscd_sof_isr
     },
     #endif
 
@@ -334,6 +428,35 @@ tu_static uint8_t _usbd_rhport = RHPORT_INVALID;
 OSAL_QUEUE_DEF(usbd_int_set, _usbd_qdef, CFG_TUD_TASK_QUEUE_SZ, dcd_event_t);
 tu_static osal_queue_t _usbd_q;
 
+#if CFG_TUD_TASK_CTRL_QUEUE
+// Control queue for bus, SETUP and EP0 events, their relative order is kept.
+OSAL_QUEUE_DEF(usbd_int_set, _usbd_ctrl_qdef, CFG_TUD_TASK_CTRL_QUEUE_SZ, dcd_event_t);
+tu_static osal_queue_t _usbd_ctrl_q;
+
+// Incremented on bus reset/unplug. Data transfer complete is stamped with it when queued so that
+// one queued before a bus reset (which is processed first) can be dropped.
+static volatile uint8_t _usbd_bus_gen;
+
+// SETUP closing or resetting endpoints is held back until data events queued before it are processed, otherwise
+// their completion would reach a closed or re-opened endpoint. Events queued later are processed after it.
+// Held SETUP is dropped if bus is reset meanwhile.
+static dcd_event_t _usbd_setup_held;
+static bool _usbd_setup_is_held;
+static uint8_t _usbd_setup_bus_gen;
+static uint16_t _usbd_setup_fence; // data events to process before held SETUP
+
+// Data queue pending = posted - received, posted is counted per context so that each counter has one writer
+static volatile uint16_t _usbd_q_posted_isr;
+static volatile uint16_t _usbd_q_posted_task;
+static uint16_t _usbd_q_received;
+
+#if CFG_TUSB_OS != OPT_OS_NONE && CFG_TUSB_OS != OPT_OS_PICO
+// Posted on every event, task waits on it when both queues are empty
+tu_static osal_semaphore_def_t _usbd_sem_def;
+tu_static osal_semaphore_t _usbd_sem;
+#endif
+#endif
+
 // Mutex for claiming endpoint
 #if OSAL_MUTEX_REQUIRED
   tu_static osal_mutex_def_t _ubsd_mutexdef;
@@ -342,18 +465,259 @@ tu_static osal_queue_t _usbd_q;
   #define _usbd_mutex   NULL
 #endif
 
+// Lock out usbd task of other threads and the dcd ISR
+TU_ATTR_ALWAYS_INLINE static inline void usbd_lock(void) {
+  (void) osal_mutex_lock(_usbd_mutex, OSAL_TIMEOUT_WAIT_FOREVER);
+  usbd_int_set(false);
+}
+
+TU_ATTR_ALWAYS_INLINE static inline void usbd_unlock(void) {
+  usbd_int_set(true);
+  (void) osal_mutex_unlock(_usbd_mutex);
+}
+
+#if CFG_TUD_DEFER_QUEUE_SZ
+TU_DEFER_QUEUE_DEF(_usbd_defer_q, CFG_TUD_DEFER_QUEUE_SZ);
+#endif
+
+#if CFG_TUD_TASK_CTRL_QUEUE
+TU_ATTR_ALWAYS_INLINE static inline bool is_ctrl_event(dcd_event_t const * event) {
+  switch (event->event_id) {
+    case DCD_EVENT_SOF:
+    case USBD_EVENT_FUNC_CALL:
+      return false;
+
+    case DCD_EVENT_XFER_COMPLETE:
+      return 0 == tu_edpt_number(event->xfer_complete.ep_addr);
+
+    default:
+      return true;
+  }
+}
+
+// Standard request changing endpoint state
+TU_ATTR_ALWAYS_INLINE static inline bool is_edpt_setup(tusb_control_request_t const * request) {
+  if (request->bmRequestType_bit.type != TUSB_REQ_TYPE_STANDARD) return false;
+
+  switch (request->bRequest) {
+    case TUSB_REQ_SET_CONFIGURATION:
+    case TUSB_REQ_SET_INTERFACE:
+      return true;
+
+    case TUSB_REQ_CLEAR_FEATURE:
+    case TUSB_REQ_SET_FEATURE:
+      return request->bmRequestType_bit.recipient == TUSB_REQ_RCPT_ENDPOINT;
+
+    default:
+      return false;
+  }
+}
+#endif
+
+//--------------------------------------------------------------------+
+// Stats
+//--------------------------------------------------------------------+
+#if CFG_TUD_STATS
+TU_ATTR_ALWAYS_INLINE static inline void stats_queue_posted(uint8_t qid, bool in_isr) {
+  if (in_isr) {
+    _usbd_stats_posted_isr[qid]++;
+  } else {
+    _usbd_stats_posted_task[qid]++;
+  }
+
+  uint16_t const depth = (uint16_t) (_usbd_stats_posted_isr[qid] + _usbd_stats_posted_task[qid] -
+                                     _usbd_stats_received[qid]);
+  uint16_t* peak = qid ? &_usbd_stats.ctrl_queue_peak : &_usbd_stats.queue_peak;
+  if (depth > *peak) *peak = depth;
+}
+
+TU_ATTR_ALWAYS_INLINE static inline void stats_queue_received(uint8_t qid) {
+  _usbd_stats_received[qid]++;
+}
+
+// Count event reported by DCD, before it is filtered or handled in ISR
+static void stats_dcd_event(dcd_event_t const* event) {
+  switch (event->event_id) {
+    case DCD_EVENT_BUS_RESET:      _usbd_stats.bus_reset++; break;
+    case DCD_EVENT_SUSPEND:        _usbd_stats.suspend++;   break;
+    case DCD_EVENT_RESUME:         _usbd_stats.resume++;    break;
+    case DCD_EVENT_SETUP_RECEIVED: _usbd_stats.setup++;     break;
+
+    case DCD_EVENT_XFER_COMPLETE: {
+      uint8_t const ep_addr = event->xfer_complete.ep_addr;
+      tu_stats_edpt_t* st = &_usbd_stats.edpt[tu_edpt_number(ep_addr)][tu_edpt_dir(ep_addr)];
+      st->xfers++;
+      st->bytes += event->xfer_complete.len;
+      if (event->xfer_complete.result != XFER_RESULT_SUCCESS) st->errors++;
+      break;
+    }
+
+    default: break;
+  }
+}
+
+static void stats_driver_done(uint8_t drv_id, uint32_t start) {
+  if (drv_id >= CFG_TUD_STATS_DRIVER_MAX) return;
+
+  uint32_t const elapsed = tusb_timestamp_cb() - start;
+  tu_stats_driver_t* st = &_usbd_stats.driver[drv_id];
+  st->calls++;
+  st->time += elapsed;
+  if (elapsed > st->time_max) st->time_max = elapsed;
+}
+
+// Completion handled by driver's xfer_isr(), ISR only
+TU_ATTR_ALWAYS_INLINE static inline void stats_driver_isr(uint8_t drv_id) {
+  if (drv_id < CFG_TUD_STATS_DRIVER_MAX) _usbd_stats.driver[drv_id].isr_calls++;
+}
+
+void usbd_stats_edpt_stall(uint8_t ep_addr) {
+  _usbd_stats.edpt[tu_edpt_number(ep_addr)][tu_edpt_dir(ep_addr)].stalls++;
+}
+
+  #define stats_time()  tusb_timestamp_cb()
+#else
+  #define stats_queue_posted(_qid, _in_isr)
+  #define stats_driver_isr(_drv_id)
+  #define stats_queue_received(_qid)
+  #define stats_dcd_event(_event)
+  #define stats_driver_done(_drv_id, _start)  (void) (_start)
+  #define stats_time()  0
+#endif
+
+#if CFG_TUD_EVENT_LATENCY
+// Event is dispatched by task, fold its queuing delay into histogram of its type
+TU_ATTR_ALWAYS_INLINE static inline void latency_event_dispatched(dcd_event_t const* event) {
+  if (event->event_id < DCD_EVENT_COUNT) {
+    tu_latency_hist_add(&_usbd_latency.event[event->event_id], tusb_timestamp_cb() - event->timestamp);
+  }
+}
+#else
+  #define latency_event_dispatched(_event)
+#endif
+
 TU_ATTR_ALWAYS_INLINE static inline bool queue_event(dcd_event_t const * event, bool in_isr) {
+#if CFG_TUD_EVENT_LATENCY
+  dcd_event_t evt = *event;
+  evt.timestamp = tusb_timestamp_cb();
+  event = &evt;
+#endif
+
+#if CFG_TUD_TASK_CTRL_QUEUE
+  bool const ctrl = is_ctrl_event(event);
+  TU_ASSERT(osal_queue_send(ctrl ? _usbd_ctrl_q : _usbd_q, event, in_isr));
+  if (!ctrl) {
+    if (in_isr) {
+      _usbd_q_posted_isr++;
+    } else {
+      _usbd_q_posted_task++;
+    }
+  }
+  stats_queue_posted(ctrl ? 1 : 0, in_isr);
+  #if CFG_TUSB_OS != OPT_OS_NONE && CFG_TUSB_OS != OPT_OS_PICO
+  osal_semaphore_post(_usbd_sem, in_isr);
+  #endif
+#else
   TU_ASSERT(osal_queue_send(_usbd_q, event, in_isr));
+  stats_queue_posted(0, in_isr);
+#endif
   tud_event_hook_cb(event->rhport, event->event_id, in_isr);
   return true;
 }
 
+TU_ATTR_ALWAYS_INLINE static inline bool queue_empty(void) {
+#if CFG_TUD_TASK_CTRL_QUEUE
+  return osal_queue_empty(_usbd_ctrl_q) && osal_queue_empty(_usbd_q);
+#else
+  return osal_queue_empty(_usbd_q);
+#endif
+}
+
+#if CFG_TUD_TASK_CTRL_QUEUE
+TU_ATTR_ALWAYS_INLINE static inline bool data_queue_receive(dcd_event_t* event) {
+  TU_VERIFY(osal_queue_receive(_usbd_q, event, 0));
+  _usbd_q_received++;
+  stats_queue_received(0);
+  return true;
+}
+#endif
+
+// Get next event, control queue first
+static bool queue_receive(dcd_event_t* event, uint32_t timeout_ms) {
+#if CFG_TUD_TASK_CTRL_QUEUE
+  // Queues are only read when not empty since osal_queue_receive() of some RTOS always blocks.
+  // This task is the only consumer, a queue can't become empty in between.
+  while (1) {
+    if (_usbd_setup_is_held) {
+      if (_usbd_setup_fence && !osal_queue_empty(_usbd_q)) {
+        TU_VERIFY(data_queue_receive(event));
+        _usbd_setup_fence--;
+        return true;
+      }
+
+      _usbd_setup_is_held = false;
+      if (_usbd_setup_bus_gen == _usbd_bus_gen) {
+        *event = _usbd_setup_held;
+        return true;
+      }
+    }
+
+    if (!osal_queue_empty(_usbd_ctrl_q)) {
+      TU_VERIFY(osal_queue_receive(_usbd_ctrl_q, event, 0));
+      stats_queue_received(1);
+
+      if (event->event_id == DCD_EVENT_SETUP_RECEIVED && is_edpt_setup(&event->setup_received) &&
+          !osal_queue_empty(_usbd_q)) {
+        _usbd_setup_held = *event;
+        _usbd_setup_is_held = true;
+        _usbd_setup_bus_gen = _usbd_bus_gen;
+        // only events already queued, ones posted from now on are processed after the SETUP
+        _usbd_setup_fence = (uint16_t) (_usbd_q_posted_isr + _usbd_q_posted_task - _usbd_q_received);
+        continue;
+      }
+
+      return true;
+    }
+
+    if (!osal_queue_empty(_usbd_q)) {
+      return data_queue_receive(event);
+    }
+
+  #if CFG_TUSB_OS != OPT_OS_NONE && CFG_TUSB_OS != OPT_OS_PICO
+    if (!osal_semaphore_wait(_usbd_sem, timeout_ms)) return false;
+  #elif CFG_TUSB_OS == OPT_OS_NONE && CFG_TUSB_OS_NONE_WAIT
+    // wait once, then check both queues again without waiting
+    if (timeout_ms == 0) return false;
+    osal_none_wait_for_event(timeout_ms);
+    timeout_ms = 0;
+  #else
+    (void) timeout_ms;
+    return false;
+  #endif
+  }
+#else
+  TU_VERIFY(osal_queue_receive(_usbd_q, event, timeout_ms));
+  stats_queue_received(0);
+  return true;
+#endif
+}
+
 //--------------------------------------------------------------------+
 // Prototypes
 //--------------------------------------------------------------------+
 static bool process_control_request(uint8_t rhport, tusb_control_request_t const * p_request);
 static bool process_set_config(uint8_t rhport, uint8_t cfg_num);
 static bool process_get_descriptor(uint8_t rhport, tusb_control_request_t const * p_request);
+static void edpt_xfer_done(uint8_t rhport, uint8_t ep_addr, bool next_started);
+
+#if CFG_TUD_DEFER_QUEUE_SZ
+static void defer_queue_drain(void);
+#endif
+
+#if CFG_TUD_EDPT_XFER_QUEUE
+static bool xfer_queue_pop(uint8_t epnum, uint8_t dir, uint8_t** buffer, uint16_t* total_bytes);
+static bool edpt_xfer_start(uint8_t rhport, uint8_t ep_addr, uint8_t* buffer, uint16_t total_bytes);
+#endif
 
 #if CFG_TUD_TEST_MODE
 static bool process_test_mode_cb(uint8_t rhport, uint8_t stage, tusb_control_request_t const * request) {
@@ -441,6 +805,34 @@ void tud_sof_cb_enable(bool en) {
   usbd_sof_enable(_usbd_rhport, SOF_CONSUMER_USER, en);
 }
 
+#if CFG_TUD_STATS
+bool tud_stats_get(tud_stats_t* stats) {
+  TU_VERIFY(stats);
+  *stats = _usbd_stats;
+  return true;
+}
+
+bool tud_stats_control_xfer(uint8_t rhport, tusb_control_request_t const * request) {
+  TU_VERIFY(request->bmRequestType_bit.direction == TUSB_DIR_IN);
+
+  // data stage may take several packets, send a consistent copy
+  _usbd_stats_snapshot = _usbd_stats;
+  return tud_control_xfer(rhport, request, &_usbd_stats_snapshot, sizeof(tud_stats_t));
+}
+#endif
+
+#if CFG_TUD_EVENT_LATENCY
+bool tud_event_latency_get(tud_event_latency_t* latency) {
+  TU_VERIFY(latency);
+  *latency = _usbd_latency;
+  return true;
+}
+
+void tud_event_latency_clear(void) {
+  tu_varclr(&_usbd_latency);
+}
+#endif
+
 //--------------------------------------------------------------------+
 // USBD Task
 //--------------------------------------------------------------------+
@@ -461,6 +853,26 @@ bool tud_init(uint8_t rhport) {
   tu_varclr(&_usbd_dev);
   _usbd_queued_setup = 0;
 
+#if CFG_TUD_SET_CONFIG_CACHE
+  // driver list may differ from previous init
+  tu_varclr(&_usbd_cfg_cache);
+#endif
+
+#if CFG_TUD_STATS
+  tu_varclr(&_usbd_stats);
+  _usbd_stats_posted_isr[0] = _usbd_stats_posted_isr[1] = 0;
+  _usbd_stats_posted_task[0] = _usbd_stats_posted_task[1] = 0;
+  _usbd_stats_received[0] = _usbd_stats_received[1] = 0;
+#endif
+
+#if CFG_TUD_EVENT_LATENCY
+  tu_varclr(&_usbd_latency);
+#endif
+
+#if CFG_TUD_DEFER_QUEUE_SZ
+  tu_defer_clear(&_usbd_defer_q);
+#endif
+
 #if OSAL_MUTEX_REQUIRED
   // Init device mutex
   _usbd_mutex = osal_mutex_create(&_ubsd_mutexdef);
@@ -471,6 +883,18 @@ bool tud_init(uint8_t rhport) {
   _usbd_q = osal_queue_create(&_usbd_qdef);
   TU_ASSERT(_usbd_q);
 
+#if CFG_TUD_TASK_CTRL_QUEUE
+  _usbd_ctrl_q = osal_queue_create(&_usbd_ctrl_qdef);
+  TU_ASSERT(_usbd_ctrl_q);
+  _usbd_setup_is_held = false;
+  _usbd_q_posted_isr = _usbd_q_posted_task = _usbd_q_received = 0;
+
+  #if CFG_TUSB_OS != OPT_OS_NONE && CFG_TUSB_OS != OPT_OS_PICO
+  _usbd_sem = osal_semaphore_create(&_usbd_sem_def);
+  TU_ASSERT(_usbd_sem);
+  #endif
+#endif
+
   // Get application driver if available
   if (usbd_app_driver_get_cb) {
     _app_driver = usbd_app_driver_get_cb(&_app_driver_count);
@@ -517,6 +941,16 @@ bool tud_deinit(uint8_t rhport) {
   osal_queue_delete(_usbd_q);
   _usbd_q = NULL;
 
+#if CFG_TUD_TASK_CTRL_QUEUE
+  osal_queue_delete(_usbd_ctrl_q);
+  _usbd_ctrl_q = NULL;
+
+  #if CFG_TUSB_OS != OPT_OS_NONE && CFG_TUSB_OS != OPT_OS_PICO
+  osal_semaphore_delete(_usbd_sem);
+  _usbd_sem = NULL;
+  #endif
+#endif
+
 #if OSAL_MUTEX_REQUIRED
   // TODO make sure there is no task waiting on this mutex
   osal_mutex_delete(_usbd_mutex);
@@ -548,7 +982,7 @@ static void usbd_reset(uint8_t rhport) {
 bool tud_task_event_ready(void) {
   // Skip if stack is not initialized
   if (!tud_inited()) return false;
-  return !osal_queue_empty(_usbd_q);
+  return !queue_empty();
 }
 
 /* USB Device Driver task
@@ -574,7 +1008,9 @@ void tud_task_ext(uint32_t timeout_ms, bool in_isr) {
   // Loop until there is no more events in the queue
   while (1) {
     dcd_event_t event;
-    if (!osal_queue_receive(_usbd_q, &event, timeout_ms)) return;
+    if (!queue_receive(&event, timeout_ms)) return;
+    timeout_ms = 0; // only wait for the first event, then drain the queue
+    latency_event_dispatched(&event);
 
 #if CFG_TUSB_DEBUG >= CFG_TUD_LOG_LEVEL
     if (event.event_id == DCD_EVENT_SETUP_RECEIVED) TU_LOG_USBD("\r\n"); // extra line for setup
@@ -584,12 +1020,14 @@ void tud_task_ext(uint32_t timeout_ms, bool in_isr) {
     switch (event.event_id) {
       case DCD_EVENT_BUS_RESET:
         TU_LOG_USBD(": %s Speed\r\n", tu_str_speed[event.bus_reset.speed]);
+        TU_TRACE(TU_TRACE_USBD_EVENT, DCD_EVENT_BUS_RESET, event.bus_reset.speed, 0, 0);
         usbd_reset(event.rhport);
         _usbd_dev.speed = event.bus_reset.speed;
         break;
 
       case DCD_EVENT_UNPLUGGED:
         TU_LOG_USBD("\r\n");
+        TU_TRACE(TU_TRACE_USBD_EVENT, DCD_EVENT_UNPLUGGED, 0, 0, 0);
         usbd_reset(event.rhport);
         tud_umount_cb();
         break;
@@ -598,6 +1036,8 @@ void tud_task_ext(uint32_t timeout_ms, bool in_isr) {
         TU_ASSERT(_usbd_queued_setup > 0,);
         _usbd_queued_setup--;
         TU_LOG_BUF(CFG_TUD_LOG_LEVEL, &event.setup_received, 8);
+        TU_TRACE(TU_TRACE_USBD_SETUP, _usbd_queued_setup != 0, 0, tu_unaligned_read32(&event.setup_received),
+                 tu_unaligned_read32(((uint8_t const*) &event.setup_received) + 4));
         if (_usbd_queued_setup) {
           TU_LOG_USBD("  Skipped since there is other SETUP in queue\r\n");
           break;
@@ -616,9 +1056,12 @@ void tud_task_ext(uint32_t timeout_ms, bool in_isr) {
         // Process control request
         if (!process_control_request(event.rhport, &event.setup_received)) {
           TU_LOG_USBD("  Stall EP0\r\n");
+          TU_TRACE(TU_TRACE_USBD_STALL, 0, 2, 0, 0);
           // Failed -> stall both control endpoint IN and OUT
           dcd_edpt_stall(event.rhport, 0);
           dcd_edpt_stall(event.rhport, 0 | TUSB_DIR_IN_MASK);
+          usbd_stats_edpt_stall(0);
+          usbd_stats_edpt_stall(0 | TUSB_DIR_IN_MASK);
         }
         break;
 
@@ -630,18 +1073,31 @@ void tud_task_ext(uint32_t timeout_ms, bool in_isr) {
 
         TU_LOG_USBD("on EP %02X with %u bytes\r\n", ep_addr, (unsigned int) event.xfer_complete.len);
 
-        _usbd_dev.ep_status[epnum][ep_dir].busy = 0;
-        _usbd_dev.ep_status[epnum][ep_dir].claimed = 0;
+#if CFG_TUD_TASK_CTRL_QUEUE
+        // bus reset/unplug already processed ahead of this transfer, endpoint is closed
+        if (epnum && event.xfer_complete.bus_gen != _usbd_bus_gen) {
+          TU_LOG_USBD("  Skipped since queued before bus reset\r\n");
+          TU_TRACE(TU_TRACE_USBD_XFER, ep_addr, 0xFF, event.xfer_complete.len, 1);
+          break;
+        }
+#endif
+
+        edpt_xfer_done(event.rhport, ep_addr, event.xfer_complete.next_started);
 
         if (0 == epnum) {
+          TU_TRACE(TU_TRACE_USBD_XFER, ep_addr, 0xFF, event.xfer_complete.len, 0);
           usbd_control_xfer_cb(event.rhport, ep_addr, (xfer_result_t) event.xfer_complete.result,
                                event.xfer_complete.len);
         } else {
-          usbd_class_driver_t const* driver = get_driver(_usbd_dev.ep2drv[epnum][ep_dir]);
+          uint8_t const drv_id = _usbd_dev.ep2drv[epnum][ep_dir];
+          TU_TRACE(TU_TRACE_USBD_XFER, ep_addr, drv_id, event.xfer_complete.len, 0);
+          usbd_class_driver_t const* driver = get_driver(drv_id);
           TU_ASSERT(driver,);
 
           TU_LOG_USBD("  %s xfer callback\r\n", driver->name);
+          uint32_t const start = stats_time();
           driver->xfer_cb(event.rhport, ep_addr, (xfer_result_t) event.xfer_complete.result, event.xfer_complete.len);
+          stats_driver_done(drv_id, start);
         }
         break;
       }
@@ -652,29 +1108,42 @@ void tud_task_ext(uint32_t timeout_ms, bool in_isr) {
         // e.g suspend -> resume -> unplug/plug. Skip suspend/resume if not connected
         if (_usbd_dev.connected) {
           TU_LOG_USBD(": Remote Wakeup = %u\r\n", _usbd_dev.remote_wakeup_en);
+          TU_TRACE(TU_TRACE_USBD_EVENT, DCD_EVENT_SUSPEND, _usbd_dev.remote_wakeup_en, 0, 0);
           tud_suspend_cb(_usbd_dev.remote_wakeup_en);
         } else {
           TU_LOG_USBD(" Skipped\r\n");
+          TU_TRACE(TU_TRACE_USBD_EVENT, DCD_EVENT_SUSPEND, 0, 0, 1);
         }
         break;
 
       case DCD_EVENT_RESUME:
         if (_usbd_dev.connected) {
           TU_LOG_USBD("\r\n");
+          TU_TRACE(TU_TRACE_USBD_EVENT, DCD_EVENT_RESUME, 0, 0, 0);
           tud_resume_cb();
         } else {
           TU_LOG_USBD(" Skipped\r\n");
+          TU_TRACE(TU_TRACE_USBD_EVENT, DCD_EVENT_RESUME, 0, 0, 1);
         }
         break;
 
       case USBD_EVENT_FUNC_CALL:
         TU_LOG_USBD("\r\n");
-        if (event.func_call.func) event.func_call.func(event.func_call.param);
+        TU_TRACE(TU_TRACE_USBD_EVENT, USBD_EVENT_FUNC_CALL, 0, 0, 0);
+        if (event.func_call.func) {
+          event.func_call.func(event.func_call.param);
+        }
+#if CFG_TUD_DEFER_QUEUE_SZ
+        else {
+          defer_queue_drain();
+        }
+#endif
         break;
 
       case DCD_EVENT_SOF:
         if (tu_bit_test(_usbd_dev.sof_consumer, SOF_CONSUMER_USER)) {
           TU_LOG_USBD("\r\n");
+          TU_TRACE(TU_TRACE_USBD_EVENT, DCD_EVENT_SOF, 0, 0, 0);
           tud_sof_cb(event.sof.frame_count);
         }
       break;
@@ -686,7 +1155,7 @@ void tud_task_ext(uint32_t timeout_ms, bool in_isr) {
 
 #if CFG_TUSB_OS != OPT_OS_NONE && CFG_TUSB_OS != OPT_OS_PICO
     // return if there is no more events, for application to run other background
-    if (osal_queue_empty(_usbd_q)) return;
+    if (queue_empty()) return;
 #endif
   }
 }
@@ -958,6 +1427,55 @@ static bool process_control_request(uint8_t rhport, tusb_control_request_t const
   return true;
 }
 
+#if CFG_TUD_SET_CONFIG_CACHE
+// Undo a partially opened configuration: close drivers and endpoints, keep device state
+static void config_cache_unbind(uint8_t rhport) {
+  for (uint8_t i = 0; i < TOTAL_DRIVER_COUNT; i++) {
+    usbd_class_driver_t const* driver = get_driver(i);
+    TU_ASSERT(driver,);
+    driver->reset(rhport);
+  }
+
+  dcd_edpt_close_all(rhport);
+
+  memset(_usbd_dev.itf2drv, DRVID_INVALID, sizeof(_usbd_dev.itf2drv));
+  memset(_usbd_dev.ep2drv, DRVID_INVALID, sizeof(_usbd_dev.ep2drv));
+  tu_varclr(&_usbd_dev.ep_status);
+#if CFG_TUD_EDPT_XFER_QUEUE
+  tu_varclr(&_usbd_dev.xfer_queue);
+#endif
+}
+
+// Open drivers recorded by the last full parse of this configuration. Return false if there is no matching
+// record or a driver does not accept its interface as before, in which case nothing is left opened.
+static bool config_cache_replay(uint8_t rhport, uint8_t cfg_num, tusb_desc_configuration_t const* desc_cfg) {
+  usbd_config_cache_t* cache = &_usbd_cfg_cache;
+  uint16_t const total_len = tu_le16toh(desc_cfg->wTotalLength);
+
+  TU_VERIFY(cache->count && cache->cfg_num == cfg_num && cache->desc_cfg == desc_cfg && cache->total_len == total_len);
+
+  for (uint8_t i = 0; i < cache->count; i++) {
+    uint8_t const* p_desc = ((uint8_t const*) desc_cfg) + cache->bind[i].offset;
+    usbd_class_driver_t const* driver = get_driver(cache->bind[i].drv_id);
+
+    if (!driver || TUSB_DESC_INTERFACE != tu_desc_type(p_desc) ||
+        cache->bind[i].len != driver->open(rhport, (tusb_desc_interface_t const*) p_desc,
+                                           (uint16_t) (total_len - cache->bind[i].offset))) {
+      TU_LOG_USBD("  Configuration cache mismatch, full parse\r\n");
+      cache->count = 0;
+      config_cache_unbind(rhport);
+      return false;
+    }
+  }
+
+  memcpy(_usbd_dev.itf2drv, cache->itf2drv, sizeof(_usbd_dev.itf2drv));
+  memcpy(_usbd_dev.ep2drv, cache->ep2drv, sizeof(_usbd_dev.ep2drv));
+
+  TU_LOG_USBD("  Configuration %u opened from cache\r\n", cfg_num);
+  return true;
+}
+#endif
+
 // Process Set Configure Request
 // This function parse configuration descriptor & open drivers accordingly
 static bool process_set_config(uint8_t rhport, uint8_t cfg_num)
@@ -970,6 +1488,16 @@ static bool process_set_config(uint8_t rhport, uint8_t cfg_num)
   _usbd_dev.remote_wakeup_support = (desc_cfg->bmAttributes & TUSB_DESC_CONFIG_ATT_REMOTE_WAKEUP) ? 1u : 0u;
   _usbd_dev.self_powered          = (desc_cfg->bmAttributes & TUSB_DESC_CONFIG_ATT_SELF_POWERED ) ? 1u : 0u;
 
+#if CFG_TUD_SET_CONFIG_CACHE
+  if (config_cache_replay(rhport, cfg_num, desc_cfg)) return true;
+
+  // record while parsing, only valid once the whole configuration is opened
+  usbd_config_cache_t* cache = &_usbd_cfg_cache;
+  cache->count = 0;
+  uint8_t cache_count = 0;
+  bool cache_full = false;
+#endif
+
   // Parse interface descriptor
   uint8_t const * p_desc   = ((uint8_t const*) desc_cfg) + sizeof(tusb_desc_configuration_t);
   uint8_t const * desc_end = ((uint8_t const*) desc_cfg) + tu_le16toh(desc_cfg->wTotalLength);
@@ -1038,6 +1566,17 @@ static bool process_set_config(uint8_t rhport, uint8_t cfg_num)
         // bind all endpoints to found driver
         tu_edpt_bind_driver(_usbd_dev.ep2drv, desc_itf, drv_len, drv_id);
 
+        #if CFG_TUD_SET_CONFIG_CACHE
+        if (cache_count < CFG_TUD_INTERFACE_MAX) {
+          cache->bind[cache_count].offset = (uint16_t) (p_desc - (uint8_t const*) desc_cfg);
+          cache->bind[cache_count].len    = drv_len;
+          cache->bind[cache_count].drv_id = drv_id;
+          cache_count++;
+        } else {
+          cache_full = true;
+        }
+        #endif
+
         // next Interface
         p_desc += drv_len;
 
@@ -1049,6 +1588,17 @@ static bool process_set_config(uint8_t rhport, uint8_t cfg_num)
     TU_ASSERT(drv_id < TOTAL_DRIVER_COUNT);
   }
 
+#if CFG_TUD_SET_CONFIG_CACHE
+  if (!cache_full) {
+    cache->count     = cache_count;
+    cache->desc_cfg  = desc_cfg;
+    cache->total_len = tu_le16toh(desc_cfg->wTotalLength);
+    cache->cfg_num   = cfg_num;
+    memcpy(cache->itf2drv, _usbd_dev.itf2drv, sizeof(cache->itf2drv));
+    memcpy(cache->ep2drv, _usbd_dev.ep2drv, sizeof(cache->ep2drv));
+  }
+#endif
+
   return true;
 }
 
@@ -1148,14 +1698,77 @@ static bool process_get_descriptor(uint8_t rhport, tusb_control_request_t const
 //--------------------------------------------------------------------+
 TU_ATTR_FAST_FUNC void dcd_event_handler(dcd_event_t const* event, bool in_isr) {
   bool send = false;
+  stats_dcd_event(event);
+
   switch (event->event_id) {
     case DCD_EVENT_UNPLUGGED:
       _usbd_dev.connected = 0;
       _usbd_dev.addressed = 0;
       _usbd_dev.cfg_num = 0;
       _usbd_dev.suspended = 0;
+#if CFG_TUD_TASK_CTRL_QUEUE
+      _usbd_bus_gen++;
+#endif
+      send = true;
+      break;
+
+#if CFG_TUD_TASK_CTRL_QUEUE
+    case DCD_EVENT_BUS_RESET:
+      _usbd_bus_gen++;
       send = true;
       break;
+#endif
+
+    case DCD_EVENT_XFER_COMPLETE: {
+      uint8_t const ep_addr = event->xfer_complete.ep_addr;
+      uint8_t const epnum   = tu_edpt_number(ep_addr);
+      uint8_t const ep_dir  = tu_edpt_dir(ep_addr);
+
+      if (epnum == 0) {
+        send = true;
+        break;
+      }
+
+      // Hand next queued transfer to controller right away, endpoint stays busy
+      bool next_started = false;
+#if CFG_TUD_EDPT_XFER_QUEUE
+      uint8_t* next_buf;
+      uint16_t next_len;
+      if (xfer_queue_pop(epnum, ep_dir, &next_buf, &next_len)) {
+        next_started = edpt_xfer_start(event->rhport, ep_addr, next_buf, next_len);
+      }
+#endif
+
+      // Driver fast path in ISR context
+      uint8_t const drv_id = _usbd_dev.ep2drv[epnum][ep_dir];
+      usbd_class_driver_t const* driver = get_driver(drv_id);
+      if (driver && driver->xfer_isr) {
+        if (!next_started) {
+          _usbd_dev.ep_status[epnum][ep_dir].busy = 0;
+          _usbd_dev.ep_status[epnum][ep_dir].claimed = 0;
+        }
+
+        _usbd_xfer_isr_active = true;
+        bool const handled = driver->xfer_isr(event->rhport, ep_addr, (xfer_result_t) event->xfer_complete.result,
+                                              event->xfer_complete.len);
+        _usbd_xfer_isr_active = false;
+        if (handled) {
+          stats_driver_isr(drv_id);
+          break;
+        }
+
+        // deferred to xfer_cb(), endpoint stays busy until then
+        _usbd_dev.ep_status[epnum][ep_dir].busy = 1;
+      }
+
+      dcd_event_t evt = *event;
+      evt.xfer_complete.next_started = next_started ? 1 : 0;
+#if CFG_TUD_TASK_CTRL_QUEUE
+      evt.xfer_complete.bus_gen = _usbd_bus_gen;
+#endif
+      queue_event(&evt, in_isr);
+      break;
+    }
 
     case DCD_EVENT_SUSPEND:
       // NOTE: When plugging/unplugging device, the D+/D- state are unstable and
@@ -1260,12 +1873,50 @@ void usbd_defer_func(osal_task_func_t func, void* param, bool in_isr) {
       .rhport   = 0,
       .event_id = USBD_EVENT_FUNC_CALL,
   };
+
+#if CFG_TUD_DEFER_QUEUE_SZ
+  bool wake;
+  if (!in_isr) usbd_lock();
+  bool const pushed = tu_defer_push(&_usbd_defer_q, func, param, &wake);
+  if (!in_isr) usbd_unlock();
+
+  if (pushed) {
+    // wake-up event has NULL func, pending calls are run when it is processed
+    if (wake && !queue_event(&event, in_isr)) {
+      if (!in_isr) usbd_lock();
+      _usbd_defer_q.armed = false; // let next call retry
+      if (!in_isr) usbd_unlock();
+    }
+    return;
+  }
+  // defer queue is full: fall back to its own event
+#endif
+
   event.func_call.func  = func;
   event.func_call.param = param;
 
   queue_event(&event, in_isr);
 }
 
+#if CFG_TUD_DEFER_QUEUE_SZ
+// Run calls pending at wake-up, ones pushed meanwhile have queued another wake-up event
+static void defer_queue_drain(void) {
+  usbd_lock();
+  uint8_t n = tu_defer_drain_begin(&_usbd_defer_q);
+  usbd_unlock();
+
+  while (n--) {
+    tu_defer_call_t call;
+    usbd_lock();
+    bool const popped = tu_defer_pop(&_usbd_defer_q, &call);
+    usbd_unlock();
+    if (!popped) break;
+
+    call.func(call.param);
+  }
+}
+#endif
+
 //--------------------------------------------------------------------+
 // USBD Endpoint API
 //--------------------------------------------------------------------+
@@ -1311,9 +1962,10 @@ bool usbd_edpt_xfer(uint8_t rhport, uint8_t ep_addr, uint8_t* buffer, uint16_t t
   // TODO skip ready() check for now since enumeration also use this API
   // TU_VERIFY(tud_ready());
 
-  TU_LOG_USBD("  Queue EP %02X with %u bytes ...\r\n", ep_addr, total_bytes);
+  TU_LOG_USBD_EDPT("  Queue EP %02X with %u bytes ...\r\n", ep_addr, total_bytes);
+  TU_TRACE(TU_TRACE_USBD_QUEUE, ep_addr, 0, total_bytes, TU_TRACE_QUEUE_STARTED);
 #if CFG_TUD_LOG_LEVEL >= 3
-  if(dir == TUSB_DIR_IN) {
+  if(dir == TUSB_DIR_IN && !_usbd_xfer_isr_active) {
     TU_LOG_MEM(CFG_TUD_LOG_LEVEL, buffer, total_bytes, 2);
   }
 #endif
@@ -1331,12 +1983,115 @@ bool usbd_edpt_xfer(uint8_t rhport, uint8_t ep_addr, uint8_t* buffer, uint16_t t
     // DCD error, mark endpoint as ready to allow next transfer
     _usbd_dev.ep_status[epnum][dir].busy = 0;
     _usbd_dev.ep_status[epnum][dir].claimed = 0;
-    TU_LOG_USBD("FAILED\r\n");
+    TU_LOG_USBD_EDPT("FAILED\r\n");
+    TU_TRACE(TU_TRACE_USBD_QUEUE, ep_addr, 0, total_bytes, TU_TRACE_QUEUE_FAILED);
     TU_BREAKPOINT();
     return false;
   }
 }
 
+#if CFG_TUD_EDPT_XFER_QUEUE
+// Remove oldest queued transfer, caller must have exclusive access (ISR or locked)
+static bool xfer_queue_pop(uint8_t epnum, uint8_t dir, uint8_t** buffer, uint16_t* total_bytes) {
+  usbd_xfer_queue_t* xq = &_usbd_dev.xfer_queue[epnum][dir];
+  if (xq->count == 0) return false;
+
+  *buffer      = xq->xfer[xq->rd_idx].buffer;
+  *total_bytes = xq->xfer[xq->rd_idx].total_bytes;
+
+  xq->rd_idx = (uint8_t) ((xq->rd_idx + 1) % CFG_TUD_EDPT_XFER_QUEUE);
+  xq->count--;
+
+  return true;
+}
+
+// Start a dequeued transfer on a busy endpoint. On DCD error, endpoint is released and its queue is dropped
+static bool edpt_xfer_start(uint8_t rhport, uint8_t ep_addr, uint8_t* buffer, uint16_t total_bytes) {
+  uint8_t const epnum = tu_edpt_number(ep_addr);
+  uint8_t const dir = tu_edpt_dir(ep_addr);
+
+  if (dcd_edpt_xfer(rhport, ep_addr, buffer, total_bytes)) return true;
+
+  _usbd_dev.xfer_queue[epnum][dir].count = 0;
+  _usbd_dev.ep_status[epnum][dir].busy = 0;
+  _usbd_dev.ep_status[epnum][dir].claimed = 0;
+  TU_LOG_USBD("  Queued EP %02X FAILED\r\n", ep_addr);
+  TU_TRACE(TU_TRACE_USBD_QUEUE, ep_addr, 0, total_bytes, TU_TRACE_QUEUE_START_FAILED);
+  TU_BREAKPOINT();
+
+  return false;
+}
+
+bool usbd_edpt_xfer_queue(uint8_t rhport, uint8_t ep_addr, uint8_t* buffer, uint16_t total_bytes) {
+  rhport = _usbd_rhport;
+
+  uint8_t const epnum = tu_edpt_number(ep_addr);
+  uint8_t const dir = tu_edpt_dir(ep_addr);
+  usbd_xfer_queue_t* xq = &_usbd_dev.xfer_queue[epnum][dir];
+
+  TU_ASSERT(epnum > 0);
+
+  usbd_lock();
+
+  bool const busy = _usbd_dev.ep_status[epnum][dir].busy;
+  bool const full = (xq->count == CFG_TUD_EDPT_XFER_QUEUE);
+
+  if (!busy) {
+    // idle endpoint: start right away
+    _usbd_dev.ep_status[epnum][dir].busy = 1;
+  } else if (!full) {
+    uint8_t const wr_idx = (uint8_t) ((xq->rd_idx + xq->count) % CFG_TUD_EDPT_XFER_QUEUE);
+    xq->xfer[wr_idx].buffer      = buffer;
+    xq->xfer[wr_idx].total_bytes = total_bytes;
+    xq->count++;
+  }
+
+  usbd_unlock();
+
+  if (busy) {
+    TU_LOG_USBD("  Queue EP %02X with %u bytes (pending %u)\r\n", ep_addr, total_bytes, xq->count);
+    TU_TRACE(TU_TRACE_USBD_QUEUE, ep_addr, xq->count, total_bytes, TU_TRACE_QUEUE_PENDING);
+    return !full;
+  }
+
+  TU_LOG_USBD("  Queue EP %02X with %u bytes ...\r\n", ep_addr, total_bytes);
+  TU_TRACE(TU_TRACE_USBD_QUEUE, ep_addr, 0, total_bytes, TU_TRACE_QUEUE_STARTED);
+  return edpt_xfer_start(rhport, ep_addr, buffer, total_bytes);
+}
+#endif
+
+// Transfer is complete (task context): release endpoint unless next queued transfer takes over
+static void edpt_xfer_done(uint8_t rhport, uint8_t ep_addr, bool next_started) {
+  uint8_t const epnum = tu_edpt_number(ep_addr);
+  uint8_t const dir = tu_edpt_dir(ep_addr);
+  tu_edpt_state_t* ep_state = &_usbd_dev.ep_status[epnum][dir];
+
+#if CFG_TUD_EDPT_XFER_QUEUE
+  if (epnum) {
+    ep_state->claimed = 0;
+    if (next_started) return;
+
+    // transfer queued after completion in ISR
+    uint8_t* buffer;
+    uint16_t total_bytes;
+
+    usbd_lock();
+    bool const has_next = xfer_queue_pop(epnum, dir, &buffer, &total_bytes);
+    if (!has_next) ep_state->busy = 0;
+    usbd_unlock();
+
+    if (has_next) (void) edpt_xfer_start(rhport, ep_addr, buffer, total_bytes);
+    return;
+  }
+#else
+  (void) next_started;
+#endif
+
+  (void) rhport;
+  ep_state->busy = 0;
+  ep_state->claimed = 0;
+}
+
 // The number of bytes has to be given explicitly to allow more flexible control of how many
 // bytes should be written and second to keep the return value free to give back a boolean
 // success message. If total_bytes is too big, the FIFO will copy only what is available
@@ -1347,7 +2102,7 @@ bool usbd_edpt_xfer_fifo(uint8_t rhport, uint8_t ep_addr, tu_fifo_t* ff, uint16_
   uint8_t const epnum = tu_edpt_number(ep_addr);
   uint8_t const dir = tu_edpt_dir(ep_addr);
 
-  TU_LOG_USBD("  Queue ISO EP %02X with %u bytes ... ", ep_addr, total_bytes);
+  TU_LOG_USBD_EDPT("  Queue ISO EP %02X with %u bytes ... ", ep_addr, total_bytes);
 
   // Attempt to transfer on a busy endpoint, sound like an race condition !
   TU_ASSERT(_usbd_dev.ep_status[epnum][dir].busy == 0);
@@ -1357,13 +2112,15 @@ bool usbd_edpt_xfer_fifo(uint8_t rhport, uint8_t ep_addr, tu_fifo_t* ff, uint16_
   _usbd_dev.ep_status[epnum][dir].busy = 1;
 
   if (dcd_edpt_xfer_fifo(rhport, ep_addr, ff, total_bytes)) {
-    TU_LOG_USBD("OK\r\n");
+    TU_LOG_USBD_EDPT("OK\r\n");
+    TU_TRACE(TU_TRACE_USBD_QUEUE, ep_addr, 0, total_bytes, TU_TRACE_QUEUE_ISO_STARTED);
     return true;
   } else {
     // DCD error, mark endpoint as ready to allow next transfer
     _usbd_dev.ep_status[epnum][dir].busy = 0;
     _usbd_dev.ep_status[epnum][dir].claimed = 0;
-    TU_LOG_USBD("failed\r\n");
+    TU_LOG_USBD_EDPT("failed\r\n");
+    TU_TRACE(TU_TRACE_USBD_QUEUE, ep_addr, 0, total_bytes, TU_TRACE_QUEUE_ISO_FAILED);
     TU_BREAKPOINT();
     return false;
   }
@@ -1385,8 +2142,10 @@ void usbd_edpt_stall(uint8_t rhport, uint8_t ep_addr) {
   uint8_t const dir = tu_edpt_dir(ep_addr);
 
   // only stalled if currently cleared
-  TU_LOG_USBD("    Stall EP %02X\r\n", ep_addr);
+  TU_LOG_USBD_EDPT("    Stall EP %02X\r\n", ep_addr);
+  TU_TRACE(TU_TRACE_USBD_STALL, ep_addr, 1, 0, 0);
   dcd_edpt_stall(rhport, ep_addr);
+  usbd_stats_edpt_stall(ep_addr);
   _usbd_dev.ep_status[epnum][dir].stalled = 1;
   _usbd_dev.ep_status[epnum][dir].busy = 1;
 }
@@ -1399,6 +2158,7 @@ void usbd_edpt_clear_stall(uint8_t rhport, uint8_t ep_addr) {
 
   // only clear if currently stalled
   TU_LOG_USBD("    Clear Stall EP %02X\r\n", ep_addr);
+  TU_TRACE(TU_TRACE_USBD_STALL, ep_addr, 0, 0, 0);
   dcd_edpt_clear_stall(rhport, ep_addr);
   _usbd_dev.ep_status[epnum][dir].stalled = 0;
   _usbd_dev.ep_status[epnum][dir].busy = 0;
@@ -1433,6 +2193,9 @@ void usbd_edpt_close(uint8_t rhport, uint8_t ep_addr) {
   _usbd_dev.ep_status[epnum][dir].stalled = 0;
   _usbd_dev.ep_status[epnum][dir].busy = 0;
   _usbd_dev.ep_status[epnum][dir].claimed = 0;
+#if CFG_TUD_EDPT_XFER_QUEUE
+  tu_varclr(&_usbd_dev.xfer_queue[epnum][dir]);
+#endif
 #endif
 
   return;
@@ -1441,6 +2204,9 @@ void usbd_edpt_close(uint8_t rhport, uint8_t ep_addr) {
 void usbd_sof_enable(uint8_t rhport, sof_consumer_t consumer, bool en) {
   rhport = _usbd_rhport;
 
+  // consumers are enabled from task context of different threads e.g tud_cdc_n_write()
+  usbd_lock();
+
   uint8_t consumer_old = _usbd_dev.sof_consumer;
   // Keep track how many class instances need the SOF interrupt
   if (en) {
@@ -1453,6 +2219,8 @@ void usbd_sof_enable(uint8_t rhport, sof_consumer_t consumer, bool en) {
   if(!_usbd_dev.sof_consumer != !consumer_old) {
     dcd_sof_enable(rhport, _usbd_dev.sof_consumer);
   }
+
+  usbd_unlock();
 }
 
 bool usbd_edpt_iso_alloc(uint8_t rhport, uint8_t ep_addr, uint16_t largest_packet_size) {
@@ -108,6 +108,41 @@ bool tud_control_xfer(uint8_t rhport, tusb_control_request_t const * request, vo
 // Send STATUS (zero length) packet
 bool tud_control_status(uint8_t rhport, tusb_control_request_t const * request);
 
+#if CFG_TUD_STATS
+typedef struct {
+  tu_stats_edpt_t   edpt[CFG_TUD_ENDPPOINT_MAX][2];
+  tu_stats_driver_t driver[CFG_TUD_STATS_DRIVER_MAX]; // by driver id: application drivers first then built-in ones
+
+  uint32_t bus_reset;
+  uint32_t suspend;
+  uint32_t resume;
+  uint32_t setup;           // SETUP packets received
+  uint16_t queue_peak;      // event queue high-water mark
+  uint16_t ctrl_queue_peak; // control event queue high-water mark, CFG_TUD_TASK_CTRL_QUEUE only
+} tud_stats_t;
+
+// Copy stack counters. Counters are updated without locking (ISR and task each own theirs), start from
+// tud_init() and wrap around: compute difference between two reads for rates
+bool tud_stats_get(tud_stats_t* stats);
+
+// Reply to an IN control request with a snapshot of tud_stats_t (truncated to wLength). Can be called in
+// SETUP stage of tud_vendor_control_xfer_cb() for a request chosen by application
+bool tud_stats_control_xfer(uint8_t rhport, tusb_control_request_t const * request);
+#endif
+
+#if CFG_TUD_EVENT_LATENCY
+typedef struct {
+  tu_latency_hist_t event[9]; // by dcd event id (DCD_EVENT_COUNT) e.g DCD_EVENT_XFER_COMPLETE
+} tud_event_latency_t;
+
+// Copy histograms of delay from an event being queued (mostly from ISR) to tud_task() dispatching it,
+// in unit of tusb_timestamp_cb()
+bool tud_event_latency_get(tud_event_latency_t* latency);
+
+// Reset histograms, must be called in the same context as tud_task()
+void tud_event_latency_clear(void);
+#endif
+
 //--------------------------------------------------------------------+
 // Application Callbacks
 //--------------------------------------------------------------------+
@@ -161,6 +196,11 @@ void tud_sof_cb(uint32_t frame_count);
 // Invoked when received control request with VENDOR TYPE
 bool tud_vendor_control_xfer_cb(uint8_t rhport, uint8_t stage, tusb_control_request_t const * request);
 
+// Invoked (CFG_TUD_CTRL_ZERO_COPY) to check if buffer passed to tud_control_xfer() can be accessed by the
+// controller directly e.g DMA-able memory region and alignment. Default returns false (always bounce), since
+// an aligned buffer may still be in flash or other memory the controller cannot read
+bool tud_control_xfer_dma_safe_cb(void const* buffer, uint16_t len);
+
 //--------------------------------------------------------------------+
 // Binary Device Object Store (BOS) Descriptor Templates
 //--------------------------------------------------------------------+
@@ -40,6 +40,16 @@ TU_ATTR_WEAK void dcd_edpt0_status_complete(uint8_t rhport, tusb_control_request
   (void) request;
 }
 
+#if CFG_TUD_CTRL_ZERO_COPY
+// Alignment alone does not make a buffer DMA-safe: descriptors in flash are aligned but e.g nRF EasyDMA
+// can only access RAM. Default to bounce buffer, application opts in with knowledge of its memory map.
+TU_ATTR_WEAK bool tud_control_xfer_dma_safe_cb(void const* buffer, uint16_t len) {
+  (void) buffer;
+  (void) len;
+  return false;
+}
+#endif
+
 //--------------------------------------------------------------------+
 // MACRO CONSTANT TYPEDEF
 //--------------------------------------------------------------------+
@@ -58,6 +68,8 @@ typedef struct {
   uint8_t* buffer;
   uint16_t data_len;
   uint16_t total_xferred;
+  uint16_t xact_len;  // length of on-going data stage transaction
+  bool zero_copy;     // data stage transferred directly from/to buffer
   usbd_control_xfer_cb_t complete_cb;
 } usbd_control_xfer_t;
 
@@ -83,24 +95,31 @@ bool tud_control_status(uint8_t rhport, tusb_control_request_t const* request) {
   _ctrl_xfer.buffer = NULL;
   _ctrl_xfer.total_xferred = 0;
   _ctrl_xfer.data_len = 0;
+  _ctrl_xfer.zero_copy = false;
 
   return _status_stage_xact(rhport, request);
 }
 
 // Queue a transaction in Data Stage
-// Each transaction has up to Endpoint0's max packet size.
+// Each transaction has up to Endpoint0's max packet size, or the whole remaining data in zero copy mode.
 // This function can also transfer an zero-length packet
 static bool _data_stage_xact(uint8_t rhport) {
-  uint16_t const xact_len = tu_min16(_ctrl_xfer.data_len - _ctrl_xfer.total_xferred,
-                                     CFG_TUD_ENDPOINT0_SIZE);
+  uint16_t const remaining = _ctrl_xfer.data_len - _ctrl_xfer.total_xferred;
+  uint8_t const ep_addr = (_ctrl_xfer.request.bmRequestType_bit.direction == TUSB_DIR_IN) ?
+                          EDPT_CTRL_IN : EDPT_CTRL_OUT;
+
+#if CFG_TUD_CTRL_ZERO_COPY
+  if (_ctrl_xfer.zero_copy) {
+    _ctrl_xfer.xact_len = remaining;
+    return usbd_edpt_xfer(rhport, ep_addr, remaining ? _ctrl_xfer.buffer : NULL, remaining);
+  }
+#endif
 
-  uint8_t ep_addr = EDPT_CTRL_OUT;
+  uint16_t const xact_len = tu_min16(remaining, CFG_TUD_ENDPOINT0_SIZE);
+  _ctrl_xfer.xact_len = xact_len;
 
-  if (_ctrl_xfer.request.bmRequestType_bit.direction == TUSB_DIR_IN) {
-    ep_addr = EDPT_CTRL_IN;
-    if (xact_len) {
-      TU_VERIFY(0 == tu_memcpy_s(_usbd_ctrl_buf, CFG_TUD_ENDPOINT0_SIZE, _ctrl_xfer.buffer, xact_len));
-    }
+  if (ep_addr == EDPT_CTRL_IN && xact_len) {
+    TU_VERIFY(0 == tu_memcpy_s(_usbd_ctrl_buf, CFG_TUD_ENDPOINT0_SIZE, _ctrl_xfer.buffer, xact_len));
   }
 
   return usbd_edpt_xfer(rhport, ep_addr, xact_len ? _usbd_ctrl_buf : NULL, xact_len);
@@ -113,10 +132,17 @@ bool tud_control_xfer(uint8_t rhport, tusb_control_request_t const* request, voi
   _ctrl_xfer.buffer = (uint8_t*) buffer;
   _ctrl_xfer.total_xferred = 0U;
   _ctrl_xfer.data_len = tu_min16(len, request->wLength);
+  _ctrl_xfer.zero_copy = false;
 
   if (request->wLength > 0U) {
     if (_ctrl_xfer.data_len > 0U) {
       TU_ASSERT(buffer);
+
+      #if CFG_TUD_CTRL_ZERO_COPY
+      // single packet is bounced anyway, not worth asking
+      _ctrl_xfer.zero_copy = (_ctrl_xfer.data_len > CFG_TUD_ENDPOINT0_SIZE) &&
+                             tud_control_xfer_dma_safe_cb(buffer, _ctrl_xfer.data_len);
+      #endif
     }
 
 //    TU_LOG2("  Control total data length is %u bytes\r\n", _ctrl_xfer.data_len);
@@ -154,6 +180,7 @@ void usbd_control_set_request(tusb_control_request_t const* request) {
   _ctrl_xfer.buffer = NULL;
   _ctrl_xfer.total_xferred = 0;
   _ctrl_xfer.data_len = 0;
+  _ctrl_xfer.zero_copy = false;
 }
 
 // callback when a transaction complete on
@@ -177,7 +204,7 @@ bool usbd_control_xfer_cb(uint8_t rhport, uint8_t ep_addr, xfer_result_t result,
     return true;
   }
 
-  if (_ctrl_xfer.request.bmRequestType_bit.direction == TUSB_DIR_OUT) {
+  if (_ctrl_xfer.request.bmRequestType_bit.direction == TUSB_DIR_OUT && !_ctrl_xfer.zero_copy) {
     TU_VERIFY(_ctrl_xfer.buffer);
     memcpy(_ctrl_xfer.buffer, _usbd_ctrl_buf, xferred_bytes);
     TU_LOG_MEM(CFG_TUD_LOG_LEVEL, _usbd_ctrl_buf, xferred_bytes, 2);
@@ -186,10 +213,13 @@ bool usbd_control_xfer_cb(uint8_t rhport, uint8_t ep_addr, xfer_result_t result,
   _ctrl_xfer.total_xferred += (uint16_t) xferred_bytes;
   _ctrl_xfer.buffer += xferred_bytes;
 
-  // Data Stage is complete when all request's length are transferred or
-  // a short packet is sent including zero-length packet.
-  if ((_ctrl_xfer.request.wLength == _ctrl_xfer.total_xferred) ||
-      (xferred_bytes < CFG_TUD_ENDPOINT0_SIZE)) {
+  // Data Stage is complete when all request's length are transferred or a short packet is sent including
+  // zero-length packet. Transaction can span multiple packets in zero copy mode, its last packet is short
+  // if length is not multiple of packet size or less than requested (OUT).
+  bool const short_packet = (xferred_bytes == 0) || (xferred_bytes % CFG_TUD_ENDPOINT0_SIZE) ||
+                            (xferred_bytes < _ctrl_xfer.xact_len);
+
+  if ((_ctrl_xfer.request.wLength == _ctrl_xfer.total_xferred) || short_packet) {
     // DATA stage is complete
     bool is_ok = true;
 
@@ -210,6 +240,8 @@ bool usbd_control_xfer_cb(uint8_t rhport, uint8_t ep_addr, xfer_result_t result,
       // Stall both IN and OUT control endpoint
       dcd_edpt_stall(rhport, EDPT_CTRL_OUT);
       dcd_edpt_stall(rhport, EDPT_CTRL_IN);
+      usbd_stats_edpt_stall(EDPT_CTRL_OUT);
+      usbd_stats_edpt_stall(EDPT_CTRL_IN);
     }
   } else {
     // More data to transfer
@@ -0,0 +1,341 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Ha Thach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * This file is part of the TinyUSB stack.
+ */
+
+#ifndef TUSB_USBD_DESC_HPP_
+#define TUSB_USBD_DESC_HPP_
+
+#if !defined(__cplusplus) || __cplusplus < 201703L
+  #error "usbd_desc.hpp requires C++17"
+#endif
+
+#include "tusb.h"
+
+/* Compile-time configuration descriptor builder (C++17)
+ *
+ * Each function is one of the TUD_*_DESCRIPTOR templates of the class headers, configuration() prepends the
+ * configuration descriptor with computed wTotalLength and bNumInterfaces. The result is byte-identical to the
+ * hand-assembled C array and also carries the interface/endpoint to function maps.
+ *
+ *   constexpr auto desc_cfg = tud::desc::configuration(1, 0, 0x00, 100,
+ *       tud::desc::function({ TUD_CDC_DESCRIPTOR(0, 4, 0x81, 8, 0x02, 0x82, 64) }),
+ *       tud::desc::function({ TUD_MSC_DESCRIPTOR(2, 5, 0x03, 0x83, 64) }));
+ *   static_assert(desc_cfg.check(TUSB_SPEED_FULL) == tud::desc::error::none, "bad configuration");
+ *
+ *   uint8_t const* tud_descriptor_configuration_cb(uint8_t index) { return desc_cfg.data; }
+ *
+ * check() can also be used on an existing constexpr byte array e.g tud::desc::check(desc_fs_configuration, speed).
+ */
+
+namespace tud::desc {
+
+enum class error : uint8_t {
+  none = 0,
+  structure,          // broken descriptor chain, wTotalLength mismatch or endpoint outside of an interface
+  interface_number,   // interfaces/alternate settings not numbered from 0 in order, or >= CFG_TUD_INTERFACE_MAX
+  association,        // IAD is not followed by its first interface or refers to non-existing interfaces
+  endpoint_count,     // bNumEndpoints does not match endpoint descriptors of the interface
+  endpoint_number,    // endpoint 0, reserved address bits or number >= CFG_TUD_ENDPPOINT_MAX
+  endpoint_duplicate, // endpoint address used by more than one interface or twice in an alternate setting
+  packet_size,        // wMaxPacketSize not allowed for transfer type and speed
+  bandwidth,          // periodic endpoints need more than 90% of a frame (FS) or 80% of a microframe (HS)
+};
+
+// Invalid function index in itf2func[] ep2func[][]
+constexpr uint8_t FUNC_INVALID = 0xFFu;
+
+//--------------------------------------------------------------------+
+// Validation
+//--------------------------------------------------------------------+
+namespace detail {
+
+constexpr uint16_t u16(uint8_t const* p) {
+  return (uint16_t) (p[0] | (p[1] << 8));
+}
+
+// constexpr version of tu_edpt_number()/tu_edpt_dir()
+constexpr uint8_t edpt_number(uint8_t addr) {
+  return (uint8_t) (addr & 0x0F);
+}
+
+constexpr uint8_t edpt_dir(uint8_t addr) {
+  return (addr & TUSB_DIR_IN_MASK) ? 1 : 0;
+}
+
+constexpr bool packet_size_valid(uint8_t xfer_type, uint16_t size, uint8_t mult, bool high_speed) {
+  if (mult == 3) return false; // reserved
+  if (!high_speed && mult) return false;
+
+  switch (xfer_type) {
+    case TUSB_XFER_BULK:
+      if (mult) return false;
+      return high_speed ? (size == 512) : (size == 8 || size == 16 || size == 32 || size == 64);
+
+    case TUSB_XFER_INTERRUPT:
+      return size <= (high_speed ? 1024 : 64);
+
+    case TUSB_XFER_ISOCHRONOUS:
+      return size <= (high_speed ? 1024 : 1023);
+
+    default:
+      return size <= 64;
+  }
+}
+
+} // namespace detail
+
+// Validate a configuration descriptor against stack limits and USB 2.0 rules for the given speed
+constexpr error check(uint8_t const* desc, size_t len, tusb_speed_t speed) {
+  bool const high_speed = (speed == TUSB_SPEED_HIGH);
+
+  if (len < TUD_CONFIG_DESC_LEN || desc[0] != TUD_CONFIG_DESC_LEN || desc[1] != TUSB_DESC_CONFIGURATION ||
+      detail::u16(desc + 2) != len) {
+    return error::structure;
+  }
+
+  uint8_t itf_count = 0;
+  uint8_t last_alt[CFG_TUD_INTERFACE_MAX] = {};
+  uint32_t itf_bw[CFG_TUD_INTERFACE_MAX] = {}; // periodic bytes per (micro)frame of most demanding alternate
+  int16_t ep_owner[CFG_TUD_ENDPPOINT_MAX][2] = {};
+
+  int16_t cur_itf = -1;
+  uint8_t ep_expected = 0;
+  uint8_t ep_found = 0;
+  uint32_t alt_eps = 0; // endpoints used by current alternate setting
+  uint32_t alt_bw = 0;
+
+  int16_t iad_first = -1; // IAD waiting for its first interface
+  uint16_t iad_end = 0;   // interfaces referenced by all IADs must exist
+
+  for (uint8_t epnum = 0; epnum < CFG_TUD_ENDPPOINT_MAX; epnum++) {
+    ep_owner[epnum][0] = ep_owner[epnum][1] = -1;
+  }
+
+  size_t pos = TUD_CONFIG_DESC_LEN;
+  while (pos <= len) {
+    bool const end = (pos == len);
+    uint8_t const* p = desc + pos;
+    uint8_t const type = end ? 0 : p[1];
+
+    if (!end && (p[0] < 2 || pos + p[0] > len)) return error::structure;
+
+    // close current interface on next interface or end of configuration
+    if (end || type == TUSB_DESC_INTERFACE) {
+      if (cur_itf >= 0) {
+        if (ep_found != ep_expected) return error::endpoint_count;
+        if (alt_bw > itf_bw[cur_itf]) itf_bw[cur_itf] = alt_bw;
+      }
+      if (end) break;
+    }
+
+    if (iad_first >= 0 && type != TUSB_DESC_INTERFACE) return error::association;
+
+    switch (type) {
+      case TUSB_DESC_INTERFACE_ASSOCIATION: {
+        if (p[0] < 8 || p[3] == 0) return error::structure;
+        iad_first = p[2];
+        if (p[2] + p[3] > iad_end) iad_end = (uint16_t) (p[2] + p[3]);
+        break;
+      }
+
+      case TUSB_DESC_INTERFACE: {
+        if (p[0] < 9) return error::structure;
+        uint8_t const itf = p[2];
+        uint8_t const alt = p[3];
+
+        if (iad_first >= 0 && iad_first != itf) return error::association;
+        iad_first = -1;
+
+        if (itf >= CFG_TUD_INTERFACE_MAX) return error::interface_number;
+        if (itf == itf_count) {
+          // new interface, must start with alternate 0
+          if (alt != 0) return error::interface_number;
+          itf_count++;
+        } else if (itf + 1 == itf_count && alt == last_alt[itf] + 1) {
+          // next alternate setting of current interface
+        } else {
+          return error::interface_number;
+        }
+
+        last_alt[itf] = alt;
+        cur_itf = itf;
+        ep_expected = p[4];
+        ep_found = 0;
+        alt_eps = 0;
+        alt_bw = 0;
+        break;
+      }
+
+      case TUSB_DESC_ENDPOINT: {
+        if (p[0] < 7 || cur_itf < 0) return error::structure;
+        uint8_t const ep_addr = p[2];
+        uint8_t const epnum = detail::edpt_number(ep_addr);
+        uint8_t const dir = detail::edpt_dir(ep_addr);
+
+        if ((ep_addr & 0x70) || epnum == 0 || epnum >= CFG_TUD_ENDPPOINT_MAX) return error::endpoint_number;
+
+        uint32_t const ep_bit = 1ul << (epnum + 16 * dir);
+        if ((alt_eps & ep_bit) || (ep_owner[epnum][dir] >= 0 && ep_owner[epnum][dir] != cur_itf)) {
+          return error::endpoint_duplicate;
+        }
+        alt_eps |= ep_bit;
+        ep_owner[epnum][dir] = cur_itf;
+        ep_found++;
+
+        uint8_t const xfer_type = p[3] & 0x03;
+        uint16_t const max_packet = detail::u16(p + 4);
+        uint16_t const size = max_packet & 0x7FF;
+        uint8_t const mult = (uint8_t) ((max_packet >> 11) & 0x03);
+
+        if (!detail::packet_size_valid(xfer_type, size, mult, high_speed)) return error::packet_size;
+
+        if (xfer_type == TUSB_XFER_INTERRUPT || xfer_type == TUSB_XFER_ISOCHRONOUS) {
+          alt_bw += (uint32_t) size * (mult + 1u);
+        }
+        break;
+      }
+
+      default: break;
+    }
+
+    pos += p[0];
+  }
+
+  if (desc[4] != itf_count) return error::interface_number;
+  if (iad_first >= 0 || iad_end > itf_count) return error::association;
+
+  uint32_t bw = 0;
+  for (uint8_t i = 0; i < itf_count; i++) bw += itf_bw[i];
+  if (bw > (high_speed ? 6000u : 1350u)) return error::bandwidth;
+
+  return error::none;
+}
+
+template <size_t N>
+constexpr error check(uint8_t const (&desc)[N], tusb_speed_t speed) {
+  return check(desc, N, speed);
+}
+
+//--------------------------------------------------------------------+
+// Builder
+//--------------------------------------------------------------------+
+
+// One class function i.e descriptors opened by a single class driver, usually from a TUD_*_DESCRIPTOR template
+template <size_t N>
+struct function_t {
+  uint8_t data[N];
+};
+
+template <size_t N>
+constexpr function_t<N> function(uint8_t const (&desc)[N]) {
+  function_t<N> func{};
+  for (size_t i = 0; i < N; i++) func.data[i] = desc[i];
+  return func;
+}
+
+template <size_t N, size_t F>
+struct configuration_t {
+  uint8_t data[N];
+
+  // Function layout in order of descriptor, matching the order in which usbd opens class drivers
+  uint16_t func_offset[F]; // offset of function (IAD if any) within configuration
+  uint16_t func_len[F];
+
+  uint8_t itf2func[CFG_TUD_INTERFACE_MAX];   // map interface number to function index (FUNC_INVALID if unused)
+  uint8_t ep2func[CFG_TUD_ENDPPOINT_MAX][2]; // map endpoint to function index (FUNC_INVALID if unused)
+
+  static constexpr size_t size = N;
+  static constexpr size_t func_count = F;
+
+  constexpr error check(tusb_speed_t speed) const {
+    return desc::check(data, speed);
+  }
+};
+
+namespace detail {
+
+template <size_t N, size_t F, size_t L>
+constexpr void append(configuration_t<N, F>& cfg, size_t& offset, uint8_t& idx, bool (&itf_used)[256],
+                      function_t<L> const& func) {
+  cfg.func_offset[idx] = (uint16_t) offset;
+  cfg.func_len[idx]    = (uint16_t) L;
+
+  for (size_t i = 0; i < L; i++) cfg.data[offset + i] = func.data[i];
+
+  // out of range numbers are left unmapped, check() reports them
+  for (size_t pos = 0; pos + 2 < L && func.data[pos] >= 2; pos += func.data[pos]) {
+    uint8_t const* p = func.data + pos;
+    if (p[1] == TUSB_DESC_INTERFACE) {
+      itf_used[p[2]] = true;
+      if (p[2] < CFG_TUD_INTERFACE_MAX) cfg.itf2func[p[2]] = idx;
+    } else if (p[1] == TUSB_DESC_ENDPOINT) {
+      uint8_t const epnum = edpt_number(p[2]);
+      if (epnum < CFG_TUD_ENDPPOINT_MAX) cfg.ep2func[epnum][edpt_dir(p[2])] = idx;
+    }
+  }
+
+  offset += L;
+  idx++;
+}
+
+} // namespace detail
+
+// Configuration descriptor followed by functions, wTotalLength and bNumInterfaces are computed
+template <size_t... L>
+constexpr configuration_t<TUD_CONFIG_DESC_LEN + (L + ...), sizeof...(L)>
+configuration(uint8_t config_num, uint8_t stridx, uint8_t attribute, uint16_t power_ma, function_t<L> const&... funcs) {
+  constexpr size_t total_len = TUD_CONFIG_DESC_LEN + (L + ...);
+  static_assert(total_len <= UINT16_MAX, "configuration descriptor is too long");
+
+  configuration_t<total_len, sizeof...(L)> cfg{};
+
+  for (uint8_t i = 0; i < CFG_TUD_INTERFACE_MAX; i++) cfg.itf2func[i] = FUNC_INVALID;
+  for (uint8_t i = 0; i < CFG_TUD_ENDPPOINT_MAX; i++) cfg.ep2func[i][0] = cfg.ep2func[i][1] = FUNC_INVALID;
+
+  bool itf_used[256] = {};
+  size_t offset = TUD_CONFIG_DESC_LEN;
+  uint8_t idx = 0;
+  (detail::append(cfg, offset, idx, itf_used, funcs), ...);
+
+  uint8_t itf_count = 0;
+  for (bool used : itf_used) itf_count = (uint8_t) (itf_count + (used ? 1 : 0));
+
+  // same layout as TUD_CONFIG_DESCRIPTOR()
+  cfg.data[0] = TUD_CONFIG_DESC_LEN;
+  cfg.data[1] = TUSB_DESC_CONFIGURATION;
+  cfg.data[2] = TU_U16_LOW(total_len);
+  cfg.data[3] = TU_U16_HIGH(total_len);
+  cfg.data[4] = itf_count;
+  cfg.data[5] = config_num;
+  cfg.data[6] = stridx;
+  cfg.data[7] = (uint8_t) (TU_BIT(7) | attribute);
+  cfg.data[8] = (uint8_t) (power_ma / 2);
+
+  return cfg;
+}
+
+} // namespace tud::desc
+
+#endif
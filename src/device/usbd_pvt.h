@@ -43,6 +43,8 @@
 typedef enum {
   SOF_CONSUMER_USER = 0,
   SOF_CONSUMER_AUDIO,
+  SOF_CONSUMER_CDC,
+  SOF_CONSUMER_MSC,
 } sof_consumer_t;
 
 //--------------------------------------------------------------------+
@@ -58,6 +60,14 @@ typedef struct {
   bool     (* control_xfer_cb  ) (uint8_t rhport, uint8_t stage, tusb_control_request_t const * request);
   bool     (* xfer_cb          ) (uint8_t rhport, uint8_t ep_addr, xfer_result_t result, uint32_t xferred_bytes);
   void     (* sof              ) (uint8_t rhport, uint32_t frame_count); // optional
+
+  // Optional: handle transfer complete of non-control endpoint in ISR context (fast path) instead of
+  // xfer_cb() in tud_task(). Return false without submitting a transfer to defer it to xfer_cb() as usual.
+  // Only following calls are allowed within: usbd_edpt_xfer(), usbd_edpt_xfer_fifo(), usbd_edpt_busy(),
+  // usbd_edpt_stalled(), usbd_edpt_stall(), usbd_defer_func() with in_isr = true and tu_fifo_*() on fifo
+  // without mutex. Claim/release, open/close, control transfer and any blocking OSAL call are not allowed.
+  // Endpoint is no longer busy when invoked, and is marked busy again if transfer is deferred.
+  bool     (* xfer_isr         ) (uint8_t rhport, uint8_t ep_addr, xfer_result_t result, uint32_t xferred_bytes);
 } usbd_class_driver_t;
 
 // Invoked when initializing device stack to get additional class drivers.
@@ -83,6 +93,12 @@ void usbd_edpt_close(uint8_t rhport, uint8_t ep_addr);
 // Submit a usb transfer
 bool usbd_edpt_xfer(uint8_t rhport, uint8_t ep_addr, uint8_t * buffer, uint16_t total_bytes);
 
+// Submit a usb transfer, or queue it if endpoint is busy (requires CFG_TUD_EDPT_XFER_QUEUE). Queued transfer
+// is started by usbd as soon as the previous one completes without waiting for tud_task(), each transfer
+// still invokes xfer_cb(). Return false if queue is full. Task context only, an endpoint using this must
+// not be claimed or used with usbd_edpt_xfer() or driver's xfer_isr()
+bool usbd_edpt_xfer_queue(uint8_t rhport, uint8_t ep_addr, uint8_t * buffer, uint16_t total_bytes);
+
 // Submit a usb ISO transfer by use of a FIFO (ring buffer) - all bytes in FIFO get transmitted
 bool usbd_edpt_xfer_fifo(uint8_t rhport, uint8_t ep_addr, tu_fifo_t * ff, uint16_t total_bytes);
 
@@ -117,7 +133,7 @@ bool usbd_edpt_ready(uint8_t rhport, uint8_t ep_addr) {
   return !usbd_edpt_busy(rhport, ep_addr) && !usbd_edpt_stalled(rhport, ep_addr);
 }
 
-// Enable SOF interrupt
+// Enable SOF interrupt, task context only
 void usbd_sof_enable(uint8_t rhport, sof_consumer_t consumer, bool en);
 
 /*------------------------------------------------------------------*/
@@ -127,6 +143,13 @@ void usbd_sof_enable(uint8_t rhport, sof_consumer_t consumer, bool en);
 bool usbd_open_edpt_pair(uint8_t rhport, uint8_t const* p_desc, uint8_t ep_count, uint8_t xfer_type, uint8_t* ep_out, uint8_t* ep_in);
 void usbd_defer_func(osal_task_func_t func, void *param, bool in_isr);
 
+#if CFG_TUD_STATS
+// Count a stall issued by stack without usbd_edpt_stall() e.g control endpoint
+void usbd_stats_edpt_stall(uint8_t ep_addr);
+#else
+  #define usbd_stats_edpt_stall(_ep_addr)
+#endif
+
 #ifdef __cplusplus
  }
 #endif
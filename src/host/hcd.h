@@ -94,6 +94,9 @@ typedef struct
     }func_call;
   };
 
+#if CFG_TUH_EVENT_LATENCY
+  uint32_t timestamp; // set by usbh when queued
+#endif
 } hcd_event_t;
 
 typedef struct
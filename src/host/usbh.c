@@ -44,6 +44,12 @@
   #define CFG_TUH_INTERFACE_MAX   8
 #endif
 
+// Number of usbh_defer_func() calls that can be pending. A call with same function and parameter as a pending one is
+// coalesced, task runs all pending calls in one pass per wake-up event. 0 to queue each call as its own event
+#ifndef CFG_TUH_DEFER_QUEUE_SZ
+  #define CFG_TUH_DEFER_QUEUE_SZ  0
+#endif
+
 //--------------------------------------------------------------------+
 // Weak stubs: invoked if no strong implementation is available
 //--------------------------------------------------------------------+
@@ -249,9 +255,41 @@ static usbh_device_t _usbh_devices[TOTAL_DEVICES];
 OSAL_QUEUE_DEF(usbh_int_set, _usbh_qdef, CFG_TUH_TASK_QUEUE_SZ, hcd_event_t);
 static osal_queue_t _usbh_q;
 
+#if CFG_TUH_DEFER_QUEUE_SZ
+TU_DEFER_QUEUE_DEF(_usbh_defer_q, CFG_TUH_DEFER_QUEUE_SZ);
+
+// Lock out usbh task of other threads and the hcd ISR
+TU_ATTR_ALWAYS_INLINE static inline void usbh_lock(void) {
+  (void) osal_mutex_lock(_usbh_mutex, OSAL_TIMEOUT_WAIT_FOREVER);
+  usbh_int_set(false);
+}
+
+TU_ATTR_ALWAYS_INLINE static inline void usbh_unlock(void) {
+  usbh_int_set(true);
+  (void) osal_mutex_unlock(_usbh_mutex);
+}
+
+static void defer_queue_drain(void);
+#endif
+
 CFG_TUH_MEM_SECTION CFG_TUH_MEM_ALIGN
 static uint8_t _usbh_ctrl_buf[CFG_TUH_ENUMERATION_BUFSIZE];
 
+#if CFG_TUH_STATS
+tu_static tuh_stats_t _usbh_stats;
+
+// Event queue depth is posted - received, each counter is written by one side only: events are posted from ISR and
+// task context (e.g deferred attach, usbh_defer_func()), received by task
+tu_static volatile uint16_t _usbh_stats_posted_isr;
+tu_static volatile uint16_t _usbh_stats_posted_task;
+tu_static volatile uint16_t _usbh_stats_received;
+#endif
+
+#if CFG_TUH_EVENT_LATENCY
+TU_VERIFY_STATIC(TU_ARRAY_SIZE(((tuh_event_latency_t*) 0)->event) == HCD_EVENT_COUNT, "event count mismatch");
+tu_static tuh_event_latency_t _usbh_latency;
+#endif
+
 // Control transfers: since most controllers do not support multiple control transfers
 // on multiple devices concurrently and control transfers are not used much except for
 // enumeration, we will only execute control transfers one at a time.
@@ -281,14 +319,91 @@ static bool usbh_control_xfer_cb (uint8_t daddr, uint8_t ep_addr, xfer_result_t
 #if CFG_TUSB_OS == OPT_OS_NONE
 // TODO rework time-related function later
 // weak and overridable
+// Busy wait: frame number advances without raising an interrupt on most HCDs, nothing to sleep on
 TU_ATTR_WEAK void osal_task_delay(uint32_t msec) {
   const uint32_t start = hcd_frame_number(_usbh_controller);
   while ( ( hcd_frame_number(_usbh_controller) - start ) < msec ) {}
 }
 #endif
 
+//--------------------------------------------------------------------+
+// Stats
+//--------------------------------------------------------------------+
+#if CFG_TUH_STATS
+TU_ATTR_ALWAYS_INLINE static inline void stats_queue_posted(bool in_isr) {
+  if (in_isr) {
+    _usbh_stats_posted_isr++;
+  } else {
+    _usbh_stats_posted_task++;
+  }
+
+  uint16_t const depth = (uint16_t) (_usbh_stats_posted_isr + _usbh_stats_posted_task - _usbh_stats_received);
+  if (depth > _usbh_stats.queue_peak) _usbh_stats.queue_peak = depth;
+}
+
+TU_ATTR_ALWAYS_INLINE static inline void stats_queue_received(void) {
+  _usbh_stats_received++;
+}
+
+// Count event reported by HCD
+static void stats_hcd_event(hcd_event_t const* event) {
+  switch (event->event_id) {
+    case HCD_EVENT_DEVICE_ATTACH: _usbh_stats.attach++; break;
+    case HCD_EVENT_DEVICE_REMOVE: _usbh_stats.remove++; break;
+
+    case HCD_EVENT_XFER_COMPLETE: {
+      uint8_t const ep_addr = event->xfer_complete.ep_addr;
+      tu_stats_edpt_t* st = &_usbh_stats.edpt[tu_edpt_number(ep_addr)][tu_edpt_dir(ep_addr)];
+      st->xfers++;
+      st->bytes += event->xfer_complete.len;
+      if (event->xfer_complete.result != XFER_RESULT_SUCCESS) st->errors++;
+      if (event->xfer_complete.result == XFER_RESULT_STALLED) st->stalls++;
+      break;
+    }
+
+    default: break;
+  }
+}
+
+static void stats_driver_done(uint8_t drv_id, uint32_t start) {
+  if (drv_id >= CFG_TUH_STATS_DRIVER_MAX) return;
+
+  uint32_t const elapsed = tusb_timestamp_cb() - start;
+  tu_stats_driver_t* st = &_usbh_stats.driver[drv_id];
+  st->calls++;
+  st->time += elapsed;
+  if (elapsed > st->time_max) st->time_max = elapsed;
+}
+
+  #define stats_time()  tusb_timestamp_cb()
+#else
+  #define stats_queue_posted(_in_isr)
+  #define stats_queue_received()
+  #define stats_hcd_event(_event)
+  #define stats_driver_done(_drv_id, _start)  (void) (_start)
+  #define stats_time()  0
+#endif
+
+#if CFG_TUH_EVENT_LATENCY
+// Event is dispatched by task, fold its queuing delay into histogram of its type
+TU_ATTR_ALWAYS_INLINE static inline void latency_event_dispatched(hcd_event_t const* event) {
+  if (event->event_id < HCD_EVENT_COUNT) {
+    tu_latency_hist_add(&_usbh_latency.event[event->event_id], tusb_timestamp_cb() - event->timestamp);
+  }
+}
+#else
+  #define latency_event_dispatched(_event)
+#endif
+
 TU_ATTR_ALWAYS_INLINE static inline bool queue_event(hcd_event_t const * event, bool in_isr) {
+#if CFG_TUH_EVENT_LATENCY
+  hcd_event_t evt = *event;
+  evt.timestamp = tusb_timestamp_cb();
+  event = &evt;
+#endif
+
   TU_ASSERT(osal_queue_send(_usbh_q, event, in_isr));
+  stats_queue_posted(in_isr);
   tuh_event_hook_cb(event->rhport, event->event_id, in_isr);
   return true;
 }
@@ -371,6 +486,19 @@ bool tuh_init(uint8_t rhport) {
     _usbh_q = osal_queue_create(&_usbh_qdef);
     TU_ASSERT(_usbh_q != NULL);
 
+#if CFG_TUH_STATS
+    tu_varclr(&_usbh_stats);
+    _usbh_stats_posted_isr = _usbh_stats_posted_task = _usbh_stats_received = 0;
+#endif
+
+#if CFG_TUH_EVENT_LATENCY
+    tu_varclr(&_usbh_latency);
+#endif
+
+#if CFG_TUH_DEFER_QUEUE_SZ
+    tu_defer_clear(&_usbh_defer_q);
+#endif
+
 #if OSAL_MUTEX_REQUIRED
     // Init mutex
     _usbh_mutex = osal_mutex_create(&_usbh_mutexdef);
@@ -444,6 +572,26 @@ bool tuh_deinit(uint8_t rhport) {
   return true;
 }
 
+#if CFG_TUH_STATS
+bool tuh_stats_get(tuh_stats_t* stats) {
+  TU_VERIFY(stats);
+  *stats = _usbh_stats;
+  return true;
+}
+#endif
+
+#if CFG_TUH_EVENT_LATENCY
+bool tuh_event_latency_get(tuh_event_latency_t* latency) {
+  TU_VERIFY(latency);
+  *latency = _usbh_latency;
+  return true;
+}
+
+void tuh_event_latency_clear(void) {
+  tu_varclr(&_usbh_latency);
+}
+#endif
+
 bool tuh_task_event_ready(void) {
   // Skip if stack is not initialized
   if ( !tuh_inited() ) return false;
@@ -479,6 +627,9 @@ void tuh_task_ext(uint32_t timeout_ms, bool in_isr) {
   while (1) {
     hcd_event_t event;
     if (!osal_queue_receive(_usbh_q, &event, timeout_ms)) return;
+    timeout_ms = 0; // only wait for the first event, then drain the queue
+    stats_queue_received();
+    latency_event_dispatched(&event);
 
     switch (event.event_id) {
       case HCD_EVENT_DEVICE_ATTACH:
@@ -486,6 +637,7 @@ void tuh_task_ext(uint32_t timeout_ms, bool in_isr) {
         // TODO better to have an separated queue for newly attached devices
         if (_dev0.enumerating) {
           TU_LOG_USBH("[%u:] USBH Defer Attach until current enumeration complete\r\n", event.rhport);
+          TU_TRACE(TU_TRACE_USBH_ATTACH, event.rhport, 1, 0, 0);
 
           bool is_empty = osal_queue_empty(_usbh_q);
           queue_event(&event, in_isr);
@@ -496,6 +648,7 @@ void tuh_task_ext(uint32_t timeout_ms, bool in_isr) {
           }
         } else {
           TU_LOG_USBH("[%u:] USBH DEVICE ATTACH\r\n", event.rhport);
+          TU_TRACE(TU_TRACE_USBH_ATTACH, event.rhport, 0, 0, 0);
           _dev0.enumerating = 1;
           enum_new_device(&event);
         }
@@ -503,6 +656,7 @@ void tuh_task_ext(uint32_t timeout_ms, bool in_isr) {
 
       case HCD_EVENT_DEVICE_REMOVE:
         TU_LOG_USBH("[%u:%u:%u] USBH DEVICE REMOVED\r\n", event.rhport, event.connection.hub_addr, event.connection.hub_port);
+        TU_TRACE(TU_TRACE_USBH_REMOVE, event.rhport, event.connection.hub_addr | (event.connection.hub_port << 8), 0, 0);
         process_removing_device(event.rhport, event.connection.hub_addr, event.connection.hub_port);
 
         #if CFG_TUH_HUB
@@ -520,6 +674,7 @@ void tuh_task_ext(uint32_t timeout_ms, bool in_isr) {
         uint8_t const ep_dir = (uint8_t) tu_edpt_dir(ep_addr);
 
         TU_LOG_USBH("on EP %02X with %u bytes: %s\r\n", ep_addr, (unsigned int) event.xfer_complete.len, tu_str_xfer_result[event.xfer_complete.result]);
+        TU_TRACE(TU_TRACE_USBH_XFER, ep_addr, event.dev_addr, event.xfer_complete.len, event.xfer_complete.result);
 
         if (event.dev_addr == 0) {
           // device 0 only has control endpoint
@@ -559,8 +714,11 @@ void tuh_task_ext(uint32_t timeout_ms, bool in_isr) {
               usbh_class_driver_t const* driver = get_driver(drv_id);
               if (driver) {
                 TU_LOG_USBH("%s xfer callback\r\n", driver->name);
+                TU_TRACE(TU_TRACE_USBH_XFER_CB, drv_id, 0, 0, 0);
+                uint32_t const start = stats_time();
                 driver->xfer_cb(event.dev_addr, ep_addr, (xfer_result_t) event.xfer_complete.result,
                                 event.xfer_complete.len);
+                stats_driver_done(drv_id, start);
               } else {
                 // no driver/callback responsible for this transfer
                 TU_ASSERT(false,);
@@ -572,7 +730,14 @@ void tuh_task_ext(uint32_t timeout_ms, bool in_isr) {
       }
 
       case USBH_EVENT_FUNC_CALL:
-        if (event.func_call.func) event.func_call.func(event.func_call.param);
+        if (event.func_call.func) {
+          event.func_call.func(event.func_call.param);
+        }
+#if CFG_TUH_DEFER_QUEUE_SZ
+        else {
+          defer_queue_drain();
+        }
+#endif
         break;
 
       default:
@@ -827,12 +992,50 @@ void usbh_int_set(bool enabled) {
 void usbh_defer_func(osal_task_func_t func, void *param, bool in_isr) {
   hcd_event_t event = { 0 };
   event.event_id = USBH_EVENT_FUNC_CALL;
+
+#if CFG_TUH_DEFER_QUEUE_SZ
+  bool wake;
+  if (!in_isr) usbh_lock();
+  bool const pushed = tu_defer_push(&_usbh_defer_q, func, param, &wake);
+  if (!in_isr) usbh_unlock();
+
+  if (pushed) {
+    // wake-up event has NULL func, pending calls are run when it is processed
+    if (wake && !queue_event(&event, in_isr)) {
+      if (!in_isr) usbh_lock();
+      _usbh_defer_q.armed = false; // let next call retry
+      if (!in_isr) usbh_unlock();
+    }
+    return;
+  }
+  // defer queue is full: fall back to its own event
+#endif
+
   event.func_call.func = func;
   event.func_call.param = param;
 
   queue_event(&event, in_isr);
 }
 
+#if CFG_TUH_DEFER_QUEUE_SZ
+// Run calls pending at wake-up, ones pushed meanwhile have queued another wake-up event
+static void defer_queue_drain(void) {
+  usbh_lock();
+  uint8_t n = tu_defer_drain_begin(&_usbh_defer_q);
+  usbh_unlock();
+
+  while (n--) {
+    tu_defer_call_t call;
+    usbh_lock();
+    bool const popped = tu_defer_pop(&_usbh_defer_q, &call);
+    usbh_unlock();
+    if (!popped) break;
+
+    call.func(call.param);
+  }
+}
+#endif
+
 //--------------------------------------------------------------------+
 // Endpoint API
 //--------------------------------------------------------------------+
@@ -897,12 +1100,14 @@ bool usbh_edpt_xfer_with_callback(uint8_t dev_addr, uint8_t ep_addr, uint8_t* bu
 
   if (hcd_edpt_xfer(dev->rhport, dev_addr, ep_addr, buffer, total_bytes)) {
     TU_LOG_USBH("OK\r\n");
+    TU_TRACE(TU_TRACE_USBH_QUEUE, ep_addr, dev_addr, total_bytes, TU_TRACE_QUEUE_STARTED);
     return true;
   } else {
     // HCD error, mark endpoint as ready to allow next transfer
     ep_state->busy = 0;
     ep_state->claimed = 0;
     TU_LOG1("Failed\r\n");
+    TU_TRACE(TU_TRACE_USBH_QUEUE, ep_addr, dev_addr, total_bytes, TU_TRACE_QUEUE_FAILED);
 //    TU_BREAKPOINT();
     return false;
   }
@@ -957,6 +1162,8 @@ void hcd_devtree_get_info(uint8_t dev_addr, hcd_devtree_info_t* devtree_info) {
 }
 
 TU_ATTR_FAST_FUNC void hcd_event_handler(hcd_event_t const* event, bool in_isr) {
+  stats_hcd_event(event);
+
   switch (event->event_id) {
     case HCD_EVENT_DEVICE_REMOVE:
       // FIXME device remove from a hub need an HCD API for hcd to free up endpoint
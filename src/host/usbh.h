@@ -144,6 +144,33 @@ void tuh_task(void) {
 // Check if there is pending events need processing by tuh_task()
 bool tuh_task_event_ready(void);
 
+#if CFG_TUH_STATS
+typedef struct {
+  tu_stats_edpt_t   edpt[16][2]; // by endpoint address, sum of all devices
+  tu_stats_driver_t driver[CFG_TUH_STATS_DRIVER_MAX]; // by driver id: application drivers first then built-in ones
+
+  uint32_t attach;
+  uint32_t remove;
+  uint16_t queue_peak; // event queue high-water mark
+} tuh_stats_t;
+
+// Copy stack counters. Counters are updated without locking (ISR and task each own theirs), start from
+// tuh_init() and wrap around: compute difference between two reads for rates
+bool tuh_stats_get(tuh_stats_t* stats);
+#endif
+
+#if CFG_TUH_EVENT_LATENCY
+typedef struct {
+  tu_latency_hist_t event[4]; // by hcd event id (HCD_EVENT_COUNT) e.g HCD_EVENT_XFER_COMPLETE
+} tuh_event_latency_t;
+
+// Copy histograms of delay from an event being queued to tuh_task() dispatching it, in unit of tusb_timestamp_cb()
+bool tuh_event_latency_get(tuh_event_latency_t* latency);
+
+// Reset histograms, must be called in the same context as tuh_task()
+void tuh_event_latency_clear(void);
+#endif
+
 #ifndef _TUSB_HCD_H_
 extern void hcd_int_handler(uint8_t rhport, bool in_isr);
 #endif
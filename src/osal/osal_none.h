@@ -40,6 +40,15 @@ extern "C" {
 TU_ATTR_WEAK void osal_task_delay(uint32_t msec);
 #endif
 
+#if CFG_TUSB_OS_NONE_WAIT
+// Sleep until an interrupt occurs or msec has elapsed, called by task when its event queue is empty. Interrupt
+// arriving between the empty check and this call must end the wait e.g WFE on Cortex-M. Must not sleep past msec
+// unless it is OSAL_TIMEOUT_WAIT_FOREVER. Weak default has no timer: WFE on Cortex-M only when waiting forever,
+// otherwise returns immediately. Override with a wake-up timer (or rely on a periodic interrupt e.g SysTick) to
+// also sleep on finite timeout.
+void osal_none_wait_for_event(uint32_t msec);
+#endif
+
 //--------------------------------------------------------------------+
 // Binary Semaphore API
 //--------------------------------------------------------------------+
@@ -120,6 +129,123 @@ TU_ATTR_ALWAYS_INLINE static inline bool osal_mutex_unlock(osal_mutex_t mutex_hd
 //--------------------------------------------------------------------+
 // QUEUE API
 //--------------------------------------------------------------------+
+#if CFG_TUSB_OS_NONE_SPSC_QUEUE
+
+// Single-producer single-consumer ring: USB ISR is the producer, the task loop is the consumer. Each index
+// is only written by its owner, therefore ISR send and task receive don't need to mask the USB interrupt.
+// Send from task (in_isr = false) still masks it since the ISR is then another producer.
+// One slot is always kept free to tell full from empty without a shared count.
+typedef struct {
+  void (* interrupt_set)(bool);
+  uint8_t* buf;
+  uint16_t slots; // depth + 1
+  uint16_t item_size;
+  volatile uint16_t wr_idx; // written by producer only
+  volatile uint16_t rd_idx; // written by consumer only
+} osal_queue_def_t;
+
+typedef osal_queue_def_t* osal_queue_t;
+
+// _int_set is used as mutex for send from task (disable/enable USB ISR)
+#define OSAL_QUEUE_DEF(_int_set, _name, _depth, _type)    \
+  _type _name##_buf[(_depth) + 1];                        \
+  osal_queue_def_t _name = {                              \
+    .interrupt_set = _int_set,                            \
+    .buf = (uint8_t*) _name##_buf,                        \
+    .slots = (_depth) + 1,                                \
+    .item_size = sizeof(_type)                            \
+  }
+
+// ISR runs on the same core as the task: a compiler barrier is enough, otherwise a hardware barrier is needed.
+// Builtins of gcc/clang also work when this header is included by C++, other compilers use C11 atomics
+#if defined(__GNUC__)
+  #define _osal_q_acquire   __ATOMIC_ACQUIRE
+  #define _osal_q_release   __ATOMIC_RELEASE
+  #if TUP_MCU_MULTIPLE_CORE
+    #define _osal_q_fence(_order)   __atomic_thread_fence(_order)
+  #else
+    #define _osal_q_fence(_order)   __atomic_signal_fence(_order)
+  #endif
+#else
+  #include <stdatomic.h>
+  #define _osal_q_acquire   memory_order_acquire
+  #define _osal_q_release   memory_order_release
+  #if TUP_MCU_MULTIPLE_CORE
+    #define _osal_q_fence(_order)   atomic_thread_fence(_order)
+  #else
+    #define _osal_q_fence(_order)   atomic_signal_fence(_order)
+  #endif
+#endif
+
+TU_ATTR_ALWAYS_INLINE static inline uint16_t _osal_q_next(osal_queue_t qhdl, uint16_t idx) {
+  return (uint16_t) ((idx + 1u == qhdl->slots) ? 0 : (idx + 1u));
+}
+
+TU_ATTR_ALWAYS_INLINE static inline osal_queue_t osal_queue_create(osal_queue_def_t* qdef) {
+  qdef->wr_idx = 0;
+  qdef->rd_idx = 0;
+  return (osal_queue_t) qdef;
+}
+
+TU_ATTR_ALWAYS_INLINE static inline bool osal_queue_delete(osal_queue_t qhdl) {
+  (void) qhdl;
+  return true; // nothing to do
+}
+
+TU_ATTR_ALWAYS_INLINE static inline bool osal_queue_receive(osal_queue_t qhdl, void* data, uint32_t msec) {
+#if CFG_TUSB_OS_NONE_WAIT
+  // wait once, return false if still empty
+  if (msec && qhdl->rd_idx == qhdl->wr_idx) osal_none_wait_for_event(msec);
+#else
+  (void) msec; // not used, always behave as msec = 0
+#endif
+
+  uint16_t const rd_idx = qhdl->rd_idx;
+  if (rd_idx == qhdl->wr_idx) return false;
+
+  // acquire: item is read after seeing the producer's index
+  _osal_q_fence(_osal_q_acquire);
+  memcpy(data, qhdl->buf + rd_idx * qhdl->item_size, qhdl->item_size);
+
+  // release: item is read before its slot is handed back to the producer
+  _osal_q_fence(_osal_q_release);
+  qhdl->rd_idx = _osal_q_next(qhdl, rd_idx);
+
+  return true;
+}
+
+TU_ATTR_ALWAYS_INLINE static inline bool osal_queue_send(osal_queue_t qhdl, void const* data, bool in_isr) {
+  if (!in_isr) {
+    qhdl->interrupt_set(false);
+  }
+
+  uint16_t const wr_idx = qhdl->wr_idx;
+  uint16_t const next = _osal_q_next(qhdl, wr_idx);
+  bool const success = (next != qhdl->rd_idx);
+
+  if (success) {
+    // acquire: slot is written after seeing it released by consumer
+    _osal_q_fence(_osal_q_acquire);
+    memcpy(qhdl->buf + wr_idx * qhdl->item_size, data, qhdl->item_size);
+
+    // release: item is written before consumer sees the new index
+    _osal_q_fence(_osal_q_release);
+    qhdl->wr_idx = next;
+  }
+
+  if (!in_isr) {
+    qhdl->interrupt_set(true);
+  }
+
+  return success;
+}
+
+TU_ATTR_ALWAYS_INLINE static inline bool osal_queue_empty(osal_queue_t qhdl) {
+  return qhdl->rd_idx == qhdl->wr_idx;
+}
+
+#else
+
 #include "common/tusb_fifo.h"
 
 typedef struct {
@@ -160,7 +286,12 @@ TU_ATTR_ALWAYS_INLINE static inline bool osal_queue_delete(osal_queue_t qhdl) {
 }
 
 TU_ATTR_ALWAYS_INLINE static inline bool osal_queue_receive(osal_queue_t qhdl, void* data, uint32_t msec) {
+#if CFG_TUSB_OS_NONE_WAIT
+  // wait once, return false if still empty
+  if (msec && tu_fifo_empty(&qhdl->ff)) osal_none_wait_for_event(msec);
+#else
   (void) msec; // not used, always behave as msec = 0
+#endif
 
   _osal_q_lock(qhdl);
   bool success = tu_fifo_read(&qhdl->ff, data);
@@ -189,6 +320,8 @@ TU_ATTR_ALWAYS_INLINE static inline bool osal_queue_empty(osal_queue_t qhdl) {
   return tu_fifo_empty(&qhdl->ff);
 }
 
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,253 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Ha Thach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * This file is part of the TinyUSB stack.
+ */
+
+#ifndef TUSB_OSAL_POSIX_H_
+#define TUSB_OSAL_POSIX_H_
+
+// POSIX threads e.g Linux/macOS workstation: tud_task()/tuh_task() and application each run in their own thread.
+// "ISR" is any other thread, in_isr is ignored. Timeouts are real time in milliseconds.
+#include <pthread.h>
+#include <time.h>
+#include <errno.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//--------------------------------------------------------------------+
+// TASK API
+//--------------------------------------------------------------------+
+TU_ATTR_ALWAYS_INLINE static inline void osal_task_delay(uint32_t msec) {
+  struct timespec ts = { .tv_sec = (time_t) (msec / 1000), .tv_nsec = (long) (msec % 1000) * 1000000L };
+  while (nanosleep(&ts, &ts) != 0 && errno == EINTR) {}
+}
+
+// Absolute time msec from now on clock, for timed wait
+TU_ATTR_ALWAYS_INLINE static inline void _osal_posix_deadline(struct timespec* ts, clockid_t clock, uint32_t msec) {
+  clock_gettime(clock, ts);
+  ts->tv_sec  += (time_t) (msec / 1000);
+  ts->tv_nsec += (long) (msec % 1000) * 1000000L;
+  if (ts->tv_nsec >= 1000000000L) {
+    ts->tv_sec++;
+    ts->tv_nsec -= 1000000000L;
+  }
+}
+
+// Condition variable timed on monotonic clock, not affected by wall clock change
+TU_ATTR_ALWAYS_INLINE static inline void _osal_posix_cond_init(pthread_cond_t* cond) {
+  pthread_condattr_t attr;
+  pthread_condattr_init(&attr);
+  pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+  pthread_cond_init(cond, &attr);
+  pthread_condattr_destroy(&attr);
+}
+
+// Wait for cond with mutex locked, return false if msec elapsed
+TU_ATTR_ALWAYS_INLINE static inline bool _osal_posix_cond_wait(pthread_cond_t* cond, pthread_mutex_t* mutex,
+                                                               struct timespec const* deadline) {
+  if (deadline == NULL) return pthread_cond_wait(cond, mutex) == 0;
+  return pthread_cond_timedwait(cond, mutex, deadline) != ETIMEDOUT;
+}
+
+//--------------------------------------------------------------------+
+// Semaphore API
+//--------------------------------------------------------------------+
+typedef struct {
+  pthread_mutex_t mutex;
+  pthread_cond_t  cond;
+  uint32_t        count;
+} osal_semaphore_def_t;
+
+typedef osal_semaphore_def_t* osal_semaphore_t;
+
+TU_ATTR_ALWAYS_INLINE static inline osal_semaphore_t osal_semaphore_create(osal_semaphore_def_t* semdef) {
+  pthread_mutex_init(&semdef->mutex, NULL);
+  _osal_posix_cond_init(&semdef->cond);
+  semdef->count = 0;
+  return semdef;
+}
+
+TU_ATTR_ALWAYS_INLINE static inline bool osal_semaphore_delete(osal_semaphore_t semd_hdl) {
+  pthread_cond_destroy(&semd_hdl->cond);
+  return pthread_mutex_destroy(&semd_hdl->mutex) == 0;
+}
+
+TU_ATTR_ALWAYS_INLINE static inline bool osal_semaphore_post(osal_semaphore_t sem_hdl, bool in_isr) {
+  (void) in_isr;
+  pthread_mutex_lock(&sem_hdl->mutex);
+  sem_hdl->count++;
+  pthread_cond_signal(&sem_hdl->cond);
+  pthread_mutex_unlock(&sem_hdl->mutex);
+  return true;
+}
+
+TU_ATTR_ALWAYS_INLINE static inline bool osal_semaphore_wait(osal_semaphore_t sem_hdl, uint32_t msec) {
+  struct timespec deadline;
+  if (msec != OSAL_TIMEOUT_WAIT_FOREVER) _osal_posix_deadline(&deadline, CLOCK_MONOTONIC, msec);
+
+  pthread_mutex_lock(&sem_hdl->mutex);
+  bool timeout = false;
+  while (sem_hdl->count == 0 && !timeout) {
+    timeout = !_osal_posix_cond_wait(&sem_hdl->cond, &sem_hdl->mutex,
+                                     (msec != OSAL_TIMEOUT_WAIT_FOREVER) ? &deadline : NULL);
+  }
+
+  bool const acquired = (sem_hdl->count > 0);
+  if (acquired) sem_hdl->count--;
+  pthread_mutex_unlock(&sem_hdl->mutex);
+
+  return acquired;
+}
+
+TU_ATTR_ALWAYS_INLINE static inline void osal_semaphore_reset(osal_semaphore_t const sem_hdl) {
+  pthread_mutex_lock(&sem_hdl->mutex);
+  sem_hdl->count = 0;
+  pthread_mutex_unlock(&sem_hdl->mutex);
+}
+
+//--------------------------------------------------------------------+
+// MUTEX API
+//--------------------------------------------------------------------+
+typedef pthread_mutex_t osal_mutex_def_t;
+typedef pthread_mutex_t* osal_mutex_t;
+
+TU_ATTR_ALWAYS_INLINE static inline osal_mutex_t osal_mutex_create(osal_mutex_def_t* mdef) {
+  pthread_mutex_init(mdef, NULL);
+  return mdef;
+}
+
+TU_ATTR_ALWAYS_INLINE static inline bool osal_mutex_delete(osal_mutex_t mutex_hdl) {
+  return pthread_mutex_destroy(mutex_hdl) == 0;
+}
+
+TU_ATTR_ALWAYS_INLINE static inline bool osal_mutex_lock(osal_mutex_t mutex_hdl, uint32_t msec) {
+  if (msec == OSAL_TIMEOUT_WAIT_FOREVER) return pthread_mutex_lock(mutex_hdl) == 0;
+  if (msec == 0) return pthread_mutex_trylock(mutex_hdl) == 0;
+
+#if defined(__APPLE__)
+  // no pthread_mutex_timedlock(), poll instead
+  for (uint32_t i = 0; i < msec; i++) {
+    if (pthread_mutex_trylock(mutex_hdl) == 0) return true;
+    osal_task_delay(1);
+  }
+  return pthread_mutex_trylock(mutex_hdl) == 0;
+#else
+  // timedlock is on realtime clock
+  struct timespec deadline;
+  _osal_posix_deadline(&deadline, CLOCK_REALTIME, msec);
+  return pthread_mutex_timedlock(mutex_hdl, &deadline) == 0;
+#endif
+}
+
+TU_ATTR_ALWAYS_INLINE static inline bool osal_mutex_unlock(osal_mutex_t mutex_hdl) {
+  return pthread_mutex_unlock(mutex_hdl) == 0;
+}
+
+//--------------------------------------------------------------------+
+// QUEUE API
+//--------------------------------------------------------------------+
+
+// role device/host is used by OS NONE for mutex (disable usb isr) only
+#define OSAL_QUEUE_DEF(_int_set, _name, _depth, _type) \
+  static _type _name##_##buf[_depth];                  \
+  osal_queue_def_t _name = { .depth = _depth, .item_sz = sizeof(_type), .buf = _name##_##buf }
+
+typedef struct {
+  uint16_t depth;
+  uint16_t item_sz;
+  void*    buf;
+
+  pthread_mutex_t mutex;
+  pthread_cond_t  cond; // signaled when item is added
+  uint16_t        rd_idx;
+  uint16_t        count;
+} osal_queue_def_t;
+
+typedef osal_queue_def_t* osal_queue_t;
+
+TU_ATTR_ALWAYS_INLINE static inline osal_queue_t osal_queue_create(osal_queue_def_t* qdef) {
+  pthread_mutex_init(&qdef->mutex, NULL);
+  _osal_posix_cond_init(&qdef->cond);
+  qdef->rd_idx = 0;
+  qdef->count  = 0;
+  return qdef;
+}
+
+TU_ATTR_ALWAYS_INLINE static inline bool osal_queue_delete(osal_queue_t qhdl) {
+  pthread_cond_destroy(&qhdl->cond);
+  return pthread_mutex_destroy(&qhdl->mutex) == 0;
+}
+
+TU_ATTR_ALWAYS_INLINE static inline bool osal_queue_receive(osal_queue_t qhdl, void* data, uint32_t msec) {
+  struct timespec deadline;
+  if (msec != OSAL_TIMEOUT_WAIT_FOREVER) _osal_posix_deadline(&deadline, CLOCK_MONOTONIC, msec);
+
+  pthread_mutex_lock(&qhdl->mutex);
+  bool timeout = false;
+  while (qhdl->count == 0 && !timeout) {
+    timeout = !_osal_posix_cond_wait(&qhdl->cond, &qhdl->mutex, (msec != OSAL_TIMEOUT_WAIT_FOREVER) ? &deadline : NULL);
+  }
+
+  bool const received = (qhdl->count > 0);
+  if (received) {
+    memcpy(data, (uint8_t const*) qhdl->buf + qhdl->rd_idx * qhdl->item_sz, qhdl->item_sz);
+    qhdl->rd_idx = (uint16_t) ((qhdl->rd_idx + 1) % qhdl->depth);
+    qhdl->count--;
+  }
+  pthread_mutex_unlock(&qhdl->mutex);
+
+  return received;
+}
+
+// Never blocks (same as sending from ISR), return false if queue is full
+TU_ATTR_ALWAYS_INLINE static inline bool osal_queue_send(osal_queue_t qhdl, void const* data, bool in_isr) {
+  (void) in_isr;
+  pthread_mutex_lock(&qhdl->mutex);
+
+  bool const full = (qhdl->count == qhdl->depth);
+  if (!full) {
+    uint16_t const wr_idx = (uint16_t) ((qhdl->rd_idx + qhdl->count) % qhdl->depth);
+    memcpy((uint8_t*) qhdl->buf + wr_idx * qhdl->item_sz, data, qhdl->item_sz);
+    qhdl->count++;
+    pthread_cond_signal(&qhdl->cond);
+  }
+
+  pthread_mutex_unlock(&qhdl->mutex);
+  return !full;
+}
+
+TU_ATTR_ALWAYS_INLINE static inline bool osal_queue_empty(osal_queue_t qhdl) {
+  pthread_mutex_lock(&qhdl->mutex);
+  bool const empty = (qhdl->count == 0);
+  pthread_mutex_unlock(&qhdl->mutex);
+  return empty;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
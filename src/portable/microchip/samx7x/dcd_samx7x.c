@@ -661,6 +661,14 @@ bool dcd_edpt_xfer (uint8_t rhport, uint8_t ep_addr, uint8_t * buffer, uint16_t
   return true;
 }
 
+// Limit fifo linear and wrapped part to the requested bytes. DMA buffer length field is 16-bit while
+// fifo lengths are 32-bit with CFG_TUSB_FIFO_WIDE_INDEX
+static void fifo_info_limit(tu_fifo_buffer_info_t* info, uint16_t total_bytes)
+{
+  info->len_lin  = (tu_fifo_size_t) tu_min32(info->len_lin, total_bytes);
+  info->len_wrap = (tu_fifo_size_t) tu_min32(info->len_wrap, (uint32_t) (total_bytes - info->len_lin));
+}
+
 // The number of bytes has to be given explicitly to allow more flexible control of how many
 // bytes should be written and second to keep the return value free to give back a boolean
 // success message. If total_bytes is too big, the FIFO will copy only what is available
@@ -688,10 +696,12 @@ bool dcd_edpt_xfer_fifo (uint8_t rhport, uint8_t ep_addr, tu_fifo_t * ff, uint16
     if (dir == TUSB_DIR_OUT)
     {
       tu_fifo_get_write_info(ff, &info);
+      fifo_info_limit(&info, total_bytes);
       udd_dma_ctrl_lin |= DEVDMACONTROL_END_TR_IT | DEVDMACONTROL_END_TR_EN;
       udd_dma_ctrl_wrap |= DEVDMACONTROL_END_TR_IT | DEVDMACONTROL_END_TR_EN;
     } else {
       tu_fifo_get_read_info(ff, &info);
+      fifo_info_limit(&info, total_bytes);
       if(info.len_wrap == 0)
       {
         udd_dma_ctrl_lin |= DEVDMACONTROL_END_B_EN;
@@ -0,0 +1,182 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Ha Thach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * This file is part of the TinyUSB stack.
+ */
+
+#include "tusb_option.h"
+
+#if defined(TUP_USBIP_SIM) && CFG_TUD_ENABLED && CFG_TUH_ENABLED
+
+#include "device/dcd.h"
+#include "sim_bus.h"
+
+//--------------------------------------------------------------------+
+// Controller API
+//--------------------------------------------------------------------+
+
+void dcd_init(uint8_t rhport) {
+  _sim_bus.dev_rhport    = rhport;
+  _sim_bus.dev_inited    = true;
+  _sim_bus.dev_connected = true;
+  _sim_bus.sof_enabled   = false;
+  sim_bus_device_reset();
+}
+
+bool dcd_deinit(uint8_t rhport) {
+  (void) rhport;
+  _sim_bus.dev_inited = false;
+  return true;
+}
+
+// There is no interrupt, servicing the bus is the closest equivalent
+void dcd_int_handler(uint8_t rhport) {
+  (void) rhport;
+  sim_bus_task();
+}
+
+void dcd_int_enable(uint8_t rhport) {
+  (void) rhport;
+  sim_bus_int_mask(false, false);
+}
+
+void dcd_int_disable(uint8_t rhport) {
+  (void) rhport;
+  sim_bus_int_mask(false, true);
+}
+
+// Receive Set Address request, mcu port must also include status IN response
+void dcd_set_address(uint8_t rhport, uint8_t dev_addr) {
+  // address is changed after status stage complete
+  _sim_bus.addr_pending = true;
+  _sim_bus.new_addr     = dev_addr;
+  dcd_edpt_xfer(rhport, 0x80, NULL, 0);
+}
+
+void dcd_remote_wakeup(uint8_t rhport) {
+  (void) rhport;
+  _sim_bus.wakeup_pending = true;
+}
+
+void dcd_connect(uint8_t rhport) {
+  (void) rhport;
+  _sim_bus.dev_connected = true;
+}
+
+void dcd_disconnect(uint8_t rhport) {
+  (void) rhport;
+  _sim_bus.dev_connected = false;
+}
+
+void dcd_sof_enable(uint8_t rhport, bool en) {
+  (void) rhport;
+  _sim_bus.sof_enabled = en;
+  _sim_bus.sof_frame   = _sim_bus.frame;
+}
+
+//--------------------------------------------------------------------+
+// Endpoint API
+//--------------------------------------------------------------------+
+
+bool dcd_edpt_open(uint8_t rhport, tusb_desc_endpoint_t const * ep_desc) {
+  (void) rhport;
+
+  uint8_t const epnum = tu_edpt_number(ep_desc->bEndpointAddress);
+  uint8_t const dir   = tu_edpt_dir(ep_desc->bEndpointAddress);
+  TU_ASSERT(epnum < TUP_DCD_ENDPOINT_MAX);
+
+  sim_edpt_t* ep = &_sim_bus.dev_ep[epnum][dir];
+  tu_memclr(ep, sizeof(sim_edpt_t));
+  ep->mps    = tu_edpt_packet_size(ep_desc);
+  ep->opened = true;
+
+  return true;
+}
+
+void dcd_edpt_close(uint8_t rhport, uint8_t ep_addr) {
+  (void) rhport;
+
+  uint8_t const epnum = tu_edpt_number(ep_addr);
+  uint8_t const dir   = tu_edpt_dir(ep_addr);
+  tu_memclr(&_sim_bus.dev_ep[epnum][dir], sizeof(sim_edpt_t));
+}
+
+void dcd_edpt_close_all(uint8_t rhport) {
+  (void) rhport;
+
+  for (uint8_t epnum = 1; epnum < TUP_DCD_ENDPOINT_MAX; epnum++) {
+    tu_memclr(_sim_bus.dev_ep[epnum], sizeof(_sim_bus.dev_ep[epnum]));
+  }
+}
+
+bool dcd_edpt_xfer(uint8_t rhport, uint8_t ep_addr, uint8_t * buffer, uint16_t total_bytes) {
+  (void) rhport;
+
+  uint8_t const epnum = tu_edpt_number(ep_addr);
+  uint8_t const dir   = tu_edpt_dir(ep_addr);
+  sim_xfer_t* xfer = &_sim_bus.dev_ep[epnum][dir].xfer;
+  TU_VERIFY(!xfer->active);
+
+  xfer->buffer     = buffer;
+  xfer->ff         = NULL;
+  xfer->total_len  = total_bytes;
+  xfer->actual_len = 0;
+  xfer->active     = true;
+
+  return true;
+}
+
+bool dcd_edpt_xfer_fifo(uint8_t rhport, uint8_t ep_addr, tu_fifo_t * ff, uint16_t total_bytes) {
+  (void) rhport;
+
+  uint8_t const epnum = tu_edpt_number(ep_addr);
+  uint8_t const dir   = tu_edpt_dir(ep_addr);
+  sim_xfer_t* xfer = &_sim_bus.dev_ep[epnum][dir].xfer;
+  TU_VERIFY(!xfer->active);
+
+  xfer->buffer     = NULL;
+  xfer->ff         = ff;
+  xfer->total_len  = total_bytes;
+  xfer->actual_len = 0;
+  xfer->active     = true;
+
+  return true;
+}
+
+// Stall endpoint, any queuing transfer is removed
+void dcd_edpt_stall(uint8_t rhport, uint8_t ep_addr) {
+  (void) rhport;
+
+  sim_edpt_t* ep = &_sim_bus.dev_ep[tu_edpt_number(ep_addr)][tu_edpt_dir(ep_addr)];
+  ep->stalled     = true;
+  ep->xfer.active = false;
+}
+
+void dcd_edpt_clear_stall(uint8_t rhport, uint8_t ep_addr) {
+  (void) rhport;
+
+  sim_edpt_t* ep = &_sim_bus.dev_ep[tu_edpt_number(ep_addr)][tu_edpt_dir(ep_addr)];
+  ep->stalled = false;
+}
+
+#endif
@@ -0,0 +1,183 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Ha Thach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * This file is part of the TinyUSB stack.
+ */
+
+#include "tusb_option.h"
+
+#if defined(TUP_USBIP_SIM) && CFG_TUD_ENABLED && CFG_TUH_ENABLED
+
+#include "host/hcd.h"
+#include "sim_bus.h"
+
+//--------------------------------------------------------------------+
+// Controller API
+//--------------------------------------------------------------------+
+
+bool hcd_configure(uint8_t rhport, uint32_t cfg_id, const void* cfg_param) {
+  (void) rhport;
+  (void) cfg_id;
+  (void) cfg_param;
+
+  return false;
+}
+
+bool hcd_init(uint8_t rhport) {
+  _sim_bus.host_rhport   = rhport;
+  _sim_bus.host_inited   = true;
+  _sim_bus.host_attached = false;
+  tu_memclr(_sim_bus.host_ep, sizeof(_sim_bus.host_ep));
+
+  return true;
+}
+
+bool hcd_deinit(uint8_t rhport) {
+  (void) rhport;
+  _sim_bus.host_inited = false;
+
+  return true;
+}
+
+// There is no interrupt, servicing the bus is the closest equivalent
+void hcd_int_handler(uint8_t rhport, bool in_isr) {
+  (void) rhport;
+  (void) in_isr;
+  sim_bus_task();
+}
+
+void hcd_int_enable(uint8_t rhport) {
+  (void) rhport;
+  sim_bus_int_mask(true, false);
+}
+
+void hcd_int_disable(uint8_t rhport) {
+  (void) rhport;
+  sim_bus_int_mask(true, true);
+}
+
+// Each query consumes one virtual frame, see sim_bus.h
+uint32_t hcd_frame_number(uint8_t rhport) {
+  (void) rhport;
+  return _sim_bus.frame++;
+}
+
+//--------------------------------------------------------------------+
+// Port API
+//--------------------------------------------------------------------+
+
+bool hcd_port_connect_status(uint8_t rhport) {
+  (void) rhport;
+  return sim_bus_connected();
+}
+
+// Reset is signaled to device on next sim_bus_task()
+void hcd_port_reset(uint8_t rhport) {
+  (void) rhport;
+  _sim_bus.reset_pending = true;
+}
+
+void hcd_port_reset_end(uint8_t rhport) {
+  (void) rhport;
+}
+
+tusb_speed_t hcd_port_speed_get(uint8_t rhport) {
+  (void) rhport;
+  return sim_bus_speed();
+}
+
+void hcd_device_close(uint8_t rhport, uint8_t dev_addr) {
+  (void) rhport;
+
+  for (uint8_t epnum = 0; epnum < TUP_DCD_ENDPOINT_MAX; epnum++) {
+    for (uint8_t dir = 0; dir < 2; dir++) {
+      sim_xfer_t* xfer = &_sim_bus.host_ep[epnum][dir];
+      if (xfer->daddr == dev_addr) xfer->active = false;
+    }
+  }
+}
+
+//--------------------------------------------------------------------+
+// Endpoints API
+//--------------------------------------------------------------------+
+
+// Packet size is decided by device endpoint, nothing to configure on host side
+bool hcd_edpt_open(uint8_t rhport, uint8_t dev_addr, tusb_desc_endpoint_t const * ep_desc) {
+  (void) rhport;
+  (void) dev_addr;
+
+  TU_VERIFY(tu_edpt_number(ep_desc->bEndpointAddress) < TUP_DCD_ENDPOINT_MAX);
+  return true;
+}
+
+bool hcd_edpt_xfer(uint8_t rhport, uint8_t dev_addr, uint8_t ep_addr, uint8_t * buffer, uint16_t buflen) {
+  (void) rhport;
+
+  uint8_t const epnum = tu_edpt_number(ep_addr);
+  uint8_t const dir   = tu_edpt_dir(ep_addr);
+  TU_VERIFY(epnum < TUP_DCD_ENDPOINT_MAX);
+
+  sim_xfer_t* xfer = &_sim_bus.host_ep[epnum][dir];
+  TU_VERIFY(!xfer->active);
+
+  xfer->buffer     = buffer;
+  xfer->ff         = NULL;
+  xfer->total_len  = buflen;
+  xfer->actual_len = 0;
+  xfer->daddr      = dev_addr;
+  xfer->active     = true;
+
+  return true;
+}
+
+bool hcd_edpt_abort_xfer(uint8_t rhport, uint8_t dev_addr, uint8_t ep_addr) {
+  (void) rhport;
+
+  sim_xfer_t* xfer = &_sim_bus.host_ep[tu_edpt_number(ep_addr)][tu_edpt_dir(ep_addr)];
+  TU_VERIFY(xfer->active && xfer->daddr == dev_addr);
+  xfer->active = false;
+
+  return true;
+}
+
+bool hcd_setup_send(uint8_t rhport, uint8_t dev_addr, uint8_t const setup_packet[8]) {
+  (void) rhport;
+  TU_VERIFY(!_sim_bus.setup_pending);
+
+  memcpy(_sim_bus.setup_packet, setup_packet, 8);
+  _sim_bus.setup_daddr   = dev_addr;
+  _sim_bus.setup_pending = true;
+
+  return true;
+}
+
+// Device side stall is cleared by the Clear Feature request, there is no data toggle to reset
+bool hcd_edpt_clear_stall(uint8_t rhport, uint8_t dev_addr, uint8_t ep_addr) {
+  (void) rhport;
+  (void) dev_addr;
+  (void) ep_addr;
+
+  return true;
+}
+
+#endif
@@ -0,0 +1,339 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Ha Thach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * This file is part of the TinyUSB stack.
+ */
+
+#include "tusb_option.h"
+
+#if defined(TUP_USBIP_SIM) && CFG_TUD_ENABLED && CFG_TUH_ENABLED
+
+#include "device/dcd.h"
+#include "host/hcd.h"
+#include "tusb.h"
+#include "sim_bus.h"
+
+//--------------------------------------------------------------------+
+// MACRO TYPEDEF CONSTANT ENUM DECLARATION
+//--------------------------------------------------------------------+
+
+sim_bus_t _sim_bus = {
+  .plugged = true
+};
+
+// interrupt masking of device [0] and host [1] port
+static struct {
+  bool     masked;
+  uint32_t start;
+  sim_int_mask_stats_t stats;
+} _int_mask[2];
+
+//--------------------------------------------------------------------+
+// Helper
+//--------------------------------------------------------------------+
+
+// Copy a packet between device transfer and host buffer, host transfer is always a linear buffer
+static void packet_copy(sim_xfer_t* dev_xfer, sim_xfer_t* host_xfer, uint8_t dir, uint16_t n) {
+  if (n == 0) return;
+
+  uint8_t* host_buf = host_xfer->buffer + host_xfer->actual_len;
+
+  if (dev_xfer->ff) {
+    if (dir == TUSB_DIR_IN) {
+      tu_fifo_read_n(dev_xfer->ff, host_buf, n);
+    } else {
+      tu_fifo_write_n(dev_xfer->ff, host_buf, n);
+    }
+  } else {
+    uint8_t* dev_buf = dev_xfer->buffer + dev_xfer->actual_len;
+    if (dir == TUSB_DIR_IN) {
+      memcpy(host_buf, dev_buf, n);
+    } else {
+      memcpy(dev_buf, host_buf, n);
+    }
+  }
+
+  dev_xfer->actual_len  += n;
+  host_xfer->actual_len += n;
+}
+
+static void device_xfer_complete(uint8_t ep_addr) {
+  uint8_t const epnum = tu_edpt_number(ep_addr);
+  uint8_t const dir   = tu_edpt_dir(ep_addr);
+  sim_xfer_t* xfer = &_sim_bus.dev_ep[epnum][dir].xfer;
+
+  xfer->active = false;
+
+  // new address takes effect after status stage of Set Address
+  if (ep_addr == 0x80 && _sim_bus.addr_pending) {
+    _sim_bus.addr_pending = false;
+    _sim_bus.dev_addr = _sim_bus.new_addr;
+  }
+
+  dcd_event_xfer_complete(_sim_bus.dev_rhport, ep_addr, xfer->actual_len, XFER_RESULT_SUCCESS, true);
+}
+
+static void host_xfer_complete(uint8_t ep_addr, xfer_result_t result) {
+  uint8_t const epnum = tu_edpt_number(ep_addr);
+  uint8_t const dir   = tu_edpt_dir(ep_addr);
+  sim_xfer_t* xfer = &_sim_bus.host_ep[epnum][dir];
+
+  xfer->active = false;
+  hcd_event_xfer_complete(xfer->daddr, ep_addr, xfer->actual_len, result, true);
+}
+
+static void xfer_cancel(sim_xfer_t* xfer) {
+  xfer->active = false;
+}
+
+//--------------------------------------------------------------------+
+// Bus
+//--------------------------------------------------------------------+
+
+void sim_bus_device_reset(void) {
+  _sim_bus.dev_addr     = 0;
+  _sim_bus.addr_pending = false;
+
+  for (uint8_t epnum = 0; epnum < TUP_DCD_ENDPOINT_MAX; epnum++) {
+    for (uint8_t dir = 0; dir < 2; dir++) {
+      sim_edpt_t* ep = &_sim_bus.dev_ep[epnum][dir];
+      xfer_cancel(&ep->xfer);
+      ep->stalled = false;
+      ep->opened  = (epnum == 0);
+      ep->mps     = (epnum == 0) ? CFG_TUD_ENDPOINT0_SIZE : 0;
+    }
+  }
+}
+
+// Attach/detach, bus reset, remote wakeup and SOF
+static bool port_task(void) {
+  bool progress = false;
+  bool const connected = sim_bus_connected();
+
+  if (connected != _sim_bus.attached) {
+    _sim_bus.attached = connected;
+
+    if (!connected) {
+      _sim_bus.reset_pending  = false;
+      _sim_bus.wakeup_pending = false;
+      _sim_bus.setup_pending  = false;
+
+      for (uint8_t epnum = 0; epnum < TUP_DCD_ENDPOINT_MAX; epnum++) {
+        xfer_cancel(&_sim_bus.host_ep[epnum][0]);
+        xfer_cancel(&_sim_bus.host_ep[epnum][1]);
+      }
+
+      sim_bus_device_reset();
+      if (_sim_bus.dev_inited) {
+        dcd_event_bus_signal(_sim_bus.dev_rhport, DCD_EVENT_UNPLUGGED, true);
+        progress = true;
+      }
+    }
+  }
+
+  if (_sim_bus.host_inited && connected != _sim_bus.host_attached) {
+    _sim_bus.host_attached = connected;
+
+    if (connected) {
+      hcd_event_device_attach(_sim_bus.host_rhport, true);
+    } else {
+      hcd_event_device_remove(_sim_bus.host_rhport, true);
+    }
+    progress = true;
+  }
+
+  if (!connected) return progress;
+
+  if (_sim_bus.reset_pending) {
+    _sim_bus.reset_pending = false;
+    sim_bus_device_reset();
+    dcd_event_bus_reset(_sim_bus.dev_rhport, sim_bus_speed(), true);
+    progress = true;
+  }
+
+  if (_sim_bus.wakeup_pending) {
+    _sim_bus.wakeup_pending = false;
+    dcd_event_bus_signal(_sim_bus.dev_rhport, DCD_EVENT_RESUME, true);
+    progress = true;
+  }
+
+  if (_sim_bus.sof_enabled && _sim_bus.sof_frame != _sim_bus.frame) {
+    _sim_bus.sof_frame = _sim_bus.frame;
+    dcd_event_sof(_sim_bus.dev_rhport, _sim_bus.frame, true);
+    progress = true;
+  }
+
+  return progress;
+}
+
+static bool setup_task(void) {
+  if (!_sim_bus.setup_pending) return false;
+  _sim_bus.setup_pending = false;
+
+  sim_xfer_t* host_xfer = &_sim_bus.host_ep[0][TUSB_DIR_OUT];
+  host_xfer->daddr      = _sim_bus.setup_daddr;
+  host_xfer->actual_len = 0;
+
+  if (_sim_bus.setup_daddr != _sim_bus.dev_addr) {
+    // no device responds to this address
+    host_xfer_complete(0x00, XFER_RESULT_FAILED);
+    return true;
+  }
+
+  // SETUP always get ACKed, it also aborts any on-going control transfer and clears EP0 stall
+  for (uint8_t dir = 0; dir < 2; dir++) {
+    sim_edpt_t* ep0 = &_sim_bus.dev_ep[0][dir];
+    xfer_cancel(&ep0->xfer);
+    ep0->stalled = false;
+  }
+
+  dcd_event_setup_received(_sim_bus.dev_rhport, _sim_bus.setup_packet, true);
+
+  host_xfer->actual_len = 8;
+  host_xfer_complete(0x00, XFER_RESULT_SUCCESS);
+
+  return true;
+}
+
+// Carry out data packets between a host transfer and the device endpoint with the same address
+// until either side completes. Return false if device NAKs.
+static bool edpt_task(uint8_t epnum, uint8_t dir) {
+  sim_xfer_t* host_xfer = &_sim_bus.host_ep[epnum][dir];
+  if (!host_xfer->active) return false;
+
+  uint8_t const ep_addr = tu_edpt_addr(epnum, dir);
+
+  if (host_xfer->daddr != _sim_bus.dev_addr) {
+    // no device responds to this address
+    host_xfer_complete(ep_addr, XFER_RESULT_FAILED);
+    return true;
+  }
+
+  sim_edpt_t* ep = &_sim_bus.dev_ep[epnum][dir];
+  sim_xfer_t* dev_xfer = &ep->xfer;
+
+  if (ep->stalled) {
+    host_xfer_complete(ep_addr, XFER_RESULT_STALLED);
+    return true;
+  }
+
+  if (!ep->opened || !dev_xfer->active) return false; // NAK
+
+  uint16_t const mps = ep->mps;
+  sim_xfer_t* tx = (dir == TUSB_DIR_IN) ? dev_xfer : host_xfer;
+  sim_xfer_t* rx = (dir == TUSB_DIR_IN) ? host_xfer : dev_xfer;
+
+  while (1) {
+    bool tx_done = false;
+    bool rx_done = false;
+
+    while (!tx_done && !rx_done) {
+      uint16_t const tx_remain = tx->total_len - tx->actual_len;
+      uint16_t const rx_remain = rx->total_len - rx->actual_len;
+
+      // a packet larger than receiver's remaining space is truncated (babble)
+      uint16_t const count = tu_min16(tu_min16(mps, tx_remain), rx_remain);
+      bool const short_packet = (count < mps);
+
+      packet_copy(dev_xfer, host_xfer, dir, count);
+
+      // transmitter completes when all data is sent, receiver completes when it gets a short packet
+      // or buffer is full
+      tx_done = (tx->actual_len == tx->total_len);
+      rx_done = short_packet || (rx->actual_len == rx->total_len);
+    }
+
+    bool const dev_done = (dir == TUSB_DIR_IN) ? tx_done : rx_done;
+    bool const host_done = (dir == TUSB_DIR_IN) ? rx_done : tx_done;
+
+    if (dev_xfer->active && dev_done) {
+      device_xfer_complete(ep_addr);
+    }
+
+    if (host_done) {
+      host_xfer_complete(ep_addr, XFER_RESULT_SUCCESS);
+      break;
+    }
+
+    // Device transfer is complete but host wants more: continue right away if the next transfer is
+    // already armed (e.g queued by usbd in event handler), otherwise NAK until device task re-arms
+    if (!dev_xfer->active || ep->stalled) break;
+  }
+
+  return true;
+}
+
+//--------------------------------------------------------------------+
+// Harness API
+//--------------------------------------------------------------------+
+
+bool sim_bus_task(void) {
+  bool progress = port_task();
+
+  if (_sim_bus.host_attached) {
+    progress |= setup_task();
+
+    for (uint8_t epnum = 0; epnum < TUP_DCD_ENDPOINT_MAX; epnum++) {
+      for (uint8_t dir = 0; dir < 2; dir++) {
+        progress |= edpt_task(epnum, dir);
+      }
+    }
+  }
+
+  return progress;
+}
+
+void sim_bus_plug(bool plugged) {
+  _sim_bus.plugged = plugged;
+}
+
+uint32_t sim_bus_frame_number(void) {
+  return _sim_bus.frame;
+}
+
+void sim_bus_frame_advance(uint32_t frames) {
+  _sim_bus.frame += frames;
+}
+
+void sim_bus_int_mask(bool host, bool masked) {
+  // disable/enable are not nested, repeated calls e.g from deinit are ignored
+  if (masked == _int_mask[host].masked) return;
+  _int_mask[host].masked = masked;
+
+  if (masked) {
+    _int_mask[host].start = tusb_timestamp_cb();
+  } else {
+    sim_int_mask_stats_t* stats = &_int_mask[host].stats;
+    uint32_t const elapsed = tusb_timestamp_cb() - _int_mask[host].start;
+    stats->count++;
+    stats->time += elapsed;
+    if (elapsed > stats->time_max) stats->time_max = elapsed;
+  }
+}
+
+void sim_bus_int_mask_stats(bool host, sim_int_mask_stats_t* stats, bool clear) {
+  *stats = _int_mask[host].stats;
+  if (clear) tu_varclr(&_int_mask[host].stats);
+}
+
+#endif
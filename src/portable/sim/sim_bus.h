@@ -0,0 +1,150 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Ha Thach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * This file is part of the TinyUSB stack.
+ */
+
+#ifndef TUSB_SIM_BUS_H_
+#define TUSB_SIM_BUS_H_
+
+#include "common/tusb_common.h"
+#include "common/tusb_fifo.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Software loopback controller (CFG_TUSB_MCU = OPT_MCU_SIM)
+ *
+ * dcd_sim.c and hcd_sim.c implement the device and host controller API on top of a shared in-memory
+ * bus, the device port is always wired to the host port. This allows a single process to run both
+ * tud_task() and tuh_task() against each other with real enumeration, e.g for benchmark on a build server.
+ *
+ * There is no interrupt: the harness calls sim_bus_task() (or dcd_int_handler()/hcd_int_handler())
+ * to let the bus carry out all pending transactions, which then post events to both stacks.
+ * Bus, tud_task() and tuh_task() must run in the same thread.
+ *
+ * Virtual time does not advance on its own. Each hcd_frame_number() query consumes one frame so that
+ * the busy-wait osal_task_delay() of OPT_OS_NONE completes immediately. SOF is reported to the device
+ * (when enabled) once per sim_bus_task() if the frame number has changed.
+ */
+
+//--------------------------------------------------------------------+
+// Harness API
+//--------------------------------------------------------------------+
+
+// Carry out all transactions that can make progress. Return true if any event is posted to
+// either stack i.e caller should run tud_task()/tuh_task() then call this again.
+bool sim_bus_task(void);
+
+// Plug/Unplug the cable between device and host port. Cable is plugged by default
+void sim_bus_plug(bool plugged);
+
+// Current virtual frame number (1ms)
+uint32_t sim_bus_frame_number(void);
+
+// Advance virtual time
+void sim_bus_frame_advance(uint32_t frames);
+
+// Interrupt masking of a port i.e from dcd/hcd_int_disable() to dcd/hcd_int_enable(), time is in unit of
+// tusb_timestamp_cb(). There is no real interrupt, this measures how long a MCU port would have it masked
+typedef struct {
+  uint32_t count;    // number of masked sections
+  uint64_t time;     // total time masked
+  uint32_t time_max; // longest masked section
+} sim_int_mask_stats_t;
+
+// Get masking statistics of device (host = false) or host port, then reset them if clear is true
+void sim_bus_int_mask_stats(bool host, sim_int_mask_stats_t* stats, bool clear);
+
+//--------------------------------------------------------------------+
+// Internal bus state shared by dcd_sim.c and hcd_sim.c
+//--------------------------------------------------------------------+
+
+typedef struct {
+  uint8_t*   buffer;
+  tu_fifo_t* ff;
+  uint16_t   total_len;
+  uint16_t   actual_len;
+  uint8_t    daddr;  // host transfer only
+  bool       active;
+} sim_xfer_t;
+
+typedef struct {
+  uint16_t   mps;
+  bool       opened;
+  bool       stalled;
+  sim_xfer_t xfer;
+} sim_edpt_t;
+
+typedef struct {
+  uint32_t frame;
+  uint32_t sof_frame; // last frame reported to device
+  bool     plugged;
+  bool     attached; // plugged and device pull-up enabled
+
+  //------------- Device port -------------//
+  uint8_t  dev_rhport;
+  bool     dev_inited;
+  bool     dev_connected; // pull-up enabled
+  bool     sof_enabled;
+  bool     wakeup_pending;
+  bool     addr_pending;
+  uint8_t  new_addr;
+  uint8_t  dev_addr;
+  sim_edpt_t dev_ep[TUP_DCD_ENDPOINT_MAX][2];
+
+  //------------- Host port -------------//
+  uint8_t  host_rhport;
+  bool     host_inited;
+  bool     host_attached; // connection state reported to host stack
+  bool     reset_pending;
+  bool     setup_pending;
+  uint8_t  setup_daddr;
+  uint8_t  setup_packet[8];
+  sim_xfer_t host_ep[TUP_DCD_ENDPOINT_MAX][2];
+} sim_bus_t;
+
+extern sim_bus_t _sim_bus;
+
+// Bus is active when the cable is plugged and the device enables its pull-up
+TU_ATTR_ALWAYS_INLINE static inline bool sim_bus_connected(void) {
+  return _sim_bus.plugged && _sim_bus.dev_inited && _sim_bus.dev_connected;
+}
+
+// Link speed negotiated between both ports
+TU_ATTR_ALWAYS_INLINE static inline tusb_speed_t sim_bus_speed(void) {
+  return (TUD_OPT_HIGH_SPEED && TUH_OPT_HIGH_SPEED) ? TUSB_SPEED_HIGH : TUSB_SPEED_FULL;
+}
+
+// Reset device side of the bus: address 0, close all non-control endpoints and cancel all transfers
+void sim_bus_device_reset(void);
+
+// Port interrupt is disabled (masked = true) or enabled, called by dcd/hcd_int_disable() and _enable()
+void sim_bus_int_mask(bool host, bool masked);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
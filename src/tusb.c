@@ -39,6 +39,10 @@
 #include "host/usbh_pvt.h"
 #endif
 
+#if CFG_TUSB_TRACE_RTT
+#include "SEGGER_RTT.h"
+#endif
+
 //--------------------------------------------------------------------+
 // Public API
 //--------------------------------------------------------------------+
@@ -57,6 +61,91 @@ bool tusb_init(void) {
   return true;
 }
 
+TU_ATTR_WEAK uint32_t tusb_timestamp_cb(void) {
+  return 0;
+}
+
+#if CFG_TUSB_OS == OPT_OS_NONE && CFG_TUSB_OS_NONE_WAIT
+TU_ATTR_WEAK void osal_none_wait_for_event(uint32_t msec) {
+  // Without a wake-up timer a finite timeout cannot be bounded: return and let caller poll again
+  if (msec != OSAL_TIMEOUT_WAIT_FOREVER) return;
+#if defined(__ARM_ARCH_PROFILE) && __ARM_ARCH_PROFILE == 'M'
+  // event register is set by any interrupt since the queue was checked, WFE then returns immediately
+  __asm volatile ("wfe");
+#endif
+}
+#endif
+
+//--------------------------------------------------------------------+
+// Trace
+//--------------------------------------------------------------------+
+#if CFG_TUSB_TRACE
+
+// Ring of latest records. Indexes are free-running, wr_idx is also visible to debugger for memory dump
+typedef struct {
+  volatile uint32_t wr_idx;
+  uint32_t rd_idx;
+  tu_trace_record_t records[CFG_TUSB_TRACE_SIZE];
+} tu_trace_ring_t;
+
+tu_static tu_trace_ring_t _tusb_trace;
+
+TU_ATTR_FAST_FUNC void tu_trace_write(uint8_t id, uint8_t arg0, uint16_t arg1, uint32_t arg2, uint32_t arg3) {
+  uint32_t const idx = _tusb_trace.wr_idx++;
+  tu_trace_record_t* rec = &_tusb_trace.records[idx & (CFG_TUSB_TRACE_SIZE - 1)];
+
+  rec->time = tusb_timestamp_cb();
+  rec->id   = id;
+  rec->arg0 = arg0;
+  rec->arg1 = arg1;
+  rec->arg2 = arg2;
+  rec->arg3 = arg3;
+}
+
+uint32_t tusb_trace_read(tu_trace_record_t* records, uint32_t count) {
+  TU_VERIFY(records && count, 0);
+
+  uint32_t const wr_idx = _tusb_trace.wr_idx;
+  uint32_t n = 0;
+
+  // writer lapped reader: oldest records are gone, report how many
+  uint32_t const pending = wr_idx - _tusb_trace.rd_idx;
+  if (pending > CFG_TUSB_TRACE_SIZE) {
+    uint32_t const lost = pending - CFG_TUSB_TRACE_SIZE;
+    records[n++] = (tu_trace_record_t) { .time = tusb_timestamp_cb(), .id = TU_TRACE_LOST, .arg2 = lost };
+    _tusb_trace.rd_idx += lost;
+  }
+
+  while (n < count && _tusb_trace.rd_idx != wr_idx) {
+    records[n++] = _tusb_trace.records[_tusb_trace.rd_idx & (CFG_TUSB_TRACE_SIZE - 1)];
+    _tusb_trace.rd_idx++;
+  }
+
+  return n;
+}
+
+#if CFG_TUSB_TRACE_RTT
+void tusb_trace_flush(void) {
+  tu_static bool configured = false;
+  tu_static uint8_t rtt_buf[CFG_TUSB_TRACE_RTT_BUFSIZE];
+
+  if (!configured) {
+    SEGGER_RTT_ConfigUpBuffer(CFG_TUSB_TRACE_RTT_CHANNEL, "tusb_trace", rtt_buf, sizeof(rtt_buf),
+                              SEGGER_RTT_MODE_NO_BLOCK_SKIP);
+    configured = true;
+  }
+
+  tu_trace_record_t records[8];
+  uint32_t count;
+  while ((count = tusb_trace_read(records, TU_ARRAY_SIZE(records))) > 0) {
+    // channel is full: host is not reading, records are dropped
+    if (0 == SEGGER_RTT_Write(CFG_TUSB_TRACE_RTT_CHANNEL, records, count * sizeof(tu_trace_record_t))) break;
+  }
+}
+#endif
+
+#endif
+
 bool tusb_inited(void) {
   bool ret = false;
 
@@ -210,12 +299,50 @@ uint16_t tu_desc_get_interface_total_len(tusb_desc_interface_t const* desc_itf,
   return len;
 }
 
+//--------------------------------------------------------------------+
+// Deferred function call queue for both Host and Device stack
+//--------------------------------------------------------------------+
+
+bool tu_defer_push(tu_defer_queue_t* dq, osal_task_func_t func, void* param, bool* wake) {
+  *wake = false;
+
+  // pending entries are few, linear scan is cheaper than anything indexed
+  for (uint8_t i = 0; i < dq->count; i++) {
+    tu_defer_call_t const* call = &dq->calls[(dq->rd_idx + i) % dq->depth];
+    if (call->func == func && call->param == param) return true;
+  }
+
+  TU_VERIFY(dq->count < dq->depth);
+
+  tu_defer_call_t* call = &dq->calls[(dq->rd_idx + dq->count) % dq->depth];
+  call->func = func;
+  call->param = param;
+  dq->count++;
+
+  if (!dq->armed) {
+    dq->armed = true;
+    *wake = true;
+  }
+
+  return true;
+}
+
+bool tu_defer_pop(tu_defer_queue_t* dq, tu_defer_call_t* call) {
+  TU_VERIFY(dq->count);
+
+  *call = dq->calls[dq->rd_idx];
+  dq->rd_idx = (uint8_t) ((dq->rd_idx + 1) % dq->depth);
+  dq->count--;
+
+  return true;
+}
+
 //--------------------------------------------------------------------+
 // Endpoint Stream Helper for both Host and Device stack
 //--------------------------------------------------------------------+
 
 bool tu_edpt_stream_init(tu_edpt_stream_t* s, bool is_host, bool is_tx, bool overwritable,
-                         void* ff_buf, uint16_t ff_bufsize, uint8_t* ep_buf, uint16_t ep_bufsize) {
+                         void* ff_buf, tu_fifo_size_t ff_bufsize, uint8_t* ep_buf, uint16_t ep_bufsize) {
   (void) is_tx;
 
   s->is_host = is_host;
@@ -301,7 +428,7 @@ uint32_t tu_edpt_stream_write_xfer(uint8_t hwid, tu_edpt_stream_t* s) {
   TU_VERIFY(stream_claim(hwid, s), 0);
 
   // Pull data from FIFO -> EP buf
-  uint16_t const count = tu_fifo_read_n(&s->ff, s->ep_buf, s->ep_bufsize);
+  uint16_t const count = (uint16_t) tu_fifo_read_n(&s->ff, s->ep_buf, s->ep_bufsize);
 
   if (count) {
     TU_ASSERT(stream_xfer(hwid, s, count), 0);
@@ -325,7 +452,7 @@ uint32_t tu_edpt_stream_write(uint8_t hwid, tu_edpt_stream_t* s, void const* buf
     TU_ASSERT(stream_xfer(hwid, s, (uint16_t) xact_len), 0);
     return xact_len;
   } else {
-    const uint16_t ret = tu_fifo_write_n(&s->ff, buffer, (uint16_t) bufsize);
+    const uint32_t ret = tu_fifo_write_n(&s->ff, buffer, (tu_fifo_size_t) tu_min32(bufsize, TU_FIFO_DEPTH_MAX));
 
     // flush if fifo has more than packet size or
     // in rare case: fifo depth is configured too small (which never reach packet size)
@@ -366,7 +493,7 @@ uint32_t tu_edpt_stream_read_xfer(uint8_t hwid, tu_edpt_stream_t* s) {
     return s->ep_bufsize;
   } else {
     const uint16_t mps = s->is_mps512 ? TUSB_EPSIZE_BULK_HS : TUSB_EPSIZE_BULK_FS;
-    uint16_t available = tu_fifo_remaining(&s->ff);
+    uint32_t available = tu_fifo_remaining(&s->ff);
 
     // Prepare for incoming data but only allow what we can store in the ring buffer.
     // TODO Actually we can still carry out the transfer, keeping count of received bytes
@@ -381,8 +508,7 @@ uint32_t tu_edpt_stream_read_xfer(uint8_t hwid, tu_edpt_stream_t* s) {
 
     if (available >= mps) {
       // multiple of packet size limit by ep bufsize
-      uint16_t count = (uint16_t) (available & ~(mps - 1));
-      count = tu_min16(count, s->ep_bufsize);
+      uint16_t const count = (uint16_t) tu_min32(available & ~(mps - 1u), s->ep_bufsize);
       TU_ASSERT(stream_xfer(hwid, s, count), 0);
       return count;
     } else {
@@ -394,7 +520,7 @@ uint32_t tu_edpt_stream_read_xfer(uint8_t hwid, tu_edpt_stream_t* s) {
 }
 
 uint32_t tu_edpt_stream_read(uint8_t hwid, tu_edpt_stream_t* s, void* buffer, uint32_t bufsize) {
-  uint32_t num_read = tu_fifo_read_n(&s->ff, buffer, (uint16_t) bufsize);
+  uint32_t num_read = tu_fifo_read_n(&s->ff, buffer, (tu_fifo_size_t) tu_min32(bufsize, TU_FIFO_DEPTH_MAX));
   tu_edpt_stream_read_xfer(hwid, s);
   return num_read;
 }
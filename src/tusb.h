@@ -138,6 +138,21 @@ bool tusb_init(void);
 // Check if stack is initialized
 bool tusb_inited(void);
 
+// Free-running time stamp e.g cpu cycle counter, used by stats to measure class driver callbacks and by trace
+// records. Any unit and wrap around is fine. Default returns 0 i.e time is not measured
+uint32_t tusb_timestamp_cb(void);
+
+#if CFG_TUSB_TRACE
+// Copy up to count trace records not read yet, oldest first. Return number of records copied. If records are
+// overwritten before being read, first record copied is TU_TRACE_LOST
+uint32_t tusb_trace_read(tu_trace_record_t* records, uint32_t count);
+
+#if CFG_TUSB_TRACE_RTT
+// Drain unread trace records to RTT channel CFG_TUSB_TRACE_RTT_CHANNEL, call from idle loop
+void tusb_trace_flush(void);
+#endif
+#endif
+
 // TODO
 // bool tusb_teardown(void);
 
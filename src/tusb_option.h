@@ -194,6 +194,9 @@
 #define OPT_MCU_MAX32650         2402  ///< ADI MAX32650/1/2
 #define OPT_MCU_MAX78002         2403  ///< ADI MAX78002
 
+// Software
+#define OPT_MCU_SIM              9000  ///< In-process loopback controller for host simulation
+
 // Check if configured MCU is one of listed
 // Apply _TU_CHECK_MCU with || as separator to list of input
 #define _TU_CHECK_MCU(_m)    (CFG_TUSB_MCU == _m)
@@ -210,6 +213,16 @@
 #define OPT_OS_PICO       5  ///< Raspberry Pi Pico SDK
 #define OPT_OS_RTTHREAD   6  ///< RT-Thread
 #define OPT_OS_RTX4       7  ///< Keil RTX 4
+#define OPT_OS_POSIX      8  ///< POSIX threads e.g Linux, macOS
+
+//--------------------------------------------------------------------+
+// FIFO copy kernel
+//--------------------------------------------------------------------+
+
+#define OPT_FIFO_COPY_MEMCPY    0 ///< memcpy() from C library
+#define OPT_FIFO_COPY_WORD      1 ///< 32-bit word loop
+#define OPT_FIFO_COPY_UNROLLED  2 ///< 32-bit word loop unrolled by 4
+#define OPT_FIFO_COPY_SIMD      3 ///< 128-bit SSE2/NEON where available, unrolled word loop otherwise
 
 //--------------------------------------------------------------------+
 // Mode and Speed
@@ -335,6 +348,30 @@
   #define CFG_TUD_LOG_LEVEL   2
 #endif
 
+// Binary trace of usbd/usbh events into a RAM ring, decoded on host with tools/trace_decode.py.
+// Unlike CFG_TUSB_DEBUG it does not format text, cheap enough to be kept enabled
+#ifndef CFG_TUSB_TRACE
+  #define CFG_TUSB_TRACE 0
+#endif
+
+// Number of trace records in ring, must be power of 2
+#ifndef CFG_TUSB_TRACE_SIZE
+  #define CFG_TUSB_TRACE_SIZE 256
+#endif
+
+// Drain trace with tusb_trace_flush() to a SEGGER RTT up channel
+#ifndef CFG_TUSB_TRACE_RTT
+  #define CFG_TUSB_TRACE_RTT 0
+#endif
+
+#ifndef CFG_TUSB_TRACE_RTT_CHANNEL
+  #define CFG_TUSB_TRACE_RTT_CHANNEL 1
+#endif
+
+#ifndef CFG_TUSB_TRACE_RTT_BUFSIZE
+  #define CFG_TUSB_TRACE_RTT_BUFSIZE 1024
+#endif
+
 // Memory section for placing buffer used for usb transferring. If MEM_SECTION is different for
 // host and device use: CFG_TUD_MEM_SECTION, CFG_TUH_MEM_SECTION instead
 #ifndef CFG_TUSB_MEM_SECTION
@@ -356,6 +393,49 @@
   #define CFG_TUSB_OS_INC_PATH
 #endif
 
+// OPT_OS_NONE event queue is a single-producer single-consumer ring: ISR sends and task receives without
+// disabling USB interrupt. Set to 0 for the fifo queue locked by disabling USB interrupt e.g when more than
+// one ISR sends to the same queue
+#ifndef CFG_TUSB_OS_NONE_SPSC_QUEUE
+  #define CFG_TUSB_OS_NONE_SPSC_QUEUE 1
+#endif
+
+// OPT_OS_NONE honors timeout of tud_task_ext()/tuh_task_ext() like a RTOS: when there is no event, task sleeps
+// once in osal_none_wait_for_event() until an interrupt or timeout instead of returning immediately. Note
+// tud_task()/tuh_task() then sleep until next interrupt, main loop with other work should pass its own timeout.
+// Weak osal_none_wait_for_event() cannot bound a finite timeout and only sleeps when waiting forever, provide
+// one with a wake-up timer to also sleep on finite timeout
+#ifndef CFG_TUSB_OS_NONE_WAIT
+  #define CFG_TUSB_OS_NONE_WAIT 0
+#endif
+
+// Allow fifo to be written by multiple producers without mutex: slots are claimed and published
+// with GCC/Clang __atomic builtins. Must be enabled per fifo with tu_fifo_set_multi_producer(). Require an MCU
+// with atomic compare-and-swap e.g not Cortex-M0. Producers must not preempt each other (no ISR
+// producer, one per core with OPT_OS_NONE), see tusb_fifo.h
+#ifndef CFG_TUSB_FIFO_MULTI_PRODUCER
+  #define CFG_TUSB_FIFO_MULTI_PRODUCER 0
+#endif
+
+// Use 32-bit index and count for all fifos, lifting the 16-bit depth limit of 0x8000 items
+// e.g for large CDC/vendor buffers on high speed MCUs with plenty of SRAM
+#ifndef CFG_TUSB_FIFO_WIDE_INDEX
+  #define CFG_TUSB_FIFO_WIDE_INDEX 0
+#endif
+
+// All fifos have power of two depth: index math is compiled as mask without compare and wrap branches, which
+// helps in-order cores e.g Cortex-M0. tu_fifo_config() rejects other depth, fifo statically initialized with
+// TU_FIFO_INIT()/TU_FIFO_DEF() (including OPT_OS_NONE event queues) must use power of two depth as well
+#ifndef CFG_TUSB_FIFO_POW2
+  #define CFG_TUSB_FIFO_POW2 0
+#endif
+
+// Kernel used by fifo to copy data in/out of its buffer, see common/tusb_fifo_copy.h. Size optimized
+// C libraries (e.g newlib-nano) implement memcpy() with a byte loop, word kernel is much faster there
+#ifndef CFG_TUSB_FIFO_COPY
+  #define CFG_TUSB_FIFO_COPY OPT_FIFO_COPY_MEMCPY
+#endif
+
 //--------------------------------------------------------------------
 // Device Options (Default)
 //--------------------------------------------------------------------
@@ -374,6 +454,15 @@
   #define CFG_TUD_ENDPOINT0_SIZE  64
 #endif
 
+// Control data stage is transferred directly from/to application buffer in a single (multi-packet) transfer
+// when tud_control_xfer_dma_safe_cb() allows, instead of bouncing each packet through an internal buffer.
+// Requires DCD to support transfer larger than packet size on endpoint 0.
+// Default tud_control_xfer_dma_safe_cb() returns false: application must implement it to accept buffers
+// in memory the controller can access (e.g RAM only for nRF EasyDMA), otherwise nothing changes.
+#ifndef CFG_TUD_CTRL_ZERO_COPY
+  #define CFG_TUD_CTRL_ZERO_COPY  0
+#endif
+
 #ifndef CFG_TUD_INTERFACE_MAX
   #define CFG_TUD_INTERFACE_MAX   16
 #endif
@@ -392,6 +481,22 @@
   #define CFG_TUD_TEST_MODE       0
 #endif
 
+// Per-endpoint, event queue and class driver counters, read with tud_stats_get()
+#ifndef CFG_TUD_STATS
+  #define CFG_TUD_STATS           0
+#endif
+
+// Number of class drivers (by driver id) whose callback time is counted
+#ifndef CFG_TUD_STATS_DRIVER_MAX
+  #define CFG_TUD_STATS_DRIVER_MAX 8
+#endif
+
+// Histogram of delay between an event being queued and tud_task() dispatching it, per event type.
+// Delay is measured with tusb_timestamp_cb()
+#ifndef CFG_TUD_EVENT_LATENCY
+  #define CFG_TUD_EVENT_LATENCY 0
+#endif
+
 //------------- Device Class Driver -------------//
 #ifndef CFG_TUD_BTH
   #define CFG_TUD_BTH             0
@@ -467,6 +572,21 @@
   #endif
 #endif // CFG_TUH_ENABLED
 
+// Per-endpoint, event queue and class driver counters, read with tuh_stats_get()
+#ifndef CFG_TUH_STATS
+  #define CFG_TUH_STATS   0
+#endif
+
+// Number of class drivers (by driver id) whose callback time is counted
+#ifndef CFG_TUH_STATS_DRIVER_MAX
+  #define CFG_TUH_STATS_DRIVER_MAX 8
+#endif
+
+// Histogram of delay between an event being queued and tuh_task() dispatching it, per event type
+#ifndef CFG_TUH_EVENT_LATENCY
+  #define CFG_TUH_EVENT_LATENCY 0
+#endif
+
 // Attribute to place data in accessible RAM for host controller (default: CFG_TUSB_MEM_SECTION)
 #ifndef CFG_TUH_MEM_SECTION
   #define CFG_TUH_MEM_SECTION   CFG_TUSB_MEM_SECTION
@@ -0,0 +1,95 @@
+#!/usr/bin/env python3
+"""Compare benchmark result against stored baseline.
+
+Transfer count, bus rounds, queue high-water marks and interrupt masking count are deterministic with the loopback
+controller and must not get worse. Throughput and cycles per byte depend on the machine, their regressions are only
+reported as Warn unless --strict is given e.g CI runner producing its own baseline. A metric or case missing in result
+is a failure.
+
+    python3 bench_compare.py baseline.json _build/result.json [--tolerance 0.2]
+"""
+import argparse
+import json
+import sys
+
+STATUS_OK = "\033[32mOK\033[0m"
+STATUS_FAILED = "\033[31mFailed\033[0m"
+STATUS_WARN = "\033[33mWarn\033[0m"
+
+# metric name, higher is better, deterministic
+METRICS = [
+    ('bytes_per_s', True, False),
+    ('transfers', False, True),
+    ('bus_rounds', False, True),
+    ('cycles_per_byte', False, False),
+    ('peak_dev_queue', False, True),
+    ('peak_host_queue', False, True),
+    ('setup_wait_max', False, True),
+    ('setup_cycles_max', False, False),
+    ('ctrl_cycles_max', False, False),
+    ('int_masked', False, True),
+    ('int_masked_cycles', False, False),
+]
+
+compare_format = '| {:13} | {:16} | {:>14} | {:>14} | {:>8} | {:6} |'
+
+
+def load_results(path):
+    with open(path) as f:
+        data = json.load(f)
+    return {r['name']: r for r in data['results']}
+
+
+def is_regression(base, current, higher_better, deterministic, tolerance):
+    if deterministic:
+        return current > base
+    if higher_better:
+        return current < base * (1 - tolerance)
+    return current > base * (1 + tolerance)
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument('baseline', help='baseline json')
+    parser.add_argument('result', help='result json')
+    parser.add_argument('-t', '--tolerance', type=float, default=0.2,
+                        help='allowed relative regression of machine dependent metrics, default 0.2')
+    parser.add_argument('--strict', action='store_true', help='also fail on machine dependent metrics')
+    args = parser.parse_args()
+
+    baseline = load_results(args.baseline)
+    result = load_results(args.result)
+
+    failed = 0
+    print(compare_format.format('case', 'metric', 'baseline', 'result', 'change', 'status'))
+    for name, base in baseline.items():
+        if name not in result:
+            print(f'{name}: missing in result')
+            failed += 1
+            continue
+
+        for metric, higher_better, deterministic in METRICS:
+            if metric not in base:
+                continue
+            b = base[metric]
+            if metric not in result[name]:
+                print(compare_format.format(name, metric, b, 'missing', '-', STATUS_FAILED))
+                failed += 1
+                continue
+
+            c = result[name][metric]
+            change = f'{(c - b) * 100 / b:+.1f}%' if b else '-'
+            status = STATUS_OK
+            if is_regression(b, c, higher_better, deterministic, args.tolerance):
+                if deterministic or args.strict:
+                    status = STATUS_FAILED
+                    failed += 1
+                else:
+                    status = STATUS_WARN
+            print(compare_format.format(name, metric, b, c, change, status))
+
+    return 1 if failed else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,177 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Ha Thach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * This file is part of the TinyUSB stack.
+ */
+
+#ifndef BENCH_H_
+#define BENCH_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "tusb.h"
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+//--------------------------------------------------------------------+
+// Composite device layout, shared by device descriptors and host side of benchmarks
+//--------------------------------------------------------------------+
+enum {
+  ITF_NUM_CDC = 0,
+  ITF_NUM_CDC_DATA,
+  ITF_NUM_MSC,
+  ITF_NUM_NCM,
+  ITF_NUM_NCM_DATA,
+  ITF_NUM_VENDOR,
+  ITF_NUM_HID,
+  ITF_NUM_BULK,
+  ITF_NUM_TOTAL
+};
+
+enum {
+  EPNUM_CDC_NOTIF   = 0x81,
+  EPNUM_CDC_OUT     = 0x02,
+  EPNUM_CDC_IN      = 0x82,
+  EPNUM_MSC_OUT     = 0x03,
+  EPNUM_MSC_IN      = 0x83,
+  EPNUM_NCM_NOTIF   = 0x84,
+  EPNUM_NCM_OUT     = 0x05,
+  EPNUM_NCM_IN      = 0x85,
+  EPNUM_VENDOR_OUT  = 0x06,
+  EPNUM_VENDOR_IN   = 0x86,
+  EPNUM_HID_OUT     = 0x07,
+  EPNUM_HID_IN      = 0x87,
+  EPNUM_BULK_OUT    = 0x08,
+  EPNUM_BULK_IN     = 0x88,
+};
+
+#define BENCH_BULK_SIZE     (TUD_OPT_HIGH_SPEED ? 512 : 64)
+#define BENCH_HID_REPORT_SIZE  CFG_TUD_HID_EP_BUFSIZE
+
+#define BENCH_MSC_BLOCK_SIZE   512
+#define BENCH_MSC_BLOCK_NUM    64
+
+// Largest host transfer
+#define BENCH_CHUNK_MAX        (16u*1024)
+
+// Number of consecutive iterations without progress before a case is considered stalled
+#define BENCH_IDLE_MAX         1000
+
+//--------------------------------------------------------------------+
+// Benchmark
+//--------------------------------------------------------------------+
+typedef struct {
+  uint64_t bytes;      // payload bytes moved
+  uint64_t transfers;  // device transfers completed
+  uint64_t cycles;     // cpu cycles spent
+  uint64_t nsec;       // wall time spent
+  uint64_t bus_rounds; // bus passes with progress i.e sim_bus_task() returned true
+  uint32_t peak_dev_queue;  // device event queue high-water mark
+  uint32_t peak_host_queue; // host event queue high-water mark
+  uint32_t setup_wait_max;   // max data transfers handled by device between SETUP received and its handling
+  uint64_t setup_cycles_max; // max cpu cycles between SETUP received and its handling
+  uint64_t ctrl_cycles_max;  // max cpu cycles of a host control transfer from submit to completion
+  uint64_t int_masked;        // number of times device or host port interrupt is masked
+  uint64_t int_masked_cycles; // cpu cycles spent with device or host port interrupt masked
+} bench_result_t;
+
+typedef struct {
+  char const* name;
+  uint64_t (*run)(uint32_t total_bytes); // return number of payload bytes moved, 0 if failed
+} bench_case_t;
+
+// Host transfer used by benchmark, completes asynchronously
+typedef struct {
+  uint8_t ep_addr;
+  volatile bool busy;
+  xfer_result_t result;
+  uint32_t actual_len;
+} bench_xfer_t;
+
+// Address of enumerated device
+extern uint8_t bench_daddr;
+
+// Carry out all pending work on bus, device and host stack until everything is idle
+void bench_task(void);
+
+// One pass of a main loop that sleeps when idle: device and host task with timeout, then bus. Return false if
+// a task sleeps while having an event or does not sleep exactly once without one
+bool bench_task_sleep(uint32_t timeout_ms);
+
+// Submit host transfer, completion is reported with xfer->busy = false
+bool bench_host_xfer(bench_xfer_t* xfer, void* buffer, uint16_t len);
+
+// Submit host transfer and wait for its completion
+bool bench_host_xfer_sync(bench_xfer_t* xfer, void* buffer, uint16_t len);
+
+// Byte pattern starting at offset, valid for BENCH_CHUNK_MAX bytes. Must not be modified
+uint8_t* bench_pattern(uint32_t offset);
+
+// Check buffer against byte pattern starting at offset
+bool bench_pattern_check(uint8_t const* buffer, uint32_t len, uint32_t offset);
+
+// Current cpu cycles, time stamp counter where available, nanoseconds otherwise
+uint64_t bench_cycles(void);
+
+// Host control transfer submitted at start_cycles is complete, record its latency
+void bench_ctrl_complete(uint64_t start_cycles);
+
+// Device application reports a data transfer completion (class callback), used for SETUP latency
+void bench_data_handled(void);
+
+// Device application receives SETUP of a control request, record its latency since SETUP is received
+void bench_setup_handled(void);
+
+//------------- Cases -------------//
+uint64_t bench_cdc_in(uint32_t total_bytes);
+uint64_t bench_cdc_out(uint32_t total_bytes);
+uint64_t bench_cdc_in_timer(uint32_t total_bytes);
+uint64_t bench_cdc_line(uint32_t total_bytes);
+uint64_t bench_msc_read(uint32_t total_bytes);
+uint64_t bench_msc_write(uint32_t total_bytes);
+uint64_t bench_msc_busy(uint32_t total_bytes);
+uint64_t bench_msc_async(uint32_t total_bytes);
+uint64_t bench_msc_error(uint32_t total_bytes);
+uint64_t bench_ncm_in(uint32_t total_bytes);
+uint64_t bench_vendor_in(uint32_t total_bytes);
+uint64_t bench_hid_in(uint32_t total_bytes);
+uint64_t bench_ctrl_latency(uint32_t total_bytes);
+uint64_t bench_ctrl_in(uint32_t total_bytes);
+uint64_t bench_ctrl_in_zcopy(uint32_t total_bytes);
+uint64_t bench_bulk_in(uint32_t total_bytes);
+uint64_t bench_bulk_in_queue(uint32_t total_bytes);
+uint64_t bench_bulk_in_isr(uint32_t total_bytes);
+uint64_t bench_set_config(uint32_t total_bytes);
+uint64_t bench_set_config_xfer(uint32_t total_bytes);
+uint64_t bench_stats(uint32_t total_bytes);
+uint64_t bench_idle_wait(uint32_t total_bytes);
+uint64_t bench_defer(uint32_t total_bytes);
+
+#ifdef __cplusplus
+ }
+#endif
+
+#endif
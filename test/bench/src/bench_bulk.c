@@ -0,0 +1,336 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Ha Thach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * This file is part of the TinyUSB stack.
+ */
+
+#include "bench.h"
+#include "device/usbd_pvt.h"
+#include "portable/sim/sim_bus.h"
+
+// Raw bulk IN stream through an application class driver. Device either re-arms the endpoint from xfer_cb()
+// i.e one transfer in flight (bulk_in), or keeps it fed with usbd_edpt_xfer_queue() so that usbd starts the
+// next transfer as soon as the previous one completes (bulk_in_queue), or re-arms it from xfer_isr() in ISR
+// context with some completions deferred to xfer_cb() (bulk_in_isr).
+
+// One packet per transfer to emphasize the gap between transfers
+#define BULK_XFER_SIZE   BENCH_BULK_SIZE
+
+// Configuration changes done by set_config_xfer
+#define BULK_SET_CONFIG_ROUNDS  64
+
+// bulk_in_isr defers every this many completions from xfer_isr() to xfer_cb()
+#define BULK_ISR_DEFER_EVERY    4
+
+static struct {
+  uint8_t  ep_in;
+  bool     queued;
+  bool     isr;
+  bool     deferred;  // completion deferred to xfer_cb(), not yet handled
+  uint32_t submitted;
+  uint32_t completed;
+  uint32_t total;
+  uint32_t isr_count;
+  uint32_t task_count;
+  uint32_t order_errors;
+} _bulk;
+
+// IN transfers completed to driver while it is opened, kept across configuration reset
+static uint32_t _bulk_done;
+
+// set_config_xfer: event posted by xfer_cb() i.e after SETUP arrived, must run after SETUP is processed
+static bool _bulk_post_late;
+static uint32_t _bulk_late_count;
+static bool _bulk_late_mounted;
+
+static void bulk_late_func(void* param) {
+  (void) param;
+  _bulk_late_count++;
+  _bulk_late_mounted = tud_mounted();
+}
+
+static void bulk_refill(uint8_t rhport) {
+  while (_bulk.ep_in && _bulk.submitted < _bulk.total) {
+    uint16_t const len = (uint16_t) tu_min32(BULK_XFER_SIZE, _bulk.total - _bulk.submitted);
+    uint8_t* buf = bench_pattern(_bulk.submitted);
+
+#if CFG_TUD_EDPT_XFER_QUEUE
+    if (_bulk.queued) {
+      if (!usbd_edpt_xfer_queue(rhport, _bulk.ep_in, buf, len)) break;
+    } else
+#endif
+    {
+      if (!usbd_edpt_claim(rhport, _bulk.ep_in)) break;
+      if (!usbd_edpt_xfer(rhport, _bulk.ep_in, buf, len)) {
+        usbd_edpt_release(rhport, _bulk.ep_in);
+        break;
+      }
+    }
+
+    _bulk.submitted += len;
+  }
+}
+
+// Completion must be for the oldest submitted transfer, whichever path handles it
+static void bulk_complete(uint32_t xferred_bytes) {
+  uint32_t const expected = tu_min32(BULK_XFER_SIZE, _bulk.total - _bulk.completed);
+  if (xferred_bytes != expected || _bulk.completed + xferred_bytes > _bulk.submitted) _bulk.order_errors++;
+  _bulk.completed += xferred_bytes;
+}
+
+static uint64_t bulk_in(uint32_t total_bytes, bool queued, bool isr) {
+  static uint8_t rx_buf[BENCH_CHUNK_MAX];
+  bench_xfer_t xfer = { .ep_addr = EPNUM_BULK_IN };
+
+  _bulk.queued       = queued;
+  _bulk.isr          = isr;
+  _bulk.deferred     = false;
+  _bulk.submitted    = 0;
+  _bulk.completed    = 0;
+  _bulk.total        = total_bytes;
+  _bulk.isr_count    = 0;
+  _bulk.task_count   = 0;
+  _bulk.order_errors = 0;
+  bulk_refill(0);
+
+  uint32_t received = 0;
+  uint32_t idle = 0;
+
+  while (received < total_bytes) {
+    uint32_t const prev = received;
+
+    if (!xfer.busy) {
+      TU_VERIFY(bench_pattern_check(rx_buf, xfer.actual_len, received), 0);
+      received += xfer.actual_len;
+      xfer.actual_len = 0;
+
+      // read exactly what is left since device does not end the stream with a short packet
+      uint16_t const len = (uint16_t) tu_min32(sizeof(rx_buf), total_bytes - received);
+      if (len) TU_VERIFY(bench_host_xfer(&xfer, rx_buf, len), 0);
+    }
+
+    bench_task();
+
+    idle = (received == prev) ? idle + 1 : 0;
+    TU_VERIFY(idle < BENCH_IDLE_MAX, 0);
+  }
+
+  // last completion can still be queued for device task
+  for (uint32_t i = 0; _bulk.completed < total_bytes; i++) {
+    TU_VERIFY(i < BENCH_IDLE_MAX, 0);
+    bench_task();
+  }
+
+  _bulk.isr = false;
+  TU_VERIFY(_bulk.order_errors == 0, 0);
+
+  return received;
+}
+
+uint64_t bench_bulk_in(uint32_t total_bytes) {
+  return bulk_in(total_bytes, false, false);
+}
+
+uint64_t bench_bulk_in_queue(uint32_t total_bytes) {
+  return bulk_in(total_bytes, true, false);
+}
+
+// Both paths must be taken, ordering is checked by bulk_complete() and host pattern check
+uint64_t bench_bulk_in_isr(uint32_t total_bytes) {
+#if CFG_TUD_STATS
+  // application driver has id 0
+  static tud_stats_t stats;
+  TU_VERIFY(tud_stats_get(&stats), 0);
+  uint32_t const isr_calls = stats.driver[0].isr_calls;
+#endif
+
+  uint64_t const received = bulk_in(total_bytes, false, true);
+  TU_VERIFY(_bulk.isr_count && _bulk.task_count, 0);
+
+#if CFG_TUD_STATS
+  TU_VERIFY(tud_stats_get(&stats) && stats.driver[0].isr_calls - isr_calls == _bulk.isr_count, 0);
+#endif
+
+  return received;
+}
+
+static void ctrl_complete_cb(tuh_xfer_t* xfer) {
+  bench_xfer_t* bxfer = (bench_xfer_t*) xfer->user_data;
+  bxfer->result = xfer->result;
+  bxfer->busy   = false;
+}
+
+static bool ctrl_wait(bench_xfer_t* ctrl) {
+  for (uint32_t idle = 0; ctrl->busy; idle++) {
+    TU_VERIFY(idle < BENCH_IDLE_MAX);
+    bench_task();
+  }
+  return ctrl->result == XFER_RESULT_SUCCESS;
+}
+
+// Bulk IN transfer complete is still queued in device when SET_CONFIGURATION(0) is received. Bulk driver must get
+// it before the configuration is closed, also with CFG_TUD_TASK_CTRL_QUEUE where SETUP is handled ahead of data
+// events. A data event posted from that completion must not get ahead of the SETUP either.
+// Reported bytes are bulk bytes received by host.
+uint64_t bench_set_config_xfer(uint32_t total_bytes) {
+  (void) total_bytes;
+  static uint8_t rx_buf[BULK_XFER_SIZE];
+  bench_xfer_t xfer = { .ep_addr = EPNUM_BULK_IN };
+  bench_xfer_t ctrl = { .ep_addr = 0 };
+  uint64_t received = 0;
+
+  for (uint32_t i = 0; i < BULK_SET_CONFIG_ROUNDS; i++) {
+    _bulk.queued    = false;
+    _bulk.submitted = 0;
+    _bulk.completed = 0;
+    _bulk.total     = BULK_XFER_SIZE;
+    _bulk_done      = 0;
+    _bulk_post_late  = true;
+    _bulk_late_count = 0;
+    bulk_refill(0);
+    TU_VERIFY(_bulk.submitted == BULK_XFER_SIZE, 0);
+
+    // packet is carried out, device transfer complete is queued
+    TU_VERIFY(bench_host_xfer(&xfer, rx_buf, sizeof(rx_buf)), 0);
+    sim_bus_task();
+
+    // SETUP is queued behind it
+    ctrl.busy = true;
+    TU_VERIFY(tuh_configuration_set(bench_daddr, 0, ctrl_complete_cb, (uintptr_t) &ctrl), 0);
+    sim_bus_task();
+
+    TU_VERIFY(ctrl_wait(&ctrl) && !tud_mounted(), 0);
+    TU_VERIFY(_bulk_done == 1, 0);
+    TU_VERIFY(_bulk_late_count == 1 && !_bulk_late_mounted, 0);
+    TU_VERIFY(!xfer.busy && xfer.result == XFER_RESULT_SUCCESS && xfer.actual_len == BULK_XFER_SIZE, 0);
+    TU_VERIFY(bench_pattern_check(rx_buf, BULK_XFER_SIZE, 0), 0);
+    received += xfer.actual_len;
+
+    ctrl.busy = true;
+    TU_VERIFY(tuh_configuration_set(bench_daddr, 1, ctrl_complete_cb, (uintptr_t) &ctrl), 0);
+    TU_VERIFY(ctrl_wait(&ctrl) && tud_mounted(), 0);
+  }
+
+  // NCM data interface is back to alternate setting 0, restore it for following cases
+  ctrl.busy = true;
+  TU_VERIFY(tuh_interface_set(bench_daddr, ITF_NUM_NCM_DATA, 1, ctrl_complete_cb, (uintptr_t) &ctrl), 0);
+  TU_VERIFY(ctrl_wait(&ctrl), 0);
+
+  return received;
+}
+
+//--------------------------------------------------------------------+
+// Application class driver
+//--------------------------------------------------------------------+
+static void bulkd_init(void) {
+  tu_varclr(&_bulk);
+}
+
+static bool bulkd_deinit(void) {
+  return true;
+}
+
+static void bulkd_reset(uint8_t rhport) {
+  (void) rhport;
+  tu_varclr(&_bulk);
+}
+
+static uint16_t bulkd_open(uint8_t rhport, tusb_desc_interface_t const* desc_itf, uint16_t max_len) {
+  TU_VERIFY(desc_itf->bInterfaceNumber == ITF_NUM_BULK, 0);
+
+  uint16_t const drv_len = sizeof(tusb_desc_interface_t) + 2 * sizeof(tusb_desc_endpoint_t);
+  TU_VERIFY(max_len >= drv_len, 0);
+
+  uint8_t ep_out;
+  TU_ASSERT(usbd_open_edpt_pair(rhport, tu_desc_next(desc_itf), 2, TUSB_XFER_BULK, &ep_out, &_bulk.ep_in), 0);
+
+  return drv_len;
+}
+
+static bool bulkd_control_xfer_cb(uint8_t rhport, uint8_t stage, tusb_control_request_t const* request) {
+  (void) rhport;
+  (void) stage;
+  (void) request;
+  return false;
+}
+
+static bool bulkd_xfer_cb(uint8_t rhport, uint8_t ep_addr, xfer_result_t result, uint32_t xferred_bytes) {
+  (void) result;
+  (void) xferred_bytes;
+
+  if (ep_addr == _bulk.ep_in) {
+    _bulk_done++;
+    if (_bulk_post_late) {
+      _bulk_post_late = false;
+      usbd_defer_func(bulk_late_func, NULL, false);
+    }
+    _bulk.deferred = false;
+    _bulk.task_count++;
+    bulk_complete(xferred_bytes);
+    bulk_refill(rhport);
+  }
+  return true;
+}
+
+// Fast path: re-arm in ISR context without claiming, endpoint is not busy when invoked
+static bool bulkd_xfer_isr(uint8_t rhport, uint8_t ep_addr, xfer_result_t result, uint32_t xferred_bytes) {
+  (void) result;
+  TU_VERIFY(_bulk.isr && ep_addr == _bulk.ep_in);
+
+  // deferred completion must reach xfer_cb() before any later one
+  if (_bulk.deferred) _bulk.order_errors++;
+
+  if (((_bulk.isr_count + _bulk.task_count + 1) % BULK_ISR_DEFER_EVERY) == 0) {
+    _bulk.deferred = true;
+    return false;
+  }
+
+  _bulk_done++;
+  _bulk.isr_count++;
+  bulk_complete(xferred_bytes);
+
+  if (_bulk.submitted < _bulk.total) {
+    uint16_t const len = (uint16_t) tu_min32(BULK_XFER_SIZE, _bulk.total - _bulk.submitted);
+    TU_ASSERT(usbd_edpt_xfer(rhport, _bulk.ep_in, bench_pattern(_bulk.submitted), len));
+    _bulk.submitted += len;
+  }
+
+  return true;
+}
+
+static usbd_class_driver_t const _bulk_driver = {
+  .name            = "BULK",
+  .init            = bulkd_init,
+  .deinit          = bulkd_deinit,
+  .reset           = bulkd_reset,
+  .open            = bulkd_open,
+  .control_xfer_cb = bulkd_control_xfer_cb,
+  .xfer_cb         = bulkd_xfer_cb,
+  .sof             = NULL,
+  .xfer_isr        = bulkd_xfer_isr
+};
+
+usbd_class_driver_t const* usbd_app_driver_get_cb(uint8_t* driver_count) {
+  *driver_count = 1;
+  return &_bulk_driver;
+}
@@ -0,0 +1,242 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Ha Thach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * This file is part of the TinyUSB stack.
+ */
+
+#include "bench.h"
+#include "portable/sim/sim_bus.h"
+
+// Records written per virtual frame by cdc_in_timer, and frames it runs
+#define BENCH_CDC_RECORD_SIZE    32
+#define BENCH_CDC_RECORDS        6
+#define BENCH_CDC_FRAMES         4096
+
+// Lines received by cdc_line but not yet parsed, enough for a full rx fifo of shortest lines
+#define BENCH_CDC_LINE_PENDING   256
+
+// Device -> Host: application keeps tx fifo full, host always has a read pending
+uint64_t bench_cdc_in(uint32_t total_bytes) {
+  static uint8_t rx_buf[BENCH_CHUNK_MAX];
+  bench_xfer_t xfer = { .ep_addr = EPNUM_CDC_IN };
+
+  uint32_t sent = 0;
+  uint32_t received = 0;
+  uint32_t idle = 0;
+
+  while (received < total_bytes) {
+    uint32_t const prev = received;
+
+    uint32_t const count = tu_min32(tud_cdc_n_write_available(0), total_bytes - sent);
+    if (count) {
+      sent += tud_cdc_n_write(0, bench_pattern(sent), tu_min32(count, BENCH_CHUNK_MAX));
+    }
+    tud_cdc_n_write_flush(0);
+
+    if (!xfer.busy) {
+      TU_VERIFY(bench_pattern_check(rx_buf, xfer.actual_len, received), 0);
+      received += xfer.actual_len;
+      xfer.actual_len = 0;
+
+      TU_VERIFY(bench_host_xfer(&xfer, rx_buf, sizeof(rx_buf)), 0);
+    }
+
+    bench_task();
+
+    idle = (received == prev) ? idle + 1 : 0;
+    TU_VERIFY(idle < BENCH_IDLE_MAX, 0);
+  }
+
+  return received;
+}
+
+// Host -> Device: host writes large chunks, application drains rx fifo
+uint64_t bench_cdc_out(uint32_t total_bytes) {
+  static uint8_t rx_buf[BENCH_CHUNK_MAX];
+  bench_xfer_t xfer = { .ep_addr = EPNUM_CDC_OUT };
+
+  uint32_t sent = 0;
+  uint32_t received = 0;
+  uint32_t idle = 0;
+
+  while (received < total_bytes) {
+    uint32_t const prev = received;
+
+    if (!xfer.busy && sent < total_bytes) {
+      uint16_t const count = (uint16_t) tu_min32(total_bytes - sent, BENCH_CHUNK_MAX);
+      TU_VERIFY(bench_host_xfer(&xfer, bench_pattern(sent), count), 0);
+      sent += count;
+    }
+
+    bench_task();
+
+    uint32_t count;
+    while ( (count = tud_cdc_n_read(0, rx_buf, sizeof(rx_buf))) > 0 ) {
+      TU_VERIFY(bench_pattern_check(rx_buf, count, received), 0);
+      received += count;
+    }
+
+    idle = (received == prev) ? idle + 1 : 0;
+    TU_VERIFY(idle < BENCH_IDLE_MAX, 0);
+  }
+
+  return received;
+}
+
+#if CFG_TUD_CDC_TX_FLUSH_MS
+// Device -> Host: application writes small records every frame like a telemetry port and never flushes. Flush timer
+// batches them into transfers, host always has a read pending.
+uint64_t bench_cdc_in_timer(uint32_t total_bytes) {
+  (void) total_bytes;
+  static uint8_t rx_buf[BENCH_CHUNK_MAX];
+  bench_xfer_t xfer = { .ep_addr = EPNUM_CDC_IN };
+
+  uint32_t const total = BENCH_CDC_FRAMES * BENCH_CDC_RECORDS * BENCH_CDC_RECORD_SIZE;
+
+  // cdc_in leaves its last read pending
+  (void) tuh_edpt_abort_xfer(bench_daddr, EPNUM_CDC_IN);
+
+  uint32_t sent = 0;
+  uint32_t received = 0;
+  uint32_t idle = 0;
+
+  while (received < total) {
+    uint32_t const prev = received;
+
+    for (uint32_t i = 0; i < BENCH_CDC_RECORDS && sent < total; i++) {
+      TU_VERIFY(tud_cdc_n_write_available(0) >= BENCH_CDC_RECORD_SIZE, 0);
+      sent += tud_cdc_n_write(0, bench_pattern(sent), BENCH_CDC_RECORD_SIZE);
+    }
+
+    if (!xfer.busy) {
+      TU_VERIFY(bench_pattern_check(rx_buf, xfer.actual_len, received), 0);
+      received += xfer.actual_len;
+      xfer.actual_len = 0;
+
+      TU_VERIFY(bench_host_xfer(&xfer, rx_buf, sizeof(rx_buf)), 0);
+    }
+
+    sim_bus_frame_advance(1);
+    bench_task();
+
+    idle = (received == prev) ? idle + 1 : 0;
+    TU_VERIFY(idle < BENCH_IDLE_MAX, 0);
+  }
+
+  return received;
+}
+#endif
+
+//--------------------------------------------------------------------+
+// Line receive
+//--------------------------------------------------------------------+
+
+// Line k of cdc_line is 1-61 letters ending with LF or ';'
+static uint32_t line_make(uint8_t* buf, uint32_t k) {
+  uint32_t const len = 1 + (k * 13) % 61;
+  for (uint32_t j = 0; j < len; j++) {
+    buf[j] = (uint8_t) ('A' + (k + j) % 26);
+  }
+  buf[len] = (k & 1) ? ';' : '\n';
+  return len + 1;
+}
+
+static struct {
+  uint32_t len[BENCH_CDC_LINE_PENDING];
+  uint32_t rd, wr;
+  uint32_t bytes; // pending bytes in rx fifo
+  uint32_t errors;
+} _line;
+
+void tud_cdc_rx_line_cb(uint8_t itf, uint32_t offset, uint32_t len) {
+  // lines are parsed in order, so a new one must start right after the pending ones
+  if (itf != 0 || offset != _line.bytes || (_line.wr - _line.rd) >= BENCH_CDC_LINE_PENDING) {
+    _line.errors++;
+    return;
+  }
+  _line.len[_line.wr++ % BENCH_CDC_LINE_PENDING] = len;
+  _line.bytes += len;
+}
+
+// Host -> Device: host writes a stream of short lines, application is notified of each line and parses it in place
+uint64_t bench_cdc_line(uint32_t total_bytes) {
+  static uint8_t stream[BENCH_CHUNK_MAX];
+  uint8_t expected[64];
+  bench_xfer_t xfer = { .ep_addr = EPNUM_CDC_OUT };
+
+  // stream of whole lines sent repeatedly
+  uint32_t stream_len = 0;
+  uint32_t stream_lines = 0;
+  while (stream_len + 64 <= sizeof(stream)) {
+    stream_len += line_make(stream + stream_len, stream_lines++);
+  }
+
+  uint32_t const total = tu_div_ceil(total_bytes, stream_len) * stream_len;
+
+  tu_memclr(&_line, sizeof(_line));
+  TU_VERIFY(tud_cdc_n_set_line_delimiters(0, "\n;", 2), 0);
+
+  uint32_t sent = 0;
+  uint32_t received = 0;
+  uint32_t line_idx = 0;
+  uint32_t idle = 0;
+
+  while (received < total) {
+    uint32_t const prev = received;
+
+    if (!xfer.busy && sent < total) {
+      TU_VERIFY(bench_host_xfer(&xfer, stream, (uint16_t) stream_len), 0);
+      sent += stream_len;
+    }
+
+    bench_task();
+    TU_VERIFY(_line.errors == 0, 0);
+
+    while (_line.rd != _line.wr) {
+      uint32_t const len = _line.len[_line.rd++ % BENCH_CDC_LINE_PENDING];
+      TU_VERIFY(len == line_make(expected, line_idx), 0);
+
+      // a line at the end of fifo buffer is reserved in two parts
+      uint32_t pos = 0;
+      while (pos < len) {
+        void* ptr;
+        uint32_t const count = tud_cdc_n_read_reserve(0, &ptr, len - pos);
+        TU_VERIFY(count && 0 == memcmp(ptr, expected + pos, count), 0);
+        TU_VERIFY(tud_cdc_n_read_commit(0, count) == count, 0);
+        pos += count;
+      }
+
+      _line.bytes -= len;
+      received += len;
+      line_idx = (line_idx + 1) % stream_lines;
+    }
+
+    idle = (received == prev) ? idle + 1 : 0;
+    TU_VERIFY(idle < BENCH_IDLE_MAX, 0);
+  }
+
+  TU_VERIFY(tud_cdc_n_available(0) == 0, 0);
+  tud_cdc_n_set_line_delimiters(0, NULL, 0);
+
+  return received;
+}
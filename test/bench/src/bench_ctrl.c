@@ -0,0 +1,470 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Ha Thach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * This file is part of the TinyUSB stack.
+ */
+
+#include "bench.h"
+#include "device/dcd.h"
+#include "host/hcd.h"
+#include "device/usbd_pvt.h"
+#include "host/usbh_pvt.h"
+#include "portable/sim/sim_bus.h"
+
+// Vendor request answered by device application with wLength bytes of pattern
+#define BENCH_CTRL_REQUEST   0x42
+#define BENCH_CTRL_LEN       64
+
+// Data stage of ctrl_in e.g a large descriptor or DFU upload
+#define BENCH_CTRL_XFER_SIZE 4096
+
+// Configuration switches per set_config run, enumeration is not a streaming workload
+#define BENCH_SET_CONFIG_ROUNDS 256
+
+// Control requests and timeout of idle_wait
+#define BENCH_IDLE_ROUNDS    1024
+#define BENCH_IDLE_TIMEOUT   10
+
+// Bursts of deferred calls per defer run, each burst calls every function this many times
+#define BENCH_DEFER_ROUNDS   1024
+#define BENCH_DEFER_REPEAT   4
+
+// Stack counters dump request, used by stats
+#define BENCH_STATS_REQUEST  0x43
+#define BENCH_STATS_ROUNDS   256
+
+// Device application allows control data stage directly from its buffer
+static bool _ctrl_zero_copy;
+
+typedef struct {
+  bench_xfer_t xfer;
+  uint16_t rx_len;
+  uint32_t sent;
+  uint32_t received;
+  uint8_t  rx_buf[BENCH_CHUNK_MAX];
+} ctrl_stream_t;
+
+enum {
+  STREAM_VENDOR = 0,
+  STREAM_CDC,
+  STREAM_HID,
+  STREAM_COUNT
+};
+
+static void stream_write(uint8_t idx, ctrl_stream_t* stream) {
+  uint8_t const* data = bench_pattern(stream->sent);
+
+  switch (idx) {
+    case STREAM_VENDOR:
+      stream->sent += tud_vendor_n_write(0, data, tu_min32(tud_vendor_n_write_available(0), BENCH_CHUNK_MAX));
+      tud_vendor_n_write_flush(0);
+      break;
+
+    case STREAM_CDC:
+      stream->sent += tud_cdc_n_write(0, data, tu_min32(tud_cdc_n_write_available(0), BENCH_CHUNK_MAX));
+      tud_cdc_n_write_flush(0);
+      break;
+
+    case STREAM_HID:
+      if (tud_hid_n_ready(0) && tud_hid_n_report(0, 0, data, BENCH_HID_REPORT_SIZE)) {
+        stream->sent += BENCH_HID_REPORT_SIZE;
+      }
+      break;
+
+    default: break;
+  }
+}
+
+static void ctrl_complete_cb(tuh_xfer_t* xfer) {
+  bench_xfer_t* bxfer = (bench_xfer_t*) xfer->user_data;
+  bxfer->result     = xfer->result;
+  bxfer->actual_len = xfer->actual_len;
+  bxfer->busy       = false;
+}
+
+static bool ctrl_request_n(bench_xfer_t* bxfer, uint8_t bRequest, uint8_t* buffer, uint16_t len) {
+  tusb_control_request_t const request = {
+    .bmRequestType_bit = {
+      .recipient = TUSB_REQ_RCPT_DEVICE,
+      .type      = TUSB_REQ_TYPE_VENDOR,
+      .direction = TUSB_DIR_IN
+    },
+    .bRequest = bRequest,
+    .wValue   = 0,
+    .wIndex   = 0,
+    .wLength  = len
+  };
+
+  tuh_xfer_t xfer = {
+    .daddr       = bench_daddr,
+    .ep_addr     = 0,
+    .setup       = &request,
+    .buffer      = buffer,
+    .complete_cb = ctrl_complete_cb,
+    .user_data   = (uintptr_t) bxfer
+  };
+
+  bxfer->busy = true;
+  if (!tuh_control_xfer(&xfer)) {
+    bxfer->busy = false;
+    return false;
+  }
+
+  return true;
+}
+
+static bool ctrl_request(bench_xfer_t* bxfer, uint8_t* buffer, uint16_t len) {
+  return ctrl_request_n(bxfer, BENCH_CTRL_REQUEST, buffer, len);
+}
+
+// Control request under saturated bulk/interrupt IN traffic on vendor, CDC and HID. Each round the bus carries
+// out data packets first, then host issues a control request so that its SETUP is queued behind the data transfer
+// complete events, as with a device task running late. Latency is reported by setup_wait_max/setup_cycles_max.
+uint64_t bench_ctrl_latency(uint32_t total_bytes) {
+  static ctrl_stream_t streams[STREAM_COUNT] = {
+    [STREAM_VENDOR] = { .xfer = { .ep_addr = EPNUM_VENDOR_IN }, .rx_len = BENCH_CHUNK_MAX },
+    [STREAM_CDC]    = { .xfer = { .ep_addr = EPNUM_CDC_IN    }, .rx_len = BENCH_CHUNK_MAX },
+    [STREAM_HID]    = { .xfer = { .ep_addr = EPNUM_HID_IN    }, .rx_len = BENCH_HID_REPORT_SIZE },
+  };
+  static uint8_t ctrl_buf[BENCH_CTRL_LEN];
+  bench_xfer_t ctrl = { .ep_addr = 0 };
+
+  uint32_t received = 0;
+  uint32_t idle = 0;
+
+  for (uint8_t i = 0; i < STREAM_COUNT; i++) {
+    // cases using the same endpoint leave their last read pending
+    (void) tuh_edpt_abort_xfer(bench_daddr, streams[i].xfer.ep_addr);
+
+    streams[i].xfer.busy       = false;
+    streams[i].xfer.actual_len = 0;
+    streams[i].sent     = 0;
+    streams[i].received = 0;
+  }
+
+  while (received < total_bytes) {
+    uint32_t const prev = received;
+
+    for (uint8_t i = 0; i < STREAM_COUNT; i++) {
+      ctrl_stream_t* stream = &streams[i];
+      stream_write(i, stream);
+
+      if (!stream->xfer.busy) {
+        TU_VERIFY(bench_pattern_check(stream->rx_buf, stream->xfer.actual_len, stream->received), 0);
+        stream->received += stream->xfer.actual_len;
+        received += stream->xfer.actual_len;
+        stream->xfer.actual_len = 0;
+
+        TU_VERIFY(bench_host_xfer(&stream->xfer, stream->rx_buf, stream->rx_len), 0);
+      }
+    }
+
+    // data packets are carried out, device transfer complete events are queued
+    sim_bus_task();
+
+    if (!ctrl.busy) {
+      TU_VERIFY(ctrl.actual_len == 0 || bench_pattern_check(ctrl_buf, ctrl.actual_len, 0), 0);
+      ctrl.actual_len = 0;
+      TU_VERIFY(ctrl_request(&ctrl, ctrl_buf, BENCH_CTRL_LEN), 0);
+
+      // SETUP is queued behind data events
+      sim_bus_task();
+    }
+
+    bench_task();
+    TU_VERIFY(ctrl.busy || ctrl.result == XFER_RESULT_SUCCESS, 0);
+
+    idle = (received == prev) ? idle + 1 : 0;
+    TU_VERIFY(idle < BENCH_IDLE_MAX, 0);
+  }
+
+  return received;
+}
+
+// Device -> Host: back to back control transfers with large data stage, each packet is bounced through usbd
+// control buffer (ctrl_in) or the whole data stage is sent from application buffer (ctrl_in_zcopy)
+static uint64_t ctrl_in(uint32_t total_bytes, bool zero_copy) {
+  static uint8_t rx_buf[BENCH_CTRL_XFER_SIZE];
+  bench_xfer_t ctrl = { .ep_addr = 0 };
+
+  _ctrl_zero_copy = zero_copy;
+
+  uint32_t received = 0;
+  while (received < total_bytes) {
+    uint16_t const len = (uint16_t) tu_min32(BENCH_CTRL_XFER_SIZE, total_bytes - received);
+    uint64_t const start_cycles = bench_cycles();
+
+    TU_VERIFY(ctrl_request(&ctrl, rx_buf, len), 0);
+    for (uint32_t idle = 0; ctrl.busy; idle++) {
+      TU_VERIFY(idle < BENCH_IDLE_MAX, 0);
+      bench_task();
+    }
+    bench_ctrl_complete(start_cycles);
+
+    TU_VERIFY(ctrl.result == XFER_RESULT_SUCCESS && ctrl.actual_len == len, 0);
+    TU_VERIFY(bench_pattern_check(rx_buf, len, 0), 0);
+    received += len;
+  }
+
+  _ctrl_zero_copy = false;
+
+  return received;
+}
+
+uint64_t bench_ctrl_in(uint32_t total_bytes) {
+  return ctrl_in(total_bytes, false);
+}
+
+uint64_t bench_ctrl_in_zcopy(uint32_t total_bytes) {
+  return ctrl_in(total_bytes, true);
+}
+
+static bool ctrl_wait(bench_xfer_t* ctrl) {
+  for (uint32_t idle = 0; ctrl->busy; idle++) {
+    TU_VERIFY(idle < BENCH_IDLE_MAX);
+    bench_task();
+  }
+  return ctrl->result == XFER_RESULT_SUCCESS;
+}
+
+static bool set_config(bench_xfer_t* ctrl, uint8_t cfg_num) {
+  ctrl->busy = true;
+  if (!tuh_configuration_set(bench_daddr, cfg_num, ctrl_complete_cb, (uintptr_t) ctrl)) {
+    ctrl->busy = false;
+    return false;
+  }
+  return ctrl_wait(ctrl);
+}
+
+// Host un-configures then re-configures the device, ctrl_cycles_max is the latency of SET_CONFIGURATION(1)
+// i.e parsing configuration descriptor and opening all class drivers. Reported bytes are configuration
+// descriptor bytes opened.
+uint64_t bench_set_config(uint32_t total_bytes) {
+  (void) total_bytes;
+  bench_xfer_t ctrl = { .ep_addr = 0 };
+
+  tusb_desc_configuration_t const* desc_cfg = (tusb_desc_configuration_t const*) tud_descriptor_configuration_cb(0);
+  uint16_t const cfg_len = tu_le16toh(desc_cfg->wTotalLength);
+
+  uint64_t opened = 0;
+  for (uint32_t i = 0; i < BENCH_SET_CONFIG_ROUNDS; i++) {
+    TU_VERIFY(set_config(&ctrl, 0), 0);
+    TU_VERIFY(!tud_mounted(), 0);
+
+    uint64_t const start_cycles = bench_cycles();
+    TU_VERIFY(set_config(&ctrl, 1), 0);
+    bench_ctrl_complete(start_cycles);
+
+    TU_VERIFY(tud_mounted(), 0);
+    opened += cfg_len;
+  }
+
+  // NCM data interface is back to alternate setting 0, restore it for following cases
+  ctrl.busy = true;
+  TU_VERIFY(tuh_interface_set(bench_daddr, ITF_NUM_NCM_DATA, 1, ctrl_complete_cb, (uintptr_t) &ctrl), 0);
+  TU_VERIFY(ctrl_wait(&ctrl), 0);
+
+  return opened;
+}
+
+#if CFG_TUSB_OS == OPT_OS_NONE && CFG_TUSB_OS_NONE_WAIT
+// Control requests driven by a main loop that sleeps whenever the stacks are idle i.e tud_task_ext()/tuh_task_ext()
+// with timeout. Checks that queued events are handled without sleep and an idle task sleeps once then returns.
+// Reported bytes are data stage bytes received by host.
+uint64_t bench_idle_wait(uint32_t total_bytes) {
+  (void) total_bytes;
+  bench_xfer_t ctrl = { .ep_addr = 0 };
+  uint8_t buf[BENCH_CTRL_LEN];
+  uint64_t received = 0;
+
+  for (uint32_t i = 0; i < BENCH_IDLE_ROUNDS; i++) {
+    TU_VERIFY(ctrl_request(&ctrl, buf, BENCH_CTRL_LEN), 0);
+
+    for (uint32_t idle = 0; ctrl.busy; idle++) {
+      TU_VERIFY(idle < BENCH_IDLE_MAX, 0);
+      TU_VERIFY(bench_task_sleep(BENCH_IDLE_TIMEOUT), 0);
+    }
+
+    TU_VERIFY(ctrl.result == XFER_RESULT_SUCCESS && ctrl.actual_len == BENCH_CTRL_LEN, 0);
+    TU_VERIFY(bench_pattern_check(buf, BENCH_CTRL_LEN, 0), 0);
+    received += ctrl.actual_len;
+  }
+
+  // all idle
+  TU_VERIFY(!tud_task_event_ready() && !tuh_task_event_ready(), 0);
+  TU_VERIFY(bench_task_sleep(BENCH_IDLE_TIMEOUT), 0);
+
+  return received;
+}
+#endif
+
+#if CFG_TUD_DEFER_QUEUE_SZ && CFG_TUH_DEFER_QUEUE_SZ
+// one counter per deferred (func, param), device ones first. Extra ones overflow the defer queues
+enum {
+  DEFER_OVERFLOW = 2,
+  DEFER_DEV_COUNT = CFG_TUD_DEFER_QUEUE_SZ + DEFER_OVERFLOW,
+  DEFER_COUNT = DEFER_DEV_COUNT + CFG_TUH_DEFER_QUEUE_SZ + DEFER_OVERFLOW
+};
+
+static uint32_t _defer_runs[DEFER_COUNT];
+
+static void defer_cb(void* param) {
+  _defer_runs[(uintptr_t) param]++;
+}
+
+static void defer_burst(uint32_t dev_count, uint32_t host_count) {
+  for (uint32_t r = 0; r < BENCH_DEFER_REPEAT; r++) {
+    for (uint32_t i = 0; i < dev_count; i++) {
+      usbd_defer_func(defer_cb, (void*) (uintptr_t) i, (i + r) & 1);
+    }
+    for (uint32_t i = 0; i < host_count; i++) {
+      usbh_defer_func(defer_cb, (void*) (uintptr_t) (DEFER_DEV_COUNT + i), (i + r) & 1);
+    }
+  }
+}
+
+// Bursts of deferred calls from task and ISR context while their task does not run. Calls still pending are coalesced:
+// every function runs once and only one event per stack is queued. A last burst exceeds the defer queues, extra calls
+// fall back to events of their own and run as many times as they are made. Reported bytes are deferred calls run.
+uint64_t bench_defer(uint32_t total_bytes) {
+  (void) total_bytes;
+  uint64_t runs = 0;
+
+  for (uint32_t round = 0; round <= BENCH_DEFER_ROUNDS; round++) {
+    bool const overflow = (round == BENCH_DEFER_ROUNDS);
+    uint32_t const extra = overflow ? DEFER_OVERFLOW : 0;
+
+    tu_varclr(&_defer_runs);
+    defer_burst(CFG_TUD_DEFER_QUEUE_SZ + extra, CFG_TUH_DEFER_QUEUE_SZ + extra);
+    TU_VERIFY(tud_task_event_ready() && tuh_task_event_ready(), 0);
+    bench_task();
+
+    for (uint32_t i = 0; i < DEFER_COUNT; i++) {
+      uint32_t const idx = (i < DEFER_DEV_COUNT) ? i : (i - DEFER_DEV_COUNT);
+      uint32_t const queue_sz = (i < DEFER_DEV_COUNT) ? CFG_TUD_DEFER_QUEUE_SZ : CFG_TUH_DEFER_QUEUE_SZ;
+      uint32_t const expected = (idx < queue_sz) ? 1 : (overflow ? BENCH_DEFER_REPEAT : 0);
+      TU_VERIFY(_defer_runs[i] == expected, 0);
+      runs += _defer_runs[i];
+    }
+  }
+
+  return runs;
+}
+#endif
+
+#if CFG_TUD_STATS && CFG_TUH_STATS
+#if CFG_TUD_EVENT_LATENCY && CFG_TUH_EVENT_LATENCY
+static uint32_t latency_count(tu_latency_hist_t const* hist) {
+  uint32_t count = 0;
+  for (uint8_t i = 0; i < TU_LATENCY_BINS; i++) count += hist->count[i];
+  return count;
+}
+#endif
+
+// Host reads device counters with a vendor request, as a tool would from a deployed unit. Dumped counters of the
+// bulk endpoints must match tud_stats_get() and the transfers seen by host. Reported bytes are counters read.
+uint64_t bench_stats(uint32_t total_bytes) {
+  (void) total_bytes;
+  static tud_stats_t dumped;
+  bench_xfer_t ctrl = { .ep_addr = 0 };
+
+  // bulk traffic of its own so that endpoint counters are checked when run alone
+  TU_VERIFY(bench_bulk_in(BENCH_CHUNK_MAX * 4) > 0, 0);
+
+  uint64_t received = 0;
+  for (uint32_t i = 0; i < BENCH_STATS_ROUNDS; i++) {
+    uint64_t const start_cycles = bench_cycles();
+    TU_VERIFY(ctrl_request_n(&ctrl, BENCH_STATS_REQUEST, (uint8_t*) &dumped, sizeof(dumped)), 0);
+    TU_VERIFY(ctrl_wait(&ctrl) && ctrl.actual_len == sizeof(dumped), 0);
+    bench_ctrl_complete(start_cycles);
+    received += ctrl.actual_len;
+  }
+
+  tud_stats_t dev;
+  tuh_stats_t host;
+  TU_VERIFY(tud_stats_get(&dev) && tuh_stats_get(&host), 0);
+
+  uint8_t const epnum = tu_edpt_number(EPNUM_BULK_IN);
+  tu_stats_edpt_t const* dev_in = &dev.edpt[epnum][TUSB_DIR_IN];
+  TU_VERIFY(memcmp(&dumped.edpt[epnum], &dev.edpt[epnum], sizeof(dev.edpt[epnum])) == 0, 0);
+  TU_VERIFY(dev_in->xfers > 0 && dev_in->bytes > 0 && dev_in->errors == 0, 0);
+
+  // device transfer may end with short packet, one host read may then complete with several device transfers
+  tu_stats_edpt_t const* host_in = &host.edpt[epnum][TUSB_DIR_IN];
+  TU_VERIFY(host_in->bytes == dev_in->bytes, 0);
+
+  TU_VERIFY(dev.setup >= BENCH_STATS_ROUNDS && dev.bus_reset > 0 && dev.queue_peak > 0, 0);
+  TU_VERIFY(host.attach > 0 && host.queue_peak > 0, 0);
+
+#if CFG_TUD_EVENT_LATENCY && CFG_TUH_EVENT_LATENCY
+  // every SETUP queued by this case is dispatched, histogram counts at least those
+  tud_event_latency_t dev_latency;
+  tuh_event_latency_t host_latency;
+  TU_VERIFY(tud_event_latency_get(&dev_latency) && tuh_event_latency_get(&host_latency), 0);
+  TU_VERIFY(latency_count(&dev_latency.event[DCD_EVENT_SETUP_RECEIVED]) >= BENCH_STATS_ROUNDS, 0);
+  TU_VERIFY(latency_count(&host_latency.event[HCD_EVENT_XFER_COMPLETE]) > 0, 0);
+#endif
+
+  return received;
+}
+#endif
+
+//--------------------------------------------------------------------+
+// Device callbacks
+//--------------------------------------------------------------------+
+bool tud_control_xfer_dma_safe_cb(void const* buffer, uint16_t len) {
+  (void) buffer;
+  (void) len;
+  return _ctrl_zero_copy;
+}
+
+bool tud_vendor_control_xfer_cb(uint8_t rhport, uint8_t stage, tusb_control_request_t const* request) {
+  if (stage != CONTROL_STAGE_SETUP) return true;
+
+#if CFG_TUD_STATS
+  if (request->bRequest == BENCH_STATS_REQUEST) return tud_stats_control_xfer(rhport, request);
+#endif
+
+  TU_VERIFY(request->bRequest == BENCH_CTRL_REQUEST);
+
+  bench_setup_handled();
+  return tud_control_xfer(rhport, request, bench_pattern(0), request->wLength);
+}
+
+void tud_vendor_tx_cb(uint8_t itf, uint32_t sent_bytes) {
+  (void) itf;
+  (void) sent_bytes;
+  bench_data_handled();
+}
+
+void tud_cdc_tx_complete_cb(uint8_t itf) {
+  (void) itf;
+  bench_data_handled();
+}
+
+void tud_hid_report_complete_cb(uint8_t instance, uint8_t const* report, uint16_t len) {
+  (void) instance;
+  (void) report;
+  (void) len;
+  bench_data_handled();
+}
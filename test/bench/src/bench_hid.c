@@ -0,0 +1,84 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Ha Thach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * This file is part of the TinyUSB stack.
+ */
+
+#include "bench.h"
+
+// Device -> Host: one report per interrupt transfer
+uint64_t bench_hid_in(uint32_t total_bytes) {
+  static uint8_t rx_buf[BENCH_HID_REPORT_SIZE];
+  bench_xfer_t xfer = { .ep_addr = EPNUM_HID_IN };
+
+  uint32_t sent = 0;
+  uint32_t received = 0;
+  uint32_t idle = 0;
+
+  while (received < total_bytes) {
+    uint32_t const prev = received;
+
+    if (sent < total_bytes && tud_hid_n_ready(0)) {
+      TU_VERIFY(tud_hid_n_report(0, 0, bench_pattern(sent), BENCH_HID_REPORT_SIZE), 0);
+      sent += BENCH_HID_REPORT_SIZE;
+    }
+
+    if (!xfer.busy) {
+      TU_VERIFY(bench_pattern_check(rx_buf, xfer.actual_len, received), 0);
+      received += xfer.actual_len;
+      xfer.actual_len = 0;
+
+      TU_VERIFY(bench_host_xfer(&xfer, rx_buf, sizeof(rx_buf)), 0);
+    }
+
+    bench_task();
+
+    idle = (received == prev) ? idle + 1 : 0;
+    TU_VERIFY(idle < BENCH_IDLE_MAX, 0);
+  }
+
+  return received;
+}
+
+//--------------------------------------------------------------------+
+// HID callbacks
+//--------------------------------------------------------------------+
+uint16_t tud_hid_get_report_cb(uint8_t instance, uint8_t report_id, hid_report_type_t report_type,
+                               uint8_t* buffer, uint16_t reqlen) {
+  (void) instance;
+  (void) report_id;
+  (void) report_type;
+  (void) buffer;
+  (void) reqlen;
+
+  return 0;
+}
+
+void tud_hid_set_report_cb(uint8_t instance, uint8_t report_id, hid_report_type_t report_type,
+                           uint8_t const* buffer, uint16_t bufsize) {
+  (void) instance;
+  (void) report_id;
+  (void) report_type;
+  (void) buffer;
+  (void) bufsize;
+}
@@ -0,0 +1,382 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Ha Thach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * This file is part of the TinyUSB stack.
+ */
+
+#include "bench.h"
+#include "portable/sim/sim_bus.h"
+
+// READ10/WRITE10 pairs failed by msc_error
+#define MSC_ERROR_ROUNDS  64
+
+// RAM disk, also used as pattern source for read and checked after write
+static uint8_t _disk[BENCH_MSC_BLOCK_NUM][BENCH_MSC_BLOCK_SIZE];
+static uint32_t _tag;
+
+// Storage is busy every other read10/write10 callback and handles at most one block per callback, used by msc_busy
+static bool _slow;
+static bool _slow_skip;
+
+// Storage fails read10/write10 at this block, used by msc_error
+static uint32_t _fail_lba = UINT32_MAX;
+
+// Storage completes read10/write10 in background once the task is idle, used by msc_async
+static bool _async;
+static struct {
+  bool pending;
+  bool is_read;
+  uint8_t* disk;
+  uint8_t* buffer;
+  uint32_t bufsize;
+} _async_io;
+
+// Background I/O is done (e.g DMA complete interrupt), completion from ISR is posted by next SOF
+static void storage_async_task(void) {
+  if (!_async_io.pending) return;
+  _async_io.pending = false;
+
+  if (_async_io.is_read) {
+    memcpy(_async_io.buffer, _async_io.disk, _async_io.bufsize);
+  } else {
+    memcpy(_async_io.disk, _async_io.buffer, _async_io.bufsize);
+  }
+
+  tud_msc_async_io_done(0, (int32_t) _async_io.bufsize, true);
+  sim_bus_frame_advance(1);
+}
+
+// Same as bench_host_xfer_sync() while storage processes background I/O
+static bool msc_xfer_sync(bench_xfer_t* bxfer, void* buffer, uint16_t len) {
+  TU_VERIFY(bench_host_xfer(bxfer, buffer, len));
+
+  while (bxfer->busy) {
+    bench_task();
+    storage_async_task();
+  }
+
+  return bxfer->result == XFER_RESULT_SUCCESS;
+}
+
+static int32_t storage_async_start(bool is_read, uint8_t* disk, uint8_t* buffer, uint32_t bufsize) {
+  TU_VERIFY(!_async_io.pending, -1);
+
+  _async_io.pending = true;
+  _async_io.is_read = is_read;
+  _async_io.disk    = disk;
+  _async_io.buffer  = buffer;
+  _async_io.bufsize = bufsize;
+
+  return TUD_MSC_RET_ASYNC;
+}
+
+static void clear_halt_cb(tuh_xfer_t* xfer) {
+  bench_xfer_t* bxfer = (bench_xfer_t*) xfer->user_data;
+  bxfer->result = xfer->result;
+  bxfer->busy   = false;
+}
+
+// Clear endpoint halt after a failed data stage
+static bool msc_clear_halt(uint8_t ep_addr) {
+  bench_xfer_t ctrl = { .ep_addr = 0 };
+
+  tusb_control_request_t const request = {
+    .bmRequestType_bit = {
+      .recipient = TUSB_REQ_RCPT_ENDPOINT,
+      .type      = TUSB_REQ_TYPE_STANDARD,
+      .direction = TUSB_DIR_OUT
+    },
+    .bRequest = TUSB_REQ_CLEAR_FEATURE,
+    .wValue   = TUSB_REQ_FEATURE_EDPT_HALT,
+    .wIndex   = ep_addr,
+    .wLength  = 0
+  };
+
+  tuh_xfer_t xfer = {
+    .daddr       = bench_daddr,
+    .ep_addr     = 0,
+    .setup       = &request,
+    .buffer      = NULL,
+    .complete_cb = clear_halt_cb,
+    .user_data   = (uintptr_t) &ctrl
+  };
+
+  ctrl.busy = true;
+  TU_VERIFY(tuh_control_xfer(&xfer));
+
+  for (uint32_t idle = 0; ctrl.busy; idle++) {
+    TU_VERIFY(idle < BENCH_IDLE_MAX);
+    bench_task();
+  }
+
+  return ctrl.result == XFER_RESULT_SUCCESS;
+}
+
+// Issue a READ10/WRITE10 with Bulk-Only transport: CBW, data and CSW. Data stage can fail when storage does, host
+// then clears endpoint halt and returns the bytes transferred before it (data residue) in xferred.
+static bool msc_rw10_status(bool is_read, uint32_t lba, uint16_t block_count, uint8_t* buffer, uint8_t* status,
+                            uint32_t* xferred) {
+  static bench_xfer_t xfer_out = { .ep_addr = EPNUM_MSC_OUT };
+  static bench_xfer_t xfer_in  = { .ep_addr = EPNUM_MSC_IN  };
+
+  uint32_t const total_bytes = (uint32_t) block_count * BENCH_MSC_BLOCK_SIZE;
+
+  msc_cbw_t cbw = {
+    .signature   = MSC_CBW_SIGNATURE,
+    .tag         = ++_tag,
+    .total_bytes = total_bytes,
+    .dir         = is_read ? TUSB_DIR_IN_MASK : 0,
+    .lun         = 0,
+    .cmd_len     = sizeof(scsi_read10_t)
+  };
+
+  scsi_read10_t const cmd = {
+    .cmd_code    = is_read ? SCSI_CMD_READ_10 : SCSI_CMD_WRITE_10,
+    .lba         = tu_htonl(lba),
+    .block_count = tu_htons(block_count)
+  };
+  memcpy(cbw.command, &cmd, sizeof(cmd));
+
+  TU_VERIFY(msc_xfer_sync(&xfer_out, &cbw, sizeof(cbw)));
+  bench_xfer_t* xfer_data = is_read ? &xfer_in : &xfer_out;
+  if (!msc_xfer_sync(xfer_data, buffer, (uint16_t) total_bytes)) {
+    TU_VERIFY(xfer_data->result == XFER_RESULT_STALLED);
+    TU_VERIFY(msc_clear_halt(xfer_data->ep_addr));
+  }
+  *xferred = xfer_data->actual_len;
+
+  msc_csw_t csw;
+  TU_VERIFY(msc_xfer_sync(&xfer_in, &csw, sizeof(csw)) && xfer_in.actual_len == sizeof(csw));
+  TU_VERIFY(csw.signature == MSC_CSW_SIGNATURE && csw.tag == _tag);
+
+  // device counts all data it got from host as transferred
+  TU_VERIFY(csw.data_residue == total_bytes - *xferred);
+
+  *status = csw.status;
+  return true;
+}
+
+static bool msc_rw10(bool is_read, uint32_t lba, uint16_t block_count, uint8_t* buffer) {
+  uint8_t status;
+  uint32_t xferred;
+
+  TU_VERIFY(msc_rw10_status(is_read, lba, block_count, buffer, &status, &xferred));
+  TU_VERIFY(status == MSC_CSW_STATUS_PASSED && xferred == (uint32_t) block_count * BENCH_MSC_BLOCK_SIZE);
+
+  return true;
+}
+
+uint64_t bench_msc_read(uint32_t total_bytes) {
+  static uint8_t rx_buf[BENCH_CHUNK_MAX];
+  uint16_t const block_count = BENCH_CHUNK_MAX / BENCH_MSC_BLOCK_SIZE;
+  uint32_t received = 0;
+
+  for (uint32_t lba = 0; lba < BENCH_MSC_BLOCK_NUM; lba++) {
+    memcpy(_disk[lba], bench_pattern(lba * BENCH_MSC_BLOCK_SIZE), BENCH_MSC_BLOCK_SIZE);
+  }
+
+  while (received < total_bytes) {
+    uint32_t const lba = (received / BENCH_MSC_BLOCK_SIZE) % (BENCH_MSC_BLOCK_NUM - block_count + 1);
+
+    TU_VERIFY(msc_rw10(true, lba, block_count, rx_buf), 0);
+    TU_VERIFY(bench_pattern_check(rx_buf, sizeof(rx_buf), lba * BENCH_MSC_BLOCK_SIZE), 0);
+
+    received += sizeof(rx_buf);
+  }
+
+  return received;
+}
+
+uint64_t bench_msc_write(uint32_t total_bytes) {
+  uint16_t const block_count = BENCH_CHUNK_MAX / BENCH_MSC_BLOCK_SIZE;
+  uint32_t sent = 0;
+
+  tu_memclr(_disk, sizeof(_disk));
+
+  while (sent < total_bytes) {
+    uint32_t const lba = (sent / BENCH_MSC_BLOCK_SIZE) % (BENCH_MSC_BLOCK_NUM - block_count + 1);
+    uint32_t const offset = lba * BENCH_MSC_BLOCK_SIZE;
+
+    TU_VERIFY(msc_rw10(false, lba, block_count, bench_pattern(offset)), 0);
+    TU_VERIFY(bench_pattern_check(_disk[lba], BENCH_CHUNK_MAX, offset), 0);
+
+    sent += BENCH_CHUNK_MAX;
+  }
+
+  return sent;
+}
+
+// Host writes then reads back each chunk while storage is slow: callbacks retry and consume partially with data stage
+// buffers in flight
+uint64_t bench_msc_busy(uint32_t total_bytes) {
+  static uint8_t rx_buf[BENCH_CHUNK_MAX];
+  uint16_t const block_count = BENCH_CHUNK_MAX / BENCH_MSC_BLOCK_SIZE;
+  uint32_t xferred = 0;
+
+  tu_memclr(_disk, sizeof(_disk));
+  _slow = true;
+  _slow_skip = false;
+
+  while (xferred < total_bytes) {
+    uint32_t const lba = (xferred / BENCH_MSC_BLOCK_SIZE) % (BENCH_MSC_BLOCK_NUM - block_count + 1);
+    uint32_t const offset = lba * BENCH_MSC_BLOCK_SIZE + xferred / 2;
+
+    TU_VERIFY(msc_rw10(false, lba, block_count, bench_pattern(offset)), 0);
+    TU_VERIFY(msc_rw10(true, lba, block_count, rx_buf), 0);
+    TU_VERIFY(bench_pattern_check(rx_buf, sizeof(rx_buf), offset), 0);
+
+    xferred += 2 * BENCH_CHUNK_MAX;
+  }
+
+  _slow = false;
+  return xferred;
+}
+
+// Same as msc_busy but storage completes read10/write10 in background: no retry, task is idle while storage is busy
+uint64_t bench_msc_async(uint32_t total_bytes) {
+  static uint8_t rx_buf[BENCH_CHUNK_MAX];
+  uint16_t const block_count = BENCH_CHUNK_MAX / BENCH_MSC_BLOCK_SIZE;
+  uint32_t xferred = 0;
+
+  tu_memclr(_disk, sizeof(_disk));
+  _async = true;
+
+  while (xferred < total_bytes) {
+    uint32_t const lba = (xferred / BENCH_MSC_BLOCK_SIZE) % (BENCH_MSC_BLOCK_NUM - block_count + 1);
+    uint32_t const offset = lba * BENCH_MSC_BLOCK_SIZE + xferred / 2;
+
+    TU_VERIFY(msc_rw10(false, lba, block_count, bench_pattern(offset)), 0);
+    TU_VERIFY(msc_rw10(true, lba, block_count, rx_buf), 0);
+    TU_VERIFY(bench_pattern_check(rx_buf, sizeof(rx_buf), offset), 0);
+
+    xferred += 2 * BENCH_CHUNK_MAX;
+  }
+
+  _async = false;
+  return xferred;
+}
+
+// Storage fails in the middle of each READ10/WRITE10 while earlier buffers are still transferred: data before the
+// failure is transferred, then a single failed CSW is sent with matching residue. Each command is followed by a
+// successful one. Reported bytes are those transferred before failures.
+uint64_t bench_msc_error(uint32_t total_bytes) {
+  (void) total_bytes;
+  static uint8_t rx_buf[BENCH_CHUNK_MAX];
+  uint16_t const block_count = BENCH_CHUNK_MAX / BENCH_MSC_BLOCK_SIZE;
+  uint32_t const fail_offset = 2 * CFG_TUD_MSC_EP_BUFSIZE;
+  uint64_t xferred_total = 0;
+
+  for (uint32_t lba = 0; lba < BENCH_MSC_BLOCK_NUM; lba++) {
+    memcpy(_disk[lba], bench_pattern(lba * BENCH_MSC_BLOCK_SIZE), BENCH_MSC_BLOCK_SIZE);
+  }
+
+  for (uint32_t i = 0; i < MSC_ERROR_ROUNDS; i++) {
+    uint8_t status;
+    uint32_t xferred;
+
+    _fail_lba = fail_offset / BENCH_MSC_BLOCK_SIZE;
+
+    // data before the failing block is read ahead and sent
+    tu_memclr(rx_buf, sizeof(rx_buf));
+    TU_VERIFY(msc_rw10_status(true, 0, block_count, rx_buf, &status, &xferred), 0);
+    TU_VERIFY(status == MSC_CSW_STATUS_FAILED && xferred == fail_offset, 0);
+    TU_VERIFY(bench_pattern_check(rx_buf, xferred, 0), 0);
+    xferred_total += xferred;
+
+    // data before the failing block is written, the rest is dropped
+    TU_VERIFY(msc_rw10_status(false, 0, block_count, bench_pattern(0), &status, &xferred), 0);
+    TU_VERIFY(status == MSC_CSW_STATUS_FAILED && xferred >= fail_offset, 0);
+    xferred_total += xferred;
+
+    _fail_lba = UINT32_MAX;
+    TU_VERIFY(msc_rw10(true, 0, block_count, rx_buf), 0);
+    TU_VERIFY(bench_pattern_check(rx_buf, sizeof(rx_buf), 0), 0);
+  }
+
+  return xferred_total;
+}
+
+//--------------------------------------------------------------------+
+// MSC callbacks
+//--------------------------------------------------------------------+
+void tud_msc_inquiry_cb(uint8_t lun, uint8_t vendor_id[8], uint8_t product_id[16], uint8_t product_rev[4]) {
+  (void) lun;
+
+  memcpy(vendor_id  , "TinyUSB ", 8);
+  memcpy(product_id , "Bench RAM Disk  ", 16);
+  memcpy(product_rev, "1.0 ", 4);
+}
+
+bool tud_msc_test_unit_ready_cb(uint8_t lun) {
+  (void) lun;
+  return true;
+}
+
+void tud_msc_capacity_cb(uint8_t lun, uint32_t* block_count, uint16_t* block_size) {
+  (void) lun;
+
+  *block_count = BENCH_MSC_BLOCK_NUM;
+  *block_size  = BENCH_MSC_BLOCK_SIZE;
+}
+
+int32_t tud_msc_read10_cb(uint8_t lun, uint32_t lba, uint32_t offset, void* buffer, uint32_t bufsize) {
+  (void) lun;
+  TU_VERIFY(lba < BENCH_MSC_BLOCK_NUM && lba != _fail_lba, -1);
+
+  if (_slow) {
+    _slow_skip = !_slow_skip;
+    if (_slow_skip) return 0;
+    bufsize = tu_min32(bufsize, BENCH_MSC_BLOCK_SIZE - offset);
+  }
+
+  if (_async) return storage_async_start(true, _disk[lba] + offset, buffer, bufsize);
+
+  memcpy(buffer, _disk[lba] + offset, bufsize);
+  return (int32_t) bufsize;
+}
+
+int32_t tud_msc_write10_cb(uint8_t lun, uint32_t lba, uint32_t offset, uint8_t* buffer, uint32_t bufsize) {
+  (void) lun;
+  TU_VERIFY(lba < BENCH_MSC_BLOCK_NUM && lba != _fail_lba, -1);
+
+  if (_slow) {
+    _slow_skip = !_slow_skip;
+    if (_slow_skip) return 0;
+    bufsize = tu_min32(bufsize, BENCH_MSC_BLOCK_SIZE - offset);
+  }
+
+  if (_async) return storage_async_start(false, _disk[lba] + offset, buffer, bufsize);
+
+  memcpy(_disk[lba] + offset, buffer, bufsize);
+  return (int32_t) bufsize;
+}
+
+int32_t tud_msc_scsi_cb(uint8_t lun, uint8_t const scsi_cmd[16], void* buffer, uint16_t bufsize) {
+  (void) scsi_cmd;
+  (void) buffer;
+  (void) bufsize;
+
+  // only READ10/WRITE10 are issued by benchmark
+  tud_msc_set_sense(lun, SCSI_SENSE_ILLEGAL_REQUEST, 0x20, 0x00);
+  return -1;
+}
@@ -0,0 +1,110 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Ha Thach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * This file is part of the TinyUSB stack.
+ */
+
+#include "bench.h"
+#include "class/net/ncm.h"
+
+#define NCM_FRAME_SIZE  CFG_TUD_NET_MTU
+
+static uint32_t _xmit_offset;
+
+// Sum up datagram length within a received NTB
+static uint32_t ntb_payload_len(uint8_t const* ntb, uint32_t len) {
+  nth16_t const* nth = (nth16_t const*) ntb;
+  TU_VERIFY(len >= sizeof(nth16_t) && nth->dwSignature == NTH16_SIGNATURE, 0);
+  TU_VERIFY(nth->wNdpIndex + sizeof(ndp16_t) <= len, 0);
+
+  ndp16_t const* ndp = (ndp16_t const*) (ntb + nth->wNdpIndex);
+  ndp16_datagram_t const* datagram = (ndp16_datagram_t const*) (ndp + 1);
+
+  uint32_t payload = 0;
+  while (datagram->wDatagramIndex != 0 && datagram->wDatagramLength != 0) {
+    payload += datagram->wDatagramLength;
+    datagram++;
+  }
+
+  return payload;
+}
+
+// Device -> Host: application queues full-size frames, host always has an NTB read pending
+uint64_t bench_ncm_in(uint32_t total_bytes) {
+  static uint8_t rx_buf[CFG_TUD_NCM_IN_NTB_MAX_SIZE];
+  bench_xfer_t xfer = { .ep_addr = EPNUM_NCM_IN };
+
+  uint32_t received = 0;
+  uint32_t idle = 0;
+  _xmit_offset = 0;
+
+  while (received < total_bytes) {
+    uint32_t const prev = received;
+
+    while (_xmit_offset < total_bytes && tud_network_can_xmit(NCM_FRAME_SIZE)) {
+      tud_network_xmit(NULL, NCM_FRAME_SIZE);
+    }
+
+    if (!xfer.busy) {
+      if (xfer.actual_len) {
+        uint32_t const payload = ntb_payload_len(rx_buf, xfer.actual_len);
+        TU_VERIFY(payload, 0);
+        received += payload;
+        xfer.actual_len = 0;
+      }
+
+      TU_VERIFY(bench_host_xfer(&xfer, rx_buf, sizeof(rx_buf)), 0);
+    }
+
+    bench_task();
+
+    idle = (received == prev) ? idle + 1 : 0;
+    TU_VERIFY(idle < BENCH_IDLE_MAX, 0);
+  }
+
+  return received;
+}
+
+//--------------------------------------------------------------------+
+// Network callbacks
+//--------------------------------------------------------------------+
+void tud_network_init_cb(void) {
+}
+
+bool tud_network_recv_cb(uint8_t const* src, uint16_t size) {
+  (void) src;
+  (void) size;
+
+  // benchmark does not receive, drop and renew
+  tud_network_recv_renew();
+  return true;
+}
+
+uint16_t tud_network_xmit_cb(uint8_t* dst, void* ref, uint16_t arg) {
+  (void) ref;
+
+  memcpy(dst, bench_pattern(_xmit_offset), arg);
+  _xmit_offset += arg;
+
+  return arg;
+}
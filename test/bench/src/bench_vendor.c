@@ -0,0 +1,62 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Ha Thach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * This file is part of the TinyUSB stack.
+ */
+
+#include "bench.h"
+
+// Device -> Host: application keeps tx stream full, host always has a read pending
+uint64_t bench_vendor_in(uint32_t total_bytes) {
+  static uint8_t rx_buf[BENCH_CHUNK_MAX];
+  bench_xfer_t xfer = { .ep_addr = EPNUM_VENDOR_IN };
+
+  uint32_t sent = 0;
+  uint32_t received = 0;
+  uint32_t idle = 0;
+
+  while (received < total_bytes) {
+    uint32_t const prev = received;
+
+    uint32_t const count = tu_min32(tud_vendor_n_write_available(0), total_bytes - sent);
+    if (count) {
+      sent += tud_vendor_n_write(0, bench_pattern(sent), tu_min32(count, BENCH_CHUNK_MAX));
+    }
+    tud_vendor_n_write_flush(0);
+
+    if (!xfer.busy) {
+      TU_VERIFY(bench_pattern_check(rx_buf, xfer.actual_len, received), 0);
+      received += xfer.actual_len;
+      xfer.actual_len = 0;
+
+      TU_VERIFY(bench_host_xfer(&xfer, rx_buf, sizeof(rx_buf)), 0);
+    }
+
+    bench_task();
+
+    idle = (received == prev) ? idle + 1 : 0;
+    TU_VERIFY(idle < BENCH_IDLE_MAX, 0);
+  }
+
+  return received;
+}
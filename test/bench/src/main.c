@@ -0,0 +1,431 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Ha Thach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * This file is part of the TinyUSB stack.
+ */
+
+/* Class driver throughput benchmark
+ *
+ * Device and host stack run in the same process, wired together by the software loopback port
+ * (src/portable/sim). Host side of each case drives the device endpoints directly with tuh_edpt_xfer()
+ * while device side uses the public class API e.g tud_cdc_n_write(). Results are printed as JSON:
+ * - bytes_per_s, transfers_per_s: wall clock throughput of payload and completed device transfers
+ * - cycles_per_byte: cpu cycles (time stamp counter where available, nanoseconds otherwise) per payload byte
+ * - bus_rounds: number of bus passes that made progress, lower means more work is done per device task run
+ * - peak_dev_queue, peak_host_queue: high-water mark of device/host event queue
+ * - setup_wait_max, setup_cycles_max: worst case number of data transfers handled and cpu cycles spent by device
+ *   between SETUP received and its handling, only measured by cases issuing control requests e.g ctrl_latency
+ * - ctrl_cycles_max: worst case cpu cycles of a control transfer from host submit to completion e.g ctrl_in
+ * - int_masked, int_masked_cycles: number of times and cpu cycles the device or host port interrupt is masked
+ *   by the stack e.g to lock the event queue, i.e added interrupt latency on a MCU
+ *
+ * Usage: bench [-n total_bytes] [case ...]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "bench.h"
+#include "device/dcd.h"
+#include "portable/sim/sim_bus.h"
+
+//--------------------------------------------------------------------+
+// MACRO CONSTANT TYPEDEF PROTYPES
+//--------------------------------------------------------------------+
+#define DEFAULT_TOTAL_BYTES   (32u*1024*1024)
+
+static bench_case_t const _cases[] = {
+  { .name = "cdc_in"       , .run = bench_cdc_in        },
+  { .name = "cdc_out"      , .run = bench_cdc_out       },
+#if CFG_TUD_CDC_TX_FLUSH_MS
+  { .name = "cdc_in_timer" , .run = bench_cdc_in_timer  },
+#endif
+  { .name = "cdc_line"     , .run = bench_cdc_line      },
+  { .name = "msc_read"     , .run = bench_msc_read      },
+  { .name = "msc_write"    , .run = bench_msc_write     },
+  { .name = "msc_busy"     , .run = bench_msc_busy      },
+  { .name = "msc_async"    , .run = bench_msc_async     },
+  { .name = "msc_error"    , .run = bench_msc_error     },
+  { .name = "ncm_in"       , .run = bench_ncm_in        },
+  { .name = "vendor_in"    , .run = bench_vendor_in     },
+  { .name = "hid_in"       , .run = bench_hid_in        },
+  { .name = "ctrl_latency" , .run = bench_ctrl_latency  },
+  { .name = "ctrl_in"      , .run = bench_ctrl_in       },
+  { .name = "ctrl_in_zcopy", .run = bench_ctrl_in_zcopy },
+  { .name = "bulk_in"      , .run = bench_bulk_in       },
+  { .name = "bulk_in_queue", .run = bench_bulk_in_queue },
+  { .name = "bulk_in_isr"  , .run = bench_bulk_in_isr   },
+  { .name = "set_config"   , .run = bench_set_config    },
+  { .name = "set_cfg_xfer" , .run = bench_set_config_xfer },
+#if CFG_TUD_STATS && CFG_TUH_STATS
+  { .name = "stats"        , .run = bench_stats         },
+#endif
+#if CFG_TUSB_OS == OPT_OS_NONE && CFG_TUSB_OS_NONE_WAIT
+  { .name = "idle_wait"    , .run = bench_idle_wait     },
+#endif
+#if CFG_TUD_DEFER_QUEUE_SZ && CFG_TUH_DEFER_QUEUE_SZ
+  { .name = "defer"        , .run = bench_defer         },
+#endif
+};
+
+uint8_t bench_daddr = 0;
+
+static bench_result_t _result;
+static uint32_t _dev_queued;
+static uint32_t _host_queued;
+
+#if CFG_TUSB_OS == OPT_OS_NONE && CFG_TUSB_OS_NONE_WAIT
+static uint32_t _idle_waits;
+#endif
+
+static bool _setup_pending;
+static uint32_t _setup_wait;
+static uint64_t _setup_cycles;
+
+static uint64_t get_nsec(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000000u + (uint64_t) ts.tv_nsec;
+}
+
+static uint64_t get_cycles(void) {
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  return get_nsec();
+#endif
+}
+
+//--------------------------------------------------------------------+
+// Stack callbacks
+//--------------------------------------------------------------------+
+uint32_t tusb_timestamp_cb(void) {
+  return (uint32_t) get_cycles();
+}
+
+void tud_event_hook_cb(uint8_t rhport, uint32_t eventid, bool in_isr) {
+  (void) rhport;
+  (void) in_isr;
+
+  _dev_queued++;
+  if (_dev_queued > _result.peak_dev_queue) _result.peak_dev_queue = _dev_queued;
+  if (eventid == DCD_EVENT_XFER_COMPLETE) _result.transfers++;
+
+  if (eventid == DCD_EVENT_SETUP_RECEIVED) {
+    _setup_pending = true;
+    _setup_wait    = 0;
+    _setup_cycles  = get_cycles();
+  }
+}
+
+void tuh_event_hook_cb(uint8_t rhport, uint32_t eventid, bool in_isr) {
+  (void) rhport;
+  (void) eventid;
+  (void) in_isr;
+
+  _host_queued++;
+  if (_host_queued > _result.peak_host_queue) _result.peak_host_queue = _host_queued;
+}
+
+#if CFG_TUSB_OS == OPT_OS_NONE && CFG_TUSB_OS_NONE_WAIT
+// Nothing to sleep on: bus only makes progress when harness calls sim_bus_task()
+void osal_none_wait_for_event(uint32_t msec) {
+  (void) msec;
+  _idle_waits++;
+}
+#endif
+
+void tuh_mount_cb(uint8_t daddr) {
+  bench_daddr = daddr;
+}
+
+void tuh_umount_cb(uint8_t daddr) {
+  (void) daddr;
+  bench_daddr = 0;
+}
+
+//--------------------------------------------------------------------+
+// Harness API
+//--------------------------------------------------------------------+
+void bench_task(void) {
+  while (1) {
+    // both tasks return once their queue is drained
+    tud_task_ext(0, false);
+    _dev_queued = 0;
+
+    tuh_task_ext(0, false);
+    _host_queued = 0;
+
+    if (!sim_bus_task()) break;
+    _result.bus_rounds++;
+  }
+}
+
+#if CFG_TUSB_OS == OPT_OS_NONE && CFG_TUSB_OS_NONE_WAIT
+bool bench_task_sleep(uint32_t timeout_ms) {
+  bool const dev_ready = tud_task_event_ready();
+  uint32_t waits = _idle_waits;
+  tud_task_ext(timeout_ms, false);
+  _dev_queued = 0;
+  bool const dev_ok = (_idle_waits == waits + (dev_ready ? 0 : 1));
+
+  bool const host_ready = tuh_task_event_ready();
+  waits = _idle_waits;
+  tuh_task_ext(timeout_ms, false);
+  _host_queued = 0;
+  bool const host_ok = (_idle_waits == waits + (host_ready ? 0 : 1));
+
+  if (sim_bus_task()) _result.bus_rounds++;
+
+  return dev_ok && host_ok;
+}
+#endif
+
+static void host_xfer_cb(tuh_xfer_t* xfer) {
+  bench_xfer_t* bxfer = (bench_xfer_t*) xfer->user_data;
+  bxfer->result     = xfer->result;
+  bxfer->actual_len = xfer->actual_len;
+  bxfer->busy       = false;
+}
+
+bool bench_host_xfer(bench_xfer_t* bxfer, void* buffer, uint16_t len) {
+  tuh_xfer_t xfer = {
+    .daddr       = bench_daddr,
+    .ep_addr     = bxfer->ep_addr,
+    .buflen      = len,
+    .buffer      = (uint8_t*) buffer,
+    .complete_cb = host_xfer_cb,
+    .user_data   = (uintptr_t) bxfer
+  };
+
+  bxfer->busy = true;
+  if (!tuh_edpt_xfer(&xfer)) {
+    bxfer->busy = false;
+    return false;
+  }
+
+  return true;
+}
+
+bool bench_host_xfer_sync(bench_xfer_t* bxfer, void* buffer, uint16_t len) {
+  TU_VERIFY(bench_host_xfer(bxfer, buffer, len));
+
+  while (bxfer->busy) {
+    bench_task();
+  }
+
+  return bxfer->result == XFER_RESULT_SUCCESS;
+}
+
+uint8_t* bench_pattern(uint32_t offset) {
+  static uint8_t pattern[256 + BENCH_CHUNK_MAX];
+  static bool inited = false;
+
+  if (!inited) {
+    for (uint32_t i = 0; i < sizeof(pattern); i++) {
+      pattern[i] = (uint8_t) i;
+    }
+    inited = true;
+  }
+
+  return pattern + (offset & 0xff);
+}
+
+bool bench_pattern_check(uint8_t const* buffer, uint32_t len, uint32_t offset) {
+  return 0 == memcmp(buffer, bench_pattern(offset), len);
+}
+
+uint64_t bench_cycles(void) {
+  return get_cycles();
+}
+
+void bench_ctrl_complete(uint64_t start_cycles) {
+  uint64_t const cycles = get_cycles() - start_cycles;
+  if (cycles > _result.ctrl_cycles_max) _result.ctrl_cycles_max = cycles;
+}
+
+void bench_data_handled(void) {
+  if (_setup_pending) _setup_wait++;
+}
+
+void bench_setup_handled(void) {
+  if (!_setup_pending) return;
+  _setup_pending = false;
+
+  uint64_t const cycles = get_cycles() - _setup_cycles;
+  if (_setup_wait > _result.setup_wait_max) _result.setup_wait_max = _setup_wait;
+  if (cycles > _result.setup_cycles_max) _result.setup_cycles_max = cycles;
+}
+
+// Collect interrupt masking of both ports into result
+static void int_mask_stats(bool discard) {
+  for (uint8_t host = 0; host < 2; host++) {
+    sim_int_mask_stats_t stats;
+    sim_bus_int_mask_stats(host, &stats, true);
+    if (!discard) {
+      _result.int_masked        += stats.count;
+      _result.int_masked_cycles += stats.time;
+    }
+  }
+}
+
+//--------------------------------------------------------------------+
+// Setup
+//--------------------------------------------------------------------+
+static volatile bool _set_itf_done;
+
+static void set_interface_cb(tuh_xfer_t* xfer) {
+  (void) xfer;
+  _set_itf_done = true;
+}
+
+static bool open_endpoint(uint8_t ep_addr, uint8_t xfer_type, uint16_t size) {
+  tusb_desc_endpoint_t const desc_ep = {
+    .bLength          = sizeof(tusb_desc_endpoint_t),
+    .bDescriptorType  = TUSB_DESC_ENDPOINT,
+    .bEndpointAddress = ep_addr,
+    .bmAttributes     = { .xfer = xfer_type },
+    .wMaxPacketSize   = size,
+    .bInterval        = (xfer_type == TUSB_XFER_INTERRUPT) ? 1 : 0
+  };
+
+  return tuh_edpt_open(bench_daddr, &desc_ep);
+}
+
+static bool bench_setup(void) {
+  tud_init(BOARD_TUD_RHPORT);
+  tuh_init(BOARD_TUH_RHPORT);
+
+  for (uint32_t i = 0; i < 1000 && !(bench_daddr && tud_mounted()); i++) {
+    bench_task();
+  }
+  TU_VERIFY(bench_daddr && tud_mounted());
+
+  uint8_t const bulk_ep[] = {
+    EPNUM_CDC_OUT, EPNUM_CDC_IN, EPNUM_MSC_OUT, EPNUM_MSC_IN, EPNUM_NCM_OUT, EPNUM_NCM_IN,
+    EPNUM_VENDOR_OUT, EPNUM_VENDOR_IN, EPNUM_BULK_OUT, EPNUM_BULK_IN
+  };
+
+  for (size_t i = 0; i < sizeof(bulk_ep); i++) {
+    TU_VERIFY(open_endpoint(bulk_ep[i], TUSB_XFER_BULK, BENCH_BULK_SIZE));
+  }
+  TU_VERIFY(open_endpoint(EPNUM_HID_OUT, TUSB_XFER_INTERRUPT, BENCH_HID_REPORT_SIZE));
+  TU_VERIFY(open_endpoint(EPNUM_HID_IN, TUSB_XFER_INTERRUPT, BENCH_HID_REPORT_SIZE));
+
+  // NCM data endpoints are only active with alternate setting 1
+  TU_VERIFY(tuh_interface_set(bench_daddr, ITF_NUM_NCM_DATA, 1, set_interface_cb, 0));
+  while (!_set_itf_done) {
+    bench_task();
+  }
+
+  return true;
+}
+
+//--------------------------------------------------------------------+
+// Main
+//--------------------------------------------------------------------+
+static bool case_selected(char const* name, int argc, char* argv[], int first) {
+  if (first >= argc) return true;
+
+  for (int i = first; i < argc; i++) {
+    if (strcmp(name, argv[i]) == 0) return true;
+  }
+  return false;
+}
+
+int main(int argc, char* argv[]) {
+  uint32_t total_bytes = DEFAULT_TOTAL_BYTES;
+  int first_case = 1;
+
+  if (argc > 2 && strcmp(argv[1], "-n") == 0) {
+    total_bytes = (uint32_t) strtoul(argv[2], NULL, 0);
+    first_case = 3;
+  }
+
+  if (!bench_setup()) {
+    fprintf(stderr, "Failed to enumerate benchmark device\r\n");
+    return 1;
+  }
+
+  int failed = 0;
+  bool first_result = true;
+
+  printf("{\n");
+  printf("  \"speed\": \"%s\",\n", (tud_speed_get() == TUSB_SPEED_HIGH) ? "high" : "full");
+  printf("  \"total_bytes\": %lu,\n", (unsigned long) total_bytes);
+  printf("  \"results\": [");
+
+  for (size_t i = 0; i < TU_ARRAY_SIZE(_cases); i++) {
+    bench_case_t const* bcase = &_cases[i];
+    if (!case_selected(bcase->name, argc, argv, first_case)) continue;
+
+    tu_varclr(&_result);
+    int_mask_stats(true); // discard masking of previous case
+
+    uint64_t const start_nsec   = get_nsec();
+    uint64_t const start_cycles = get_cycles();
+
+    _result.bytes = bcase->run(total_bytes);
+
+    _result.cycles = get_cycles() - start_cycles;
+    _result.nsec   = get_nsec() - start_nsec;
+    int_mask_stats(false);
+
+    if (_result.bytes == 0) {
+      fprintf(stderr, "%s: failed\r\n", bcase->name);
+      failed++;
+      continue;
+    }
+
+    double const sec = (_result.nsec ? (double) _result.nsec : 1.0) / 1e9;
+
+    printf("%s\n    {\n", first_result ? "" : ",");
+    printf("      \"name\": \"%s\",\n", bcase->name);
+    printf("      \"bytes\": %llu,\n", (unsigned long long) _result.bytes);
+    printf("      \"transfers\": %llu,\n", (unsigned long long) _result.transfers);
+    printf("      \"bytes_per_s\": %.0f,\n", (double) _result.bytes / sec);
+    printf("      \"transfers_per_s\": %.0f,\n", (double) _result.transfers / sec);
+    printf("      \"bus_rounds\": %llu,\n", (unsigned long long) _result.bus_rounds);
+    printf("      \"cycles_per_byte\": %.3f,\n", (double) _result.cycles / (double) _result.bytes);
+    printf("      \"peak_dev_queue\": %lu,\n", (unsigned long) _result.peak_dev_queue);
+    printf("      \"peak_host_queue\": %lu,\n", (unsigned long) _result.peak_host_queue);
+    printf("      \"setup_wait_max\": %lu,\n", (unsigned long) _result.setup_wait_max);
+    printf("      \"setup_cycles_max\": %llu,\n", (unsigned long long) _result.setup_cycles_max);
+    printf("      \"ctrl_cycles_max\": %llu,\n", (unsigned long long) _result.ctrl_cycles_max);
+    printf("      \"int_masked\": %llu,\n", (unsigned long long) _result.int_masked);
+    printf("      \"int_masked_cycles\": %llu\n", (unsigned long long) _result.int_masked_cycles);
+    printf("    }");
+
+    first_result = false;
+  }
+
+  printf("\n  ]\n}\n");
+
+  return failed ? 1 : 0;
+}
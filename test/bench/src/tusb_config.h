@@ -0,0 +1,195 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Ha Thach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * This file is part of the TinyUSB stack.
+ */
+
+#ifndef _TUSB_CONFIG_H_
+#define _TUSB_CONFIG_H_
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+// All buffer sizes below can be overridden from command line for tuning
+// e.g make BENCH_CFLAGS="-DCFG_TUD_CDC_TX_BUFSIZE=4096"
+
+//--------------------------------------------------------------------
+// Common Configuration
+//--------------------------------------------------------------------
+#define CFG_TUSB_MCU              OPT_MCU_SIM
+
+#ifndef CFG_TUSB_OS
+#define CFG_TUSB_OS               OPT_OS_NONE
+#endif
+
+// Task sleeps in osal_none_wait_for_event() when idle, only exercised by idle_wait since harness runs task without
+// timeout
+#ifndef CFG_TUSB_OS_NONE_WAIT
+#define CFG_TUSB_OS_NONE_WAIT     1
+#endif
+
+#ifndef CFG_TUSB_DEBUG
+#define CFG_TUSB_DEBUG            0
+#endif
+
+#define CFG_TUSB_MEM_SECTION
+#define CFG_TUSB_MEM_ALIGN        __attribute__ ((aligned(4)))
+
+#define BOARD_TUD_RHPORT          0
+#define BOARD_TUH_RHPORT          1
+
+//--------------------------------------------------------------------
+// Device Configuration
+//--------------------------------------------------------------------
+#define CFG_TUD_ENABLED           1
+
+#ifndef CFG_TUD_MAX_SPEED
+#define CFG_TUD_MAX_SPEED         OPT_MODE_HIGH_SPEED
+#endif
+
+#define CFG_TUD_ENDPOINT0_SIZE    64
+
+// Control data stage directly from application buffer, used by ctrl_in_zcopy
+#ifndef CFG_TUD_CTRL_ZERO_COPY
+#define CFG_TUD_CTRL_ZERO_COPY    1
+#endif
+
+// Re-configuration opens drivers from cached binding, used by set_config
+#ifndef CFG_TUD_SET_CONFIG_CACHE
+#define CFG_TUD_SET_CONFIG_CACHE  1
+#endif
+
+// Stack counters, dumped by stats
+#ifndef CFG_TUD_STATS
+#define CFG_TUD_STATS             1
+#endif
+
+#ifndef CFG_TUD_EVENT_LATENCY
+#define CFG_TUD_EVENT_LATENCY     1
+#endif
+
+#ifndef CFG_TUD_TASK_QUEUE_SZ
+#define CFG_TUD_TASK_QUEUE_SZ     16
+#endif
+
+// Transfers queued per endpoint by usbd_edpt_xfer_queue(), used by bulk_in_queue
+#ifndef CFG_TUD_EDPT_XFER_QUEUE
+#define CFG_TUD_EDPT_XFER_QUEUE   4
+#endif
+
+// Pending usbd_defer_func() calls, used by defer
+#ifndef CFG_TUD_DEFER_QUEUE_SZ
+#define CFG_TUD_DEFER_QUEUE_SZ    8
+#endif
+
+#define CFG_TUD_CDC               1
+#define CFG_TUD_MSC               1
+#define CFG_TUD_NCM               1
+#define CFG_TUD_VENDOR            1
+#define CFG_TUD_HID               1
+
+// cdc_line needs room for a packet while a partial line is pending
+#ifndef CFG_TUD_CDC_RX_BUFSIZE
+#define CFG_TUD_CDC_RX_BUFSIZE    1024
+#endif
+
+#ifndef CFG_TUD_CDC_TX_BUFSIZE
+#define CFG_TUD_CDC_TX_BUFSIZE    512
+#endif
+
+#ifndef CFG_TUD_CDC_EP_BUFSIZE
+#define CFG_TUD_CDC_EP_BUFSIZE    512
+#endif
+
+// OUT transfers land in rx fifo without endpoint buffer copy, used by cdc_out
+#ifndef CFG_TUD_CDC_RX_DIRECT
+#define CFG_TUD_CDC_RX_DIRECT     1
+#endif
+
+// Small writes are sent by timer, used by cdc_in_timer
+#ifndef CFG_TUD_CDC_TX_FLUSH_MS
+#define CFG_TUD_CDC_TX_FLUSH_MS   1
+#endif
+
+#ifndef CFG_TUD_MSC_EP_BUFSIZE
+#define CFG_TUD_MSC_EP_BUFSIZE    4096
+#endif
+
+// Next READ10/WRITE10 buffer is processed by storage while previous one is on the bus
+#ifndef CFG_TUD_MSC_BUF_COUNT
+#define CFG_TUD_MSC_BUF_COUNT     2
+#endif
+
+#ifndef CFG_TUD_VENDOR_EPSIZE
+#define CFG_TUD_VENDOR_EPSIZE     512
+#endif
+
+#ifndef CFG_TUD_VENDOR_RX_BUFSIZE
+#define CFG_TUD_VENDOR_RX_BUFSIZE 512
+#endif
+
+#ifndef CFG_TUD_VENDOR_TX_BUFSIZE
+#define CFG_TUD_VENDOR_TX_BUFSIZE 512
+#endif
+
+#ifndef CFG_TUD_HID_EP_BUFSIZE
+#define CFG_TUD_HID_EP_BUFSIZE    64
+#endif
+
+// NCM buffer count and size are defaulted in class/net/ncm.h
+
+//--------------------------------------------------------------------
+// Host Configuration
+//--------------------------------------------------------------------
+#define CFG_TUH_ENABLED           1
+
+#ifndef CFG_TUH_MAX_SPEED
+#define CFG_TUH_MAX_SPEED         OPT_MODE_HIGH_SPEED
+#endif
+
+#define CFG_TUH_ENUMERATION_BUFSIZE 512
+#define CFG_TUH_DEVICE_MAX        1
+#define CFG_TUH_HUB               0
+
+// Host side of each benchmark drives endpoints directly, no class driver is used
+#define CFG_TUH_API_EDPT_XFER     1
+
+#ifndef CFG_TUH_STATS
+#define CFG_TUH_STATS             1
+#endif
+
+#ifndef CFG_TUH_EVENT_LATENCY
+#define CFG_TUH_EVENT_LATENCY     1
+#endif
+
+// Pending usbh_defer_func() calls, used by defer
+#ifndef CFG_TUH_DEFER_QUEUE_SZ
+#define CFG_TUH_DEFER_QUEUE_SZ    8
+#endif
+
+#ifdef __cplusplus
+ }
+#endif
+
+#endif /* _TUSB_CONFIG_H_ */
@@ -0,0 +1,146 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Ha Thach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * This file is part of the TinyUSB stack.
+ */
+
+// Compile-time only: benchmark configuration built with device/usbd_desc.hpp must match the hand-assembled
+// descriptor of usb_descriptors.c, and check() must catch common descriptor mistakes.
+
+#include "bench.h"
+#include "device/usbd_desc.hpp"
+
+namespace desc = tud::desc;
+
+enum {
+  STRID_MAC = 4
+};
+
+static constexpr uint8_t desc_hid_report[] = {
+  TUD_HID_REPORT_DESC_GENERIC_INOUT(BENCH_HID_REPORT_SIZE)
+};
+
+#define CONFIG_TOTAL_LEN  (TUD_CONFIG_DESC_LEN + TUD_CDC_DESC_LEN + TUD_MSC_DESC_LEN + TUD_CDC_NCM_DESC_LEN + \
+                           TUD_VENDOR_DESC_LEN + TUD_HID_INOUT_DESC_LEN + TUD_VENDOR_DESC_LEN)
+
+static constexpr uint8_t desc_configuration[] = {
+  TUD_CONFIG_DESCRIPTOR(1, ITF_NUM_TOTAL, 0, CONFIG_TOTAL_LEN, 0x00, 100),
+  TUD_CDC_DESCRIPTOR(ITF_NUM_CDC, 0, EPNUM_CDC_NOTIF, 8, EPNUM_CDC_OUT, EPNUM_CDC_IN, BENCH_BULK_SIZE),
+  TUD_MSC_DESCRIPTOR(ITF_NUM_MSC, 0, EPNUM_MSC_OUT, EPNUM_MSC_IN, BENCH_BULK_SIZE),
+  TUD_CDC_NCM_DESCRIPTOR(ITF_NUM_NCM, 0, STRID_MAC, EPNUM_NCM_NOTIF, 64, EPNUM_NCM_OUT, EPNUM_NCM_IN,
+                         BENCH_BULK_SIZE, CFG_TUD_NET_MTU),
+  TUD_VENDOR_DESCRIPTOR(ITF_NUM_VENDOR, 0, EPNUM_VENDOR_OUT, EPNUM_VENDOR_IN, BENCH_BULK_SIZE),
+  TUD_HID_INOUT_DESCRIPTOR(ITF_NUM_HID, 0, HID_ITF_PROTOCOL_NONE, sizeof(desc_hid_report), EPNUM_HID_OUT,
+                           EPNUM_HID_IN, BENCH_HID_REPORT_SIZE, 1),
+  TUD_VENDOR_DESCRIPTOR(ITF_NUM_BULK, 0, EPNUM_BULK_OUT, EPNUM_BULK_IN, BENCH_BULK_SIZE),
+};
+
+static constexpr auto desc_built = desc::configuration(1, 0, 0x00, 100,
+  desc::function({ TUD_CDC_DESCRIPTOR(ITF_NUM_CDC, 0, EPNUM_CDC_NOTIF, 8, EPNUM_CDC_OUT, EPNUM_CDC_IN, BENCH_BULK_SIZE) }),
+  desc::function({ TUD_MSC_DESCRIPTOR(ITF_NUM_MSC, 0, EPNUM_MSC_OUT, EPNUM_MSC_IN, BENCH_BULK_SIZE) }),
+  desc::function({ TUD_CDC_NCM_DESCRIPTOR(ITF_NUM_NCM, 0, STRID_MAC, EPNUM_NCM_NOTIF, 64, EPNUM_NCM_OUT, EPNUM_NCM_IN,
+                                          BENCH_BULK_SIZE, CFG_TUD_NET_MTU) }),
+  desc::function({ TUD_VENDOR_DESCRIPTOR(ITF_NUM_VENDOR, 0, EPNUM_VENDOR_OUT, EPNUM_VENDOR_IN, BENCH_BULK_SIZE) }),
+  desc::function({ TUD_HID_INOUT_DESCRIPTOR(ITF_NUM_HID, 0, HID_ITF_PROTOCOL_NONE, sizeof(desc_hid_report),
+                                            EPNUM_HID_OUT, EPNUM_HID_IN, BENCH_HID_REPORT_SIZE, 1) }),
+  desc::function({ TUD_VENDOR_DESCRIPTOR(ITF_NUM_BULK, 0, EPNUM_BULK_OUT, EPNUM_BULK_IN, BENCH_BULK_SIZE) }));
+
+static constexpr bool same_bytes(uint8_t const* a, uint8_t const* b, size_t len) {
+  for (size_t i = 0; i < len; i++) {
+    if (a[i] != b[i]) return false;
+  }
+  return true;
+}
+
+//--------------------------------------------------------------------+
+// Builder
+//--------------------------------------------------------------------+
+static_assert(desc_built.size == sizeof(desc_configuration), "builder length mismatch");
+static_assert(same_bytes(desc_built.data, desc_configuration, sizeof(desc_configuration)), "builder bytes mismatch");
+
+static_assert(desc::check(desc_configuration, TUSB_SPEED_HIGH) == desc::error::none, "");
+static_assert(desc_built.check(TUSB_SPEED_HIGH) == desc::error::none, "");
+
+// bulk endpoints are 512 bytes, not valid for full speed
+static_assert(desc_built.check(TUSB_SPEED_FULL) == desc::error::packet_size, "");
+
+static_assert(desc_built.func_count == 6, "");
+static_assert(desc_built.func_offset[1] == TUD_CONFIG_DESC_LEN + TUD_CDC_DESC_LEN, "");
+static_assert(desc_built.func_len[2] == TUD_CDC_NCM_DESC_LEN, "");
+
+static_assert(desc_built.itf2func[ITF_NUM_CDC_DATA] == 0, "");
+static_assert(desc_built.itf2func[ITF_NUM_NCM_DATA] == 2, "");
+static_assert(desc_built.itf2func[ITF_NUM_BULK] == 5, "");
+static_assert(desc_built.itf2func[ITF_NUM_TOTAL] == desc::FUNC_INVALID, "");
+static_assert(desc_built.ep2func[desc::detail::edpt_number(EPNUM_MSC_IN)][TUSB_DIR_IN] == 1, "");
+static_assert(desc_built.ep2func[desc::detail::edpt_number(EPNUM_HID_OUT)][TUSB_DIR_OUT] == 4, "");
+static_assert(desc_built.ep2func[desc::detail::edpt_number(EPNUM_CDC_NOTIF)][TUSB_DIR_OUT] == desc::FUNC_INVALID, "");
+
+//--------------------------------------------------------------------+
+// Validation
+//--------------------------------------------------------------------+
+#define VENDOR_FS(_itf, _epout, _epin)  desc::function({ TUD_VENDOR_DESCRIPTOR(_itf, 0, _epout, _epin, 64) })
+
+static_assert(desc::configuration(1, 0, 0, 100, VENDOR_FS(0, 0x01, 0x81), VENDOR_FS(1, 0x02, 0x82))
+              .check(TUSB_SPEED_FULL) == desc::error::none, "");
+
+// interface number skipped
+static_assert(desc::configuration(1, 0, 0, 100, VENDOR_FS(0, 0x01, 0x81), VENDOR_FS(2, 0x02, 0x82))
+              .check(TUSB_SPEED_FULL) == desc::error::interface_number, "");
+
+// same endpoint in two interfaces
+static_assert(desc::configuration(1, 0, 0, 100, VENDOR_FS(0, 0x01, 0x81), VENDOR_FS(1, 0x02, 0x81))
+              .check(TUSB_SPEED_FULL) == desc::error::endpoint_duplicate, "");
+
+// endpoint 0 and reserved address bits
+static_assert(desc::configuration(1, 0, 0, 100, VENDOR_FS(0, 0x00, 0x81))
+              .check(TUSB_SPEED_FULL) == desc::error::endpoint_number, "");
+static_assert(desc::configuration(1, 0, 0, 100, VENDOR_FS(0, 0x11, 0x81))
+              .check(TUSB_SPEED_FULL) == desc::error::endpoint_number, "");
+
+// bNumEndpoints is 2 but only one endpoint follows
+static_assert(desc::configuration(1, 0, 0, 100,
+                desc::function({ 9, TUSB_DESC_INTERFACE, 0, 0, 2, TUSB_CLASS_VENDOR_SPECIFIC, 0, 0, 0,
+                                 7, TUSB_DESC_ENDPOINT, 0x81, TUSB_XFER_BULK, U16_TO_U8S_LE(64), 0 }))
+              .check(TUSB_SPEED_FULL) == desc::error::endpoint_count, "");
+
+// IAD claims more interfaces than configuration has
+static_assert(desc::configuration(1, 0, 0, 100,
+                desc::function({ 8, TUSB_DESC_INTERFACE_ASSOCIATION, 0, 2, TUSB_CLASS_VENDOR_SPECIFIC, 0, 0, 0,
+                                 TUD_VENDOR_DESCRIPTOR(0, 0, 0x01, 0x81, 64) }))
+              .check(TUSB_SPEED_FULL) == desc::error::association, "");
+
+// 1023-byte isochronous endpoint is valid on its own, two of them exceed 90% of a full speed frame
+#define ISO_FS(_itf, _ep) desc::function({ 9, TUSB_DESC_INTERFACE, _itf, 0, 1, TUSB_CLASS_VENDOR_SPECIFIC, 0, 0, 0, \
+                                           7, TUSB_DESC_ENDPOINT, _ep, TUSB_XFER_ISOCHRONOUS, U16_TO_U8S_LE(1023), 1 })
+
+static_assert(desc::configuration(1, 0, 0, 100, ISO_FS(0, 0x81)).check(TUSB_SPEED_FULL) == desc::error::none, "");
+static_assert(desc::configuration(1, 0, 0, 100, ISO_FS(0, 0x81), ISO_FS(1, 0x82))
+              .check(TUSB_SPEED_FULL) == desc::error::bandwidth, "");
+
+// wTotalLength does not match
+static constexpr uint8_t desc_bad_total[] = {
+  TUD_CONFIG_DESCRIPTOR(1, 1, 0, TUD_CONFIG_DESC_LEN + TUD_VENDOR_DESC_LEN + 1, 0x00, 100),
+  TUD_VENDOR_DESCRIPTOR(0, 0, 0x01, 0x81, 64)
+};
+static_assert(desc::check(desc_bad_total, TUSB_SPEED_FULL) == desc::error::structure, "");
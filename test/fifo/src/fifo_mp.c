@@ -0,0 +1,210 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Ha Thach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * This file is part of the TinyUSB stack.
+ */
+
+/* Stress and throughput test for multiple producers writing to a single fifo.
+ *
+ * Each producer thread writes its own sequence number tagged with its id in random sized chunks,
+ * a single consumer reads everything back and checks that no item is lost, duplicated or
+ * re-ordered within a producer. The same workload runs twice: producers serialized by mutex_wr
+ * and lock-free multiple producer mode (CFG_TUSB_FIFO_MULTI_PRODUCER).
+ *
+ *   fifo_mp [-p producers] [-n items per producer] [-d depth]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sched.h>
+#include <pthread.h>
+#include <time.h>
+
+#include "common/tusb_fifo.h"
+
+#define PRODUCER_MAX   16
+#define CHUNK_MAX      16
+#define READ_MAX       64
+#define DEPTH_MAX      4096
+
+#define ITEM(_id, _seq)  (((uint32_t) (_id) << 24) | (_seq))
+#define ITEM_ID(_item)   ((_item) >> 24)
+#define ITEM_SEQ(_item)  ((_item) & 0xFFFFFFu)
+
+typedef struct {
+  pthread_t thread;
+  uint8_t   id;
+  uint32_t  count;
+  uint32_t  retry; // number of times fifo was full
+} producer_t;
+
+static tu_fifo_t _ff;
+static uint32_t _ff_buf[DEPTH_MAX];
+static osal_mutex_def_t _mutex_wr_def, _mutex_rd_def;
+
+static producer_t _producer[PRODUCER_MAX];
+static uint8_t _producer_num = 4;
+static uint32_t _item_num = 1000000;
+static uint16_t _depth = 256;
+
+static double time_now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double) ts.tv_sec + (double) ts.tv_nsec * 1e-9;
+}
+
+static void* producer_thread(void* arg) {
+  producer_t* p = (producer_t*) arg;
+  uint32_t rand_state = 0x9E3779B9u * (p->id + 1u);
+  uint32_t buf[CHUNK_MAX];
+  uint32_t seq = 0;
+
+  while (seq < p->count) {
+    // xorshift32
+    rand_state ^= rand_state << 13;
+    rand_state ^= rand_state >> 17;
+    rand_state ^= rand_state << 5;
+
+    uint16_t n = (uint16_t) (1 + rand_state % CHUNK_MAX);
+    if (n > p->count - seq) n = (uint16_t) (p->count - seq);
+
+    for (uint16_t i = 0; i < n; i++) buf[i] = ITEM(p->id, seq + i);
+
+    // a partial write only writes the first items, continue from there
+    uint16_t const written = tu_fifo_write_n(&_ff, buf, n);
+    if (written == 0) {
+      p->retry++;
+      sched_yield();
+    }
+    seq += written;
+  }
+
+  return NULL;
+}
+
+// Return number of errors
+static uint32_t run(char const* name, bool multi_producer) {
+  tu_fifo_config(&_ff, _ff_buf, _depth, sizeof(uint32_t), false);
+  tu_fifo_config_mutex(&_ff, osal_mutex_create(&_mutex_wr_def), osal_mutex_create(&_mutex_rd_def));
+  if (!tu_fifo_set_multi_producer(&_ff, multi_producer)) {
+    fprintf(stderr, "%s: failed to set multiple producer mode\n", name);
+    return 1;
+  }
+
+  // writing outside of claim must be refused
+  void* wr_ptr;
+  if (multi_producer && (tu_fifo_write_reserve(&_ff, &wr_ptr, 1) || tu_fifo_write_commit(&_ff, 1))) {
+    fprintf(stderr, "%s: reserve/commit not refused\n", name);
+    return 1;
+  }
+
+  uint32_t expected[PRODUCER_MAX] = { 0 };
+  uint64_t const total = (uint64_t) _producer_num * _item_num;
+  uint64_t received = 0;
+  uint32_t errors = 0;
+
+  double const start = time_now();
+
+  for (uint8_t i = 0; i < _producer_num; i++) {
+    _producer[i].id    = i;
+    _producer[i].count = _item_num;
+    _producer[i].retry = 0;
+    pthread_create(&_producer[i].thread, NULL, producer_thread, &_producer[i]);
+  }
+
+  // single consumer
+  uint32_t buf[READ_MAX];
+  while (received < total) {
+    uint16_t const n = tu_fifo_read_n(&_ff, buf, READ_MAX);
+    if (n == 0) {
+      sched_yield();
+      continue;
+    }
+
+    for (uint16_t i = 0; i < n; i++) {
+      uint32_t const id = ITEM_ID(buf[i]);
+      if (id >= _producer_num || ITEM_SEQ(buf[i]) != expected[id]) {
+        if (errors < 10) {
+          fprintf(stderr, "%s: item %llu got producer %u seq %u, expected seq %u\n", name,
+                  (unsigned long long) (received + i), (unsigned) id, (unsigned) ITEM_SEQ(buf[i]),
+                  id < _producer_num ? (unsigned) expected[id] : 0);
+        }
+        errors++;
+      }
+      if (id < _producer_num) expected[id] = ITEM_SEQ(buf[i]) + 1;
+    }
+    received += n;
+  }
+
+  uint32_t retry = 0;
+  for (uint8_t i = 0; i < _producer_num; i++) {
+    pthread_join(_producer[i].thread, NULL);
+    retry += _producer[i].retry;
+  }
+
+  double const elapsed = time_now() - start;
+
+  if (!tu_fifo_empty(&_ff)) {
+    fprintf(stderr, "%s: fifo not empty after all items are received\n", name);
+    errors++;
+  }
+
+  printf("%-8s %9u producers %12llu items %8.1f ms %8.2f Mitems/s %6.1f ns/item %8u full %s\n",
+         name, _producer_num, (unsigned long long) total, elapsed * 1e3, (double) total / elapsed / 1e6,
+         elapsed * 1e9 / (double) total, (unsigned) retry, errors ? "FAILED" : "OK");
+
+  // detach before delete, next run's tu_fifo_config() would lock the destroyed mutex
+  tu_fifo_config_mutex(&_ff, NULL, NULL);
+  osal_mutex_delete(&_mutex_wr_def);
+  osal_mutex_delete(&_mutex_rd_def);
+
+  return errors;
+}
+
+int main(int argc, char* argv[]) {
+  int opt;
+  while ((opt = getopt(argc, argv, "p:n:d:")) != -1) {
+    switch (opt) {
+      case 'p': _producer_num = (uint8_t) atoi(optarg); break;
+      case 'n': _item_num = (uint32_t) strtoul(optarg, NULL, 0); break;
+      case 'd': _depth = (uint16_t) atoi(optarg); break;
+      default:
+        fprintf(stderr, "usage: %s [-p producers] [-n items per producer] [-d depth]\n", argv[0]);
+        return 2;
+    }
+  }
+
+  if (_producer_num == 0 || _producer_num > PRODUCER_MAX || _item_num > ITEM_SEQ(UINT32_MAX) ||
+      _depth == 0 || _depth > DEPTH_MAX) {
+    fprintf(stderr, "invalid argument\n");
+    return 2;
+  }
+
+  uint32_t errors = 0;
+  errors += run("mutex", false);
+  errors += run("lockfree", true);
+
+  return errors ? 1 : 0;
+}
@@ -0,0 +1,248 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Ha Thach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * This file is part of the TinyUSB stack.
+ */
+
+/* Cycle count of single producer/consumer fifo operations.
+ *
+ * The same workload runs on fifos with power of two and non power of two depth. Index math is
+ * selected at compile time: built with CFG_TUSB_FIFO_POW2=1 (fifo_speed_pow2) power of two depths
+ * use mask index math and other depths are skipped since tu_fifo_config() rejects them. Data read
+ * back is verified so that both index paths are also checked for correctness.
+ *
+ * Cycles are read from the time stamp counter on x86, SysTick on Cortex-M0/M0+ (ARMv6-M) and
+ * DWT CYCCNT on Cortex-M3 and up. Other hosts fall back to nanoseconds. This file only needs printf()
+ * and can be built into a board firmware to measure on target.
+ *
+ *   fifo_speed [-n iterations]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "common/tusb_fifo.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+  #include <x86intrin.h>
+  #define CYCLE_UNIT   "cycles"
+#elif defined(__ARM_ARCH_6M__)
+  #define SYST_CSR     (*(volatile uint32_t*) 0xE000E010u)
+  #define SYST_RVR     (*(volatile uint32_t*) 0xE000E014u)
+  #define SYST_CVR     (*(volatile uint32_t*) 0xE000E018u)
+  #define CYCLE_UNIT   "cycles"
+#elif defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__) || defined(__ARM_ARCH_8M_MAIN__)
+  #define DEMCR        (*(volatile uint32_t*) 0xE000EDFCu)
+  #define DWT_CTRL     (*(volatile uint32_t*) 0xE0001000u)
+  #define DWT_CYCCNT   (*(volatile uint32_t*) 0xE0001004u)
+  #define CYCLE_UNIT   "cycles"
+#else
+  #include <time.h>
+  #define CYCLE_UNIT   "ns"
+#endif
+
+#include <unistd.h>
+
+#define DEPTH_MAX   256
+#define CHUNK       16
+#define BATCH       64 // operations between counter reads, keep SysTick 24-bit counter from wrapping
+
+#if CFG_TUSB_FIFO_POW2
+  #define POW2_NAME   "pow2 mask"
+#else
+  #define POW2_NAME   "pow2 generic"
+#endif
+
+typedef struct {
+  char const* name;
+  uint16_t depth;
+} speed_case_t;
+
+static speed_case_t const _cases[] = {
+  { .name = POW2_NAME , .depth = 64  },
+  { .name = "non-pow2", .depth = 100 },
+  { .name = POW2_NAME , .depth = 256 },
+  { .name = "non-pow2", .depth = 255 },
+};
+
+static uint32_t _iterations = 1000000;
+static tu_fifo_t _ff;
+static uint8_t _ff_buf[DEPTH_MAX];
+
+//--------------------------------------------------------------------+
+// Cycle counter
+//--------------------------------------------------------------------+
+
+static void cycles_init(void) {
+#if defined(__ARM_ARCH_6M__)
+  SYST_RVR = 0xFFFFFFu;
+  SYST_CVR = 0;
+  SYST_CSR = 0x5u; // enable, processor clock, no interrupt
+#elif defined(DWT_CYCCNT)
+  DEMCR |= (1u << 24); // TRCENA
+  DWT_CYCCNT = 0;
+  DWT_CTRL |= 1u;
+#endif
+}
+
+static inline uint32_t cycles_now(void) {
+#if defined(__x86_64__) || defined(__i386__)
+  return (uint32_t) __rdtsc();
+#elif defined(__ARM_ARCH_6M__)
+  return SYST_CVR;
+#elif defined(DWT_CYCCNT)
+  return DWT_CYCCNT;
+#else
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint32_t) ((uint64_t) ts.tv_sec * 1000000000u + (uint64_t) ts.tv_nsec);
+#endif
+}
+
+static inline uint32_t cycles_diff(uint32_t start, uint32_t end) {
+#if defined(__ARM_ARCH_6M__)
+  return (start - end) & 0xFFFFFFu; // SysTick counts down
+#else
+  return end - start;
+#endif
+}
+
+//--------------------------------------------------------------------+
+// Workload
+//--------------------------------------------------------------------+
+
+static bool setup(speed_case_t const* c) {
+  return tu_fifo_config(&_ff, _ff_buf, c->depth, 1, false);
+}
+
+// Write then read back a single item, return total cycles
+static uint64_t run_single(uint32_t* errors) {
+  uint64_t cycles = 0;
+  uint8_t wr = 0, rd = 0, data;
+
+  for (uint32_t i = 0; i < _iterations; i += BATCH) {
+    uint32_t const start = cycles_now();
+    for (uint32_t k = 0; k < BATCH; k++) {
+      tu_fifo_write(&_ff, &wr);
+      tu_fifo_read(&_ff, &data);
+      if (data != rd) (*errors)++;
+      wr++;
+      rd++;
+    }
+    cycles += cycles_diff(start, cycles_now());
+  }
+
+  return cycles;
+}
+
+// Write then read back CHUNK items, fifo is kept partially filled so that chunks also wrap
+static uint64_t run_chunk(uint32_t* errors) {
+  uint64_t cycles = 0;
+  uint8_t wr_buf[CHUNK], rd_buf[CHUNK];
+  uint8_t wr = 0;
+
+  // offset read from write by a few items
+  for (uint8_t k = 0; k < 3; k++) {
+    tu_fifo_write(&_ff, &wr);
+    wr++;
+  }
+
+  for (uint32_t i = 0; i < _iterations; i += BATCH) {
+    for (uint8_t k = 0; k < CHUNK; k++) wr_buf[k] = (uint8_t) (wr + k);
+
+    uint32_t const start = cycles_now();
+    for (uint32_t k = 0; k < BATCH; k += 2) {
+      tu_fifo_write_n(&_ff, wr_buf, CHUNK);
+      tu_fifo_read_n(&_ff, rd_buf, CHUNK);
+    }
+    cycles += cycles_diff(start, cycles_now());
+
+    // same data is written for the whole batch, check only the last chunk
+    for (uint8_t k = 0; k < CHUNK; k++) {
+      uint8_t const expected = (uint8_t) (k < 3 ? (wr + CHUNK - 3 + k) : (wr + k - 3));
+      if (rd_buf[k] != expected) (*errors)++;
+    }
+  }
+
+  return cycles;
+}
+
+// Query count and remaining
+static uint64_t run_count(uint32_t* errors) {
+  uint64_t cycles = 0;
+  uint8_t data = 0;
+  uint32_t sum = 0;
+
+  for (uint8_t k = 0; k < 5; k++) tu_fifo_write(&_ff, &data);
+
+  for (uint32_t i = 0; i < _iterations; i += BATCH) {
+    uint32_t const start = cycles_now();
+    for (uint32_t k = 0; k < BATCH; k++) {
+      sum += tu_fifo_count(&_ff) + tu_fifo_remaining(&_ff);
+    }
+    cycles += cycles_diff(start, cycles_now());
+  }
+
+  if (sum != (uint64_t) _iterations / BATCH * BATCH * tu_fifo_depth(&_ff)) (*errors)++;
+  return cycles;
+}
+
+int main(int argc, char* argv[]) {
+  int opt;
+  while ((opt = getopt(argc, argv, "n:")) != -1) {
+    switch (opt) {
+      case 'n': _iterations = (uint32_t) strtoul(optarg, NULL, 0); break;
+      default:
+        fprintf(stderr, "usage: %s [-n iterations]\n", argv[0]);
+        return 2;
+    }
+  }
+
+  // whole number of batches
+  _iterations = (_iterations + BATCH - 1) / BATCH * BATCH;
+
+  cycles_init();
+
+  printf("%-14s %6s %20s %20s %20s\n", "case", "depth",
+         "write+read " CYCLE_UNIT, "write_n+read_n " CYCLE_UNIT, "count+remain " CYCLE_UNIT);
+
+  uint32_t errors = 0;
+  for (size_t i = 0; i < sizeof(_cases) / sizeof(_cases[0]); i++) {
+    speed_case_t const* c = &_cases[i];
+    uint32_t case_errors = 0;
+
+    if (!setup(c)) continue;
+    double const single = (double) run_single(&case_errors) / _iterations;
+    setup(c);
+    double const chunk = (double) run_chunk(&case_errors) / (_iterations / 2);
+    setup(c);
+    double const count = (double) run_count(&case_errors) / _iterations;
+
+    printf("%-14s %6u %20.1f %20.1f %20.1f %s\n", c->name, c->depth, single, chunk, count,
+           case_errors ? "FAILED" : "OK");
+    errors += case_errors;
+  }
+
+  return errors ? 1 : 0;
+}
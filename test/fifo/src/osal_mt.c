@@ -0,0 +1,262 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Ha Thach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * This file is part of the TinyUSB stack.
+ */
+
+/* Multithreaded test of the POSIX osal (OPT_OS_POSIX)
+ *
+ *  - queue: producer threads post events, a task thread receives with timeout, order is checked per producer
+ *  - semaphore/mutex: timed wait expires and wakes up on post/unlock from another thread
+ *  - mutex: threads increment a shared counter, contention is reported as failed try-locks
+ *
+ * Clean with ThreadSanitizer: make FIFO_CFLAGS=-fsanitize=thread FIFO_LDFLAGS=-fsanitize=thread
+ *
+ *   osal_mt [-t threads] [-n iterations per thread]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+
+#include "tusb.h"
+
+#define THREAD_MAX  16
+#define QUEUE_DEPTH 16
+
+#define ITEM(_id, _seq)  (((uint32_t) (_id) << 24) | (_seq))
+#define ITEM_ID(_item)   ((_item) >> 24)
+#define ITEM_SEQ(_item)  ((_item) & 0xFFFFFFu)
+
+typedef struct {
+  pthread_t thread;
+  uint8_t   id;
+  uint32_t  retry; // queue full / lock contended
+} worker_t;
+
+static worker_t _worker[THREAD_MAX];
+static uint8_t  _thread_num = 4;
+static uint32_t _iter_num = 100000;
+
+static double time_now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double) ts.tv_sec + (double) ts.tv_nsec * 1e-9;
+}
+
+static uint32_t report(char const* name, double start, uint32_t errors, char const* fmt, uint32_t value) {
+  printf("%-10s %8.1f ms  ", name, (time_now() - start) * 1e3);
+  printf(fmt, (unsigned) value);
+  printf(" %s\n", errors ? "FAILED" : "OK");
+  return errors;
+}
+
+static void start_workers(void* (*func)(void*)) {
+  for (uint8_t i = 0; i < _thread_num; i++) {
+    _worker[i].id    = i;
+    _worker[i].retry = 0;
+    pthread_create(&_worker[i].thread, NULL, func, &_worker[i]);
+  }
+}
+
+static uint32_t join_workers(void) {
+  uint32_t retry = 0;
+  for (uint8_t i = 0; i < _thread_num; i++) {
+    pthread_join(_worker[i].thread, NULL);
+    retry += _worker[i].retry;
+  }
+  return retry;
+}
+
+//--------------------------------------------------------------------+
+// Queue: producers as ISR, single consumer as task
+//--------------------------------------------------------------------+
+OSAL_QUEUE_DEF(NULL, _qdef, QUEUE_DEPTH, uint32_t);
+static osal_queue_t _q;
+
+static void* queue_producer(void* arg) {
+  worker_t* w = (worker_t*) arg;
+  for (uint32_t seq = 0; seq < _iter_num; seq++) {
+    uint32_t const item = ITEM(w->id, seq);
+    while (!osal_queue_send(_q, &item, true)) {
+      w->retry++;
+      sched_yield();
+    }
+  }
+  return NULL;
+}
+
+static uint32_t test_queue(void) {
+  double const start = time_now();
+  uint32_t errors = 0;
+  uint32_t expected[THREAD_MAX] = { 0 };
+
+  _q = osal_queue_create(&_qdef);
+
+  // nothing posted yet: times out
+  uint32_t item;
+  if (osal_queue_receive(_q, &item, 10) || !osal_queue_empty(_q)) errors++;
+
+  start_workers(queue_producer);
+
+  uint64_t const total = (uint64_t) _thread_num * _iter_num;
+  for (uint64_t received = 0; received < total; received++) {
+    if (!osal_queue_receive(_q, &item, 1000)) {
+      fprintf(stderr, "queue: timeout after %llu items\n", (unsigned long long) received);
+      errors++;
+      break;
+    }
+
+    uint32_t const id = ITEM_ID(item);
+    if (id >= _thread_num || ITEM_SEQ(item) != expected[id]) {
+      errors++;
+    } else {
+      expected[id]++;
+    }
+  }
+
+  uint32_t const retry = join_workers();
+  if (!osal_queue_empty(_q)) errors++;
+  osal_queue_delete(_q);
+
+  return report("queue", start, errors, "%8u full", retry);
+}
+
+//--------------------------------------------------------------------+
+// Semaphore and mutex timeout
+//--------------------------------------------------------------------+
+static osal_semaphore_def_t _sem_def;
+static osal_mutex_def_t _mutex_def;
+
+static void* sem_poster(void* arg) {
+  (void) arg;
+  osal_task_delay(20);
+  osal_semaphore_post(&_sem_def, true);
+  return NULL;
+}
+
+static void* mutex_holder(void* arg) {
+  (void) arg;
+  osal_mutex_lock(&_mutex_def, OSAL_TIMEOUT_WAIT_FOREVER);
+  osal_task_delay(50);
+  osal_mutex_unlock(&_mutex_def);
+  return NULL;
+}
+
+static uint32_t test_timeout(void) {
+  double const start = time_now();
+  uint32_t errors = 0;
+  pthread_t thread;
+
+  osal_semaphore_t sem = osal_semaphore_create(&_sem_def);
+  osal_mutex_t mutex = osal_mutex_create(&_mutex_def);
+
+  // expires without post
+  double t0 = time_now();
+  if (osal_semaphore_wait(sem, 20)) errors++;
+  if (time_now() - t0 < 0.019) errors++;
+
+  // woken up by post from other thread before timeout
+  pthread_create(&thread, NULL, sem_poster, NULL);
+  if (!osal_semaphore_wait(sem, 2000)) errors++;
+  pthread_join(thread, NULL);
+
+  // count is kept: posted twice, taken twice without waiting
+  osal_semaphore_post(sem, false);
+  osal_semaphore_post(sem, false);
+  if (!osal_semaphore_wait(sem, 0) || !osal_semaphore_wait(sem, 0) || osal_semaphore_wait(sem, 0)) errors++;
+
+  // mutex held by other thread: short wait expires, long wait succeeds once it is unlocked
+  pthread_create(&thread, NULL, mutex_holder, NULL);
+  osal_task_delay(10);
+  if (osal_mutex_lock(mutex, 0)) errors++;
+  if (osal_mutex_lock(mutex, 10)) errors++;
+  if (!osal_mutex_lock(mutex, 2000)) errors++;
+  osal_mutex_unlock(mutex);
+  pthread_join(thread, NULL);
+
+  osal_semaphore_delete(sem);
+  osal_mutex_delete(mutex);
+
+  return report("timeout", start, errors, "%13u", 0);
+}
+
+//--------------------------------------------------------------------+
+// Mutex contention
+//--------------------------------------------------------------------+
+static uint32_t _counter;
+
+static void* mutex_worker(void* arg) {
+  worker_t* w = (worker_t*) arg;
+  for (uint32_t i = 0; i < _iter_num; i++) {
+    if (!osal_mutex_lock(&_mutex_def, 0)) {
+      w->retry++;
+      osal_mutex_lock(&_mutex_def, OSAL_TIMEOUT_WAIT_FOREVER);
+    }
+    _counter++;
+    osal_mutex_unlock(&_mutex_def);
+  }
+  return NULL;
+}
+
+static uint32_t test_mutex(void) {
+  double const start = time_now();
+  osal_mutex_create(&_mutex_def);
+
+  _counter = 0;
+  start_workers(mutex_worker);
+  uint32_t const retry = join_workers();
+
+  uint32_t const errors = (_counter == _thread_num * _iter_num) ? 0 : 1;
+  osal_mutex_delete(&_mutex_def);
+
+  return report("mutex", start, errors, "%8u contended", retry);
+}
+
+int main(int argc, char* argv[]) {
+  int opt;
+  while ((opt = getopt(argc, argv, "t:n:")) != -1) {
+    switch (opt) {
+      case 't': _thread_num = (uint8_t) atoi(optarg); break;
+      case 'n': _iter_num = (uint32_t) strtoul(optarg, NULL, 0); break;
+      default:
+        fprintf(stderr, "usage: %s [-t threads] [-n iterations per thread]\n", argv[0]);
+        return 2;
+    }
+  }
+
+  if (_thread_num == 0 || _thread_num > THREAD_MAX || _iter_num > ITEM_SEQ(UINT32_MAX)) {
+    fprintf(stderr, "invalid argument\n");
+    return 2;
+  }
+
+  uint32_t errors = 0;
+  errors += test_queue();
+  errors += test_timeout();
+  errors += test_mutex();
+
+  return errors ? 1 : 0;
+}
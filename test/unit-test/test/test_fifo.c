@@ -303,6 +303,229 @@ void test_get_write_info_when_wrapped()
   TEST_ASSERT_EQUAL_PTR(ff->buffer, info.ptr_wrap);
 }
 
+void test_write_reserve_commit(void)
+{
+  tu_fifo_set_overwritable(ff, false);
+
+  void* ptr;
+  uint16_t n = tu_fifo_write_reserve(ff, &ptr, 10);
+
+  TEST_ASSERT_EQUAL(10, n);
+  TEST_ASSERT_EQUAL_PTR(ff->buffer, ptr);
+
+  // nothing is visible until committed
+  memcpy(ptr, test_data, n);
+  TEST_ASSERT_TRUE(tu_fifo_empty(ff));
+
+  TEST_ASSERT_EQUAL(10, tu_fifo_write_commit(ff, n));
+  TEST_ASSERT_EQUAL(10, tu_fifo_count(ff));
+
+  TEST_ASSERT_EQUAL(10, tu_fifo_read_n(ff, rd_buf, FIFO_SIZE));
+  TEST_ASSERT_EQUAL_MEMORY(test_data, rd_buf, 10);
+}
+
+void test_write_reserve_when_wrapped(void)
+{
+  tu_fifo_set_overwritable(ff, false);
+
+  // wr = rd = 60
+  tu_fifo_write_n(ff, test_data, 60);
+  tu_fifo_read_n(ff, rd_buf, 60);
+
+  void* ptr;
+
+  // only linear part up to end of buffer
+  uint16_t n = tu_fifo_write_reserve(ff, &ptr, 10);
+  TEST_ASSERT_EQUAL(FIFO_SIZE-60, n);
+  TEST_ASSERT_EQUAL_PTR(ff->buffer+60, ptr);
+
+  memcpy(ptr, test_data, n);
+  tu_fifo_write_commit(ff, n);
+
+  // wrapped part starts at beginning of buffer
+  n = tu_fifo_write_reserve(ff, &ptr, 10 - n);
+  TEST_ASSERT_EQUAL(6, n);
+  TEST_ASSERT_EQUAL_PTR(ff->buffer, ptr);
+
+  memcpy(ptr, test_data + 4, n);
+  tu_fifo_write_commit(ff, n);
+
+  TEST_ASSERT_EQUAL(10, tu_fifo_read_n(ff, rd_buf, FIFO_SIZE));
+  TEST_ASSERT_EQUAL_MEMORY(test_data, rd_buf, 10);
+}
+
+void test_write_reserve_when_full(void)
+{
+  tu_fifo_set_overwritable(ff, false);
+
+  tu_fifo_write_n(ff, test_data, FIFO_SIZE);
+
+  void* ptr;
+  TEST_ASSERT_EQUAL(0, tu_fifo_write_reserve(ff, &ptr, 1));
+  TEST_ASSERT_NULL(ptr);
+
+  // commit is limited to free space
+  TEST_ASSERT_EQUAL(0, tu_fifo_write_commit(ff, 1));
+  TEST_ASSERT_EQUAL(FIFO_SIZE, tu_fifo_count(ff));
+
+  // free up 2 slots at beginning of buffer
+  tu_fifo_read_n(ff, rd_buf, 2);
+  TEST_ASSERT_EQUAL(2, tu_fifo_write_reserve(ff, &ptr, 10));
+  TEST_ASSERT_EQUAL_PTR(ff->buffer, ptr);
+
+  TEST_ASSERT_EQUAL(2, tu_fifo_write_commit(ff, 10));
+  TEST_ASSERT_TRUE(tu_fifo_full(ff));
+}
+
+void test_write_reserve_overwritable(void)
+{
+  tu_fifo_set_overwritable(ff, true);
+
+  // full, wr = rd + depth
+  tu_fifo_write_n(ff, test_data, FIFO_SIZE);
+
+  void* ptr;
+  uint16_t n = tu_fifo_write_reserve(ff, &ptr, 8);
+  TEST_ASSERT_EQUAL(8, n);
+  TEST_ASSERT_EQUAL_PTR(ff->buffer, ptr);
+
+  memcpy(ptr, test_data + FIFO_SIZE, n);
+  tu_fifo_write_commit(ff, n);
+
+  TEST_ASSERT_TRUE(tu_fifo_overflowed(ff));
+
+  // reading back gives the latest FIFO_SIZE items
+  TEST_ASSERT_EQUAL(FIFO_SIZE, tu_fifo_read_n(ff, rd_buf, FIFO_SIZE));
+  TEST_ASSERT_EQUAL_MEMORY(test_data+8, rd_buf, FIFO_SIZE);
+}
+
+void test_write_commit_double_overflowed(void)
+{
+  tu_fifo_set_overwritable(ff, true);
+
+  void* ptr;
+  uint8_t const* buf = test_data;
+
+  // write 2*FIFO_SIZE + 16 items in chunks of 16 without any read
+  for(uint16_t i=0; i < 2*FIFO_SIZE+16; i += 16)
+  {
+    uint16_t n = tu_fifo_write_reserve(ff, &ptr, 16);
+    TEST_ASSERT_EQUAL(16, n);
+
+    memcpy(ptr, buf, n);
+    buf += tu_fifo_write_commit(ff, n);
+  }
+
+  TEST_ASSERT_EQUAL(FIFO_SIZE, tu_fifo_count(ff));
+
+  // data is committed in place, the whole buffer can be recovered
+  TEST_ASSERT_EQUAL(FIFO_SIZE, tu_fifo_read_n(ff, rd_buf, FIFO_SIZE));
+  TEST_ASSERT_EQUAL_MEMORY(buf-FIFO_SIZE, rd_buf, FIFO_SIZE);
+}
+
+void test_read_reserve_commit(void)
+{
+  tu_fifo_set_overwritable(ff, false);
+
+  void* ptr;
+  TEST_ASSERT_EQUAL(0, tu_fifo_read_reserve(ff, &ptr, 1));
+  TEST_ASSERT_NULL(ptr);
+
+  tu_fifo_write_n(ff, test_data, 20);
+
+  uint16_t n = tu_fifo_read_reserve(ff, &ptr, FIFO_SIZE);
+  TEST_ASSERT_EQUAL(20, n);
+  TEST_ASSERT_EQUAL_PTR(ff->buffer, ptr);
+  TEST_ASSERT_EQUAL_MEMORY(test_data, ptr, n);
+
+  // partially consume
+  TEST_ASSERT_EQUAL(5, tu_fifo_read_commit(ff, 5));
+  TEST_ASSERT_EQUAL(15, tu_fifo_count(ff));
+
+  n = tu_fifo_read_reserve(ff, &ptr, FIFO_SIZE);
+  TEST_ASSERT_EQUAL(15, n);
+  TEST_ASSERT_EQUAL_PTR(ff->buffer+5, ptr);
+
+  // commit is limited to available items
+  TEST_ASSERT_EQUAL(15, tu_fifo_read_commit(ff, 100));
+  TEST_ASSERT_TRUE(tu_fifo_empty(ff));
+}
+
+void test_read_reserve_when_wrapped(void)
+{
+  tu_fifo_set_overwritable(ff, false);
+
+  // rd = 60, wr = 70 -> 6
+  tu_fifo_write_n(ff, test_data, 60);
+  tu_fifo_read_n(ff, rd_buf, 60);
+  tu_fifo_write_n(ff, test_data, 10);
+
+  void* ptr;
+  uint16_t n = tu_fifo_read_reserve(ff, &ptr, FIFO_SIZE);
+  TEST_ASSERT_EQUAL(4, n);
+  TEST_ASSERT_EQUAL_PTR(ff->buffer+60, ptr);
+  TEST_ASSERT_EQUAL_MEMORY(test_data, ptr, n);
+  tu_fifo_read_commit(ff, n);
+
+  n = tu_fifo_read_reserve(ff, &ptr, FIFO_SIZE);
+  TEST_ASSERT_EQUAL(6, n);
+  TEST_ASSERT_EQUAL_PTR(ff->buffer, ptr);
+  TEST_ASSERT_EQUAL_MEMORY(test_data+4, ptr, n);
+  tu_fifo_read_commit(ff, n);
+
+  TEST_ASSERT_TRUE(tu_fifo_empty(ff));
+}
+
+void test_read_reserve_overflowed(void)
+{
+  tu_fifo_set_overwritable(ff, true);
+
+  tu_fifo_write_n(ff, test_data, FIFO_SIZE);
+  tu_fifo_write_n(ff, test_data+FIFO_SIZE, 8);
+  TEST_ASSERT_TRUE(tu_fifo_overflowed(ff));
+
+  // read index is corrected to the oldest valid item
+  void* ptr;
+  uint16_t n = tu_fifo_read_reserve(ff, &ptr, FIFO_SIZE);
+  TEST_ASSERT_FALSE(tu_fifo_overflowed(ff));
+  TEST_ASSERT_EQUAL(FIFO_SIZE-8, n);
+  TEST_ASSERT_EQUAL_PTR(ff->buffer+8, ptr);
+  TEST_ASSERT_EQUAL_MEMORY(test_data+8, ptr, n);
+
+  // writer overruns the reserved region, consumed items are dropped
+  tu_fifo_write_n(ff, test_data, 8);
+  TEST_ASSERT_EQUAL(0, tu_fifo_read_commit(ff, n));
+  TEST_ASSERT_EQUAL(FIFO_SIZE, tu_fifo_count(ff));
+}
+
+void test_reserve_item_size(void)
+{
+  uint8_t ff4_buf[FIFO_SIZE * sizeof(uint32_t)];
+  tu_fifo_t ff4 = TU_FIFO_INIT(ff4_buf, FIFO_SIZE, uint32_t, false);
+
+  // wr = rd = FIFO_SIZE-2
+  uint32_t data4[FIFO_SIZE];
+  for(uint32_t i=0; i<FIFO_SIZE; i++) data4[i] = i;
+  tu_fifo_write_n(&ff4, data4, FIFO_SIZE-2);
+  tu_fifo_read_n(&ff4, data4, FIFO_SIZE-2);
+
+  void* ptr;
+  TEST_ASSERT_EQUAL(2, tu_fifo_write_reserve(&ff4, &ptr, 4));
+  TEST_ASSERT_EQUAL_PTR(ff4_buf + (FIFO_SIZE-2)*sizeof(uint32_t), ptr);
+
+  uint32_t val[2] = { 0x11111111, 0x22222222 };
+  memcpy(ptr, val, sizeof(val));
+  tu_fifo_write_commit(&ff4, 2);
+
+  uint32_t rd4;
+  tu_fifo_read(&ff4, &rd4);
+  TEST_ASSERT_EQUAL_HEX32(0x11111111, rd4);
+
+  TEST_ASSERT_EQUAL(1, tu_fifo_read_reserve(&ff4, &ptr, 4));
+  TEST_ASSERT_EQUAL_PTR(ff4_buf + (FIFO_SIZE-1)*sizeof(uint32_t), ptr);
+  TEST_ASSERT_EQUAL_HEX32(0x22222222, *(uint32_t*) ptr);
+}
+
 void test_empty(void)
 {
   uint8_t temp;
@@ -376,3 +599,51 @@ void test_rd_idx_wrap()
   TEST_ASSERT_EQUAL(n, 2);
   TEST_ASSERT_EQUAL(ff10.rd_idx, 6);
 }
+
+void test_config_depth_max(void)
+{
+  tu_fifo_t ff_max;
+  uint8_t buf[1];
+
+  // config only records buffer, nothing is accessed
+  TEST_ASSERT_FALSE(tu_fifo_config(&ff_max, buf, TU_FIFO_DEPTH_MAX + 1, 1, false));
+  TEST_ASSERT_TRUE(tu_fifo_config(&ff_max, buf, TU_FIFO_DEPTH_MAX, 1, false));
+  TEST_ASSERT_EQUAL(TU_FIFO_DEPTH_MAX, tu_fifo_depth(&ff_max));
+}
+
+#if CFG_TUSB_FIFO_WIDE_INDEX
+void test_wide_index(void)
+{
+  enum { WIDE_DEPTH = 0x18000 };
+  static uint8_t buf[WIDE_DEPTH];
+  static uint8_t src[WIDE_DEPTH];
+  static uint8_t dst[WIDE_DEPTH];
+  tu_fifo_t ff_wide;
+
+  for(uint32_t i=0; i<WIDE_DEPTH; i++) src[i] = (uint8_t) (i*7);
+  TEST_ASSERT_TRUE(tu_fifo_config(&ff_wide, buf, WIDE_DEPTH, 1, false));
+
+  // write more than 16-bit worth of items at once, wrap around 2*depth twice
+  for(uint32_t round=0; round<4; round++)
+  {
+    TEST_ASSERT_EQUAL(WIDE_DEPTH, tu_fifo_write_n(&ff_wide, src, WIDE_DEPTH));
+    TEST_ASSERT_TRUE(tu_fifo_full(&ff_wide));
+    TEST_ASSERT_EQUAL(WIDE_DEPTH, tu_fifo_count(&ff_wide));
+
+    TEST_ASSERT_EQUAL(0x10000, tu_fifo_read_n(&ff_wide, dst, 0x10000));
+    TEST_ASSERT_EQUAL(WIDE_DEPTH - 0x10000, tu_fifo_read_n(&ff_wide, dst + 0x10000, WIDE_DEPTH));
+    TEST_ASSERT_EQUAL_MEMORY(src, dst, WIDE_DEPTH);
+    TEST_ASSERT_TRUE(tu_fifo_empty(&ff_wide));
+  }
+}
+#endif
+
+void test_pow2_depth_config(void)
+{
+  uint8_t buf[17];
+  tu_fifo_t ff;
+
+  // CFG_TUSB_FIFO_POW2 compiles index math as mask, other depth is rejected
+  TEST_ASSERT_TRUE(tu_fifo_config(&ff, buf, 16, 1, false));
+  TEST_ASSERT_EQUAL(!CFG_TUSB_FIFO_POW2, tu_fifo_config(&ff, buf, 17, 1, false));
+}
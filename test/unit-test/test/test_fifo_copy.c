@@ -0,0 +1,170 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Ha Thach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * This file is part of the TinyUSB stack.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "unity.h"
+
+#include "osal/osal.h"
+#include "tusb_fifo_copy.h"
+
+typedef void (*copy_kernel_t)(void* dst, void const* src, uint32_t len);
+
+typedef struct
+{
+  char const* name;
+  copy_kernel_t copy;
+} kernel_t;
+
+static void kernel_memcpy  (void* dst, void const* src, uint32_t len) { tu_fifo_copy_memcpy  (dst, src, len); }
+static void kernel_word    (void* dst, void const* src, uint32_t len) { tu_fifo_copy_word    (dst, src, len); }
+static void kernel_unrolled(void* dst, void const* src, uint32_t len) { tu_fifo_copy_unrolled(dst, src, len); }
+static void kernel_simd    (void* dst, void const* src, uint32_t len) { tu_fifo_copy_simd    (dst, src, len); }
+
+static kernel_t const kernels[] =
+{
+  { "memcpy"  , kernel_memcpy   },
+  { "word"    , kernel_word     },
+  { "unrolled", kernel_unrolled },
+  { "simd"    , kernel_simd     },
+};
+
+#define KERNEL_NUM   (sizeof(kernels)/sizeof(kernels[0]))
+
+#define BUF_SIZE     600
+#define GUARD        0xA5
+
+CFG_TUSB_MEM_ALIGN uint8_t src_buf[BUF_SIZE];
+CFG_TUSB_MEM_ALIGN uint8_t dst_buf[BUF_SIZE + 8];
+
+void setUp(void)
+{
+  for(uint32_t i=0; i<BUF_SIZE; i++) src_buf[i] = (uint8_t) (i*13 + 1);
+  memset(dst_buf, GUARD, sizeof(dst_buf));
+}
+
+void tearDown(void)
+{
+}
+
+//--------------------------------------------------------------------+
+// Tests
+//--------------------------------------------------------------------+
+
+// all length with every combination of source and destination alignment, including mis-matched ones
+void test_kernels_copy(void)
+{
+  for(uint32_t k=0; k<KERNEL_NUM; k++)
+  {
+    for(uint32_t src_ofs=0; src_ofs<4; src_ofs++)
+    {
+      for(uint32_t dst_ofs=0; dst_ofs<4; dst_ofs++)
+      {
+        for(uint32_t len=0; len<70; len++)
+        {
+          memset(dst_buf, GUARD, sizeof(dst_buf));
+          kernels[k].copy(dst_buf + dst_ofs, src_buf + src_ofs, len);
+
+          if (dst_ofs) TEST_ASSERT_EACH_EQUAL_HEX8_MESSAGE(GUARD, dst_buf, dst_ofs, kernels[k].name);
+          if (len) TEST_ASSERT_EQUAL_MEMORY_MESSAGE(src_buf + src_ofs, dst_buf + dst_ofs, len, kernels[k].name);
+          TEST_ASSERT_EQUAL_HEX8_MESSAGE(GUARD, dst_buf[dst_ofs + len], kernels[k].name);
+        }
+      }
+    }
+  }
+}
+
+// selected kernel is one of above
+void test_selected_kernel(void)
+{
+  tu_fifo_copy(dst_buf + 1, src_buf + 1, 37);
+  TEST_ASSERT_EQUAL_MEMORY(src_buf + 1, dst_buf + 1, 37);
+  TEST_ASSERT_EQUAL_HEX8(GUARD, dst_buf[0]);
+  TEST_ASSERT_EQUAL_HEX8(GUARD, dst_buf[38]);
+}
+
+//--------------------------------------------------------------------+
+// Benchmark
+//--------------------------------------------------------------------+
+
+// Emulate fifo write_n + read_n of 'count' items: the copy is split into linear and wrapped part
+// at 'wrap' item offset, exactly as _ff_push_n()/_ff_pull_n() do.
+static double bench_kernel(copy_kernel_t copy, uint16_t item_size, uint16_t count, uint16_t wrap)
+{
+  enum { ROUNDS = 2000 };
+  static uint8_t ff_buf[BUF_SIZE];
+
+  uint32_t const lin_bytes  = (uint32_t) wrap * item_size;
+  uint32_t const wrap_bytes = (uint32_t) (count - wrap) * item_size;
+  uint8_t* const ff_lin = ff_buf + sizeof(ff_buf) - lin_bytes;
+
+  clock_t const start = clock();
+  for(uint32_t r=0; r<ROUNDS; r++)
+  {
+    // push
+    copy(ff_lin, src_buf, lin_bytes);
+    copy(ff_buf, src_buf + lin_bytes, wrap_bytes);
+
+    // pull
+    copy(dst_buf, ff_lin, lin_bytes);
+    copy(dst_buf + lin_bytes, ff_buf, wrap_bytes);
+  }
+  clock_t const elapsed = clock() - start;
+
+  TEST_ASSERT_EQUAL_MEMORY(src_buf, dst_buf, lin_bytes + wrap_bytes);
+
+  // nanoseconds per byte
+  return ((double) elapsed * 1e9 / CLOCKS_PER_SEC) / ((double) ROUNDS * 2 * (lin_bytes + wrap_bytes));
+}
+
+void test_kernels_benchmark(void)
+{
+  uint16_t const item_sizes[] = { 1, 2, 3, 4, 8, 12 };
+
+  printf("\n%-10s %9s %10s", "item_size", "count", "wrap");
+  for(uint32_t k=0; k<KERNEL_NUM; k++) printf(" %10s", kernels[k].name);
+  printf("   (ns/byte)\n");
+
+  for(uint32_t i=0; i<sizeof(item_sizes)/sizeof(item_sizes[0]); i++)
+  {
+    uint16_t const item_size = item_sizes[i];
+    uint16_t const count = (uint16_t) (512 / item_size);
+
+    // no wrap, wrap at middle and wrap at odd position so that wrapped part is misaligned
+    uint16_t const wraps[] = { count, (uint16_t) (count/2), (uint16_t) (count/2 + 1) };
+
+    for(uint32_t w=0; w<sizeof(wraps)/sizeof(wraps[0]); w++)
+    {
+      printf("%-10u %9u %10u", item_size, count, wraps[w]);
+      for(uint32_t k=0; k<KERNEL_NUM; k++)
+      {
+        printf(" %10.3f", bench_kernel(kernels[k].copy, item_size, count, wraps[w]));
+      }
+      printf("\n");
+    }
+  }
+}
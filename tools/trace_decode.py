@@ -0,0 +1,175 @@
+#!/usr/bin/env python3
+"""Decode TinyUSB binary trace (CFG_TUSB_TRACE) into the text printed by CFG_TUSB_DEBUG logging.
+
+Input is either a raw stream of 16-byte records e.g RTT channel captured with JLinkRTTLogger, or with --ring
+a memory dump of the trace ring (wr_idx, rd_idx followed by CFG_TUSB_TRACE_SIZE records) e.g from gdb:
+    dump binary value trace.bin _tusb_trace
+
+Record layout and IDs must be kept in sync with src/common/tusb_debug.h
+"""
+import argparse
+import struct
+import sys
+
+RECORD = struct.Struct('<IBBHII')  # time, id, arg0, arg1, arg2, arg3
+
+TU_TRACE_LOST = 0
+TU_TRACE_USBD_EVENT = 1
+TU_TRACE_USBD_SETUP = 2
+TU_TRACE_USBD_XFER = 3
+TU_TRACE_USBD_QUEUE = 4
+TU_TRACE_USBD_STALL = 5
+TU_TRACE_USBH_ATTACH = 6
+TU_TRACE_USBH_REMOVE = 7
+TU_TRACE_USBH_XFER = 8
+TU_TRACE_USBH_XFER_CB = 9
+TU_TRACE_USBH_QUEUE = 10
+TU_TRACE_USER = 0x80
+
+QUEUE_STARTED = 0
+QUEUE_PENDING = 1
+QUEUE_FAILED = 2
+QUEUE_START_FAILED = 3
+QUEUE_ISO_STARTED = 4
+QUEUE_ISO_FAILED = 5
+
+DCD_EVENT_BUS_RESET = 1
+DCD_EVENT_SUSPEND = 4
+DCD_EVENT_RESUME = 5
+
+usbd_event_str = ['Invalid', 'Bus Reset', 'Unplugged', 'SOF', 'Suspend', 'Resume', 'Setup Received',
+                  'Xfer Complete', 'Func Call']
+speed_str = ['Full', 'Low', 'High']
+xfer_result_str = ['OK', 'FAILED', 'STALLED', 'TIMEOUT']
+
+
+def lookup(table, idx):
+    return table[idx] if idx < len(table) else f'0x{idx:08X}'
+
+
+class Decoder:
+    def __init__(self, usbd_drivers, usbh_drivers):
+        self.usbd_drivers = usbd_drivers
+        self.usbh_drivers = usbh_drivers
+
+    @staticmethod
+    def driver_name(drivers, drv_id):
+        return drivers[drv_id] if drv_id < len(drivers) else f'driver[{drv_id}]'
+
+    def usbd_event(self, event_id, detail, skipped):
+        text = f'USBD {lookup(usbd_event_str, event_id)} '
+        if skipped:
+            return text + ' Skipped\r\n'
+        if event_id == DCD_EVENT_BUS_RESET:
+            return text + f': {lookup(speed_str, detail)} Speed\r\n'
+        if event_id == DCD_EVENT_SUSPEND:
+            return text + f': Remote Wakeup = {detail}\r\n'
+        return text + '\r\n'
+
+    def usbd_queue(self, ep_addr, pending, length, kind):
+        if kind == QUEUE_STARTED:
+            return f'  Queue EP {ep_addr:02X} with {length} bytes ...\r\n'
+        if kind == QUEUE_PENDING:
+            return f'  Queue EP {ep_addr:02X} with {length} bytes (pending {pending})\r\n'
+        if kind == QUEUE_FAILED:
+            return 'FAILED\r\n'
+        if kind == QUEUE_START_FAILED:
+            return f'  Queued EP {ep_addr:02X} FAILED\r\n'
+        iso = 'OK' if kind == QUEUE_ISO_STARTED else 'failed'
+        return f'  Queue ISO EP {ep_addr:02X} with {length} bytes ... {iso}\r\n'
+
+    def decode(self, rec_id, arg0, arg1, arg2, arg3):
+        if rec_id == TU_TRACE_LOST:
+            return f'*** {arg2} trace records lost ***\r\n'
+
+        if rec_id == TU_TRACE_USBD_EVENT:
+            return self.usbd_event(arg0, arg1, arg3)
+
+        if rec_id == TU_TRACE_USBD_SETUP:
+            setup = struct.pack('<II', arg2, arg3)
+            text = '\r\nUSBD Setup Received ' + ''.join(f'{b:02X} ' for b in setup) + '\r\n'
+            if arg0:
+                text += '  Skipped since there is other SETUP in queue\r\n'
+            return text
+
+        if rec_id == TU_TRACE_USBD_XFER:
+            text = f'USBD Xfer Complete on EP {arg0:02X} with {arg2} bytes\r\n'
+            if arg3:
+                text += '  Skipped since queued before bus reset\r\n'
+            elif arg1 != 0xFF:
+                text += f'  {self.driver_name(self.usbd_drivers, arg1)} xfer callback\r\n'
+            return text
+
+        if rec_id == TU_TRACE_USBD_QUEUE:
+            return self.usbd_queue(arg0, arg1, arg2, arg3)
+
+        if rec_id == TU_TRACE_USBD_STALL:
+            if arg1 == 2:
+                return '  Stall EP0\r\n'
+            return f'    {"Stall" if arg1 else "Clear Stall"} EP {arg0:02X}\r\n'
+
+        if rec_id == TU_TRACE_USBH_ATTACH:
+            if arg1:
+                return f'[{arg0}:] USBH Defer Attach until current enumeration complete\r\n'
+            return f'[{arg0}:] USBH DEVICE ATTACH\r\n'
+
+        if rec_id == TU_TRACE_USBH_REMOVE:
+            return f'[{arg0}:{arg1 & 0xFF}:{arg1 >> 8}] USBH DEVICE REMOVED\r\n'
+
+        if rec_id == TU_TRACE_USBH_XFER:
+            return f'on EP {arg0:02X} with {arg2} bytes: {lookup(xfer_result_str, arg3)}\r\n'
+
+        if rec_id == TU_TRACE_USBH_XFER_CB:
+            return f'{self.driver_name(self.usbh_drivers, arg0)} xfer callback\r\n'
+
+        if rec_id == TU_TRACE_USBH_QUEUE:
+            status = 'OK' if arg3 == QUEUE_STARTED else 'Failed'
+            return f'  Queue EP {arg0:02X} with {arg2} bytes ... \r\n{status}\r\n'
+
+        return f'trace {rec_id:02X}: {arg0:02X} {arg1:04X} {arg2:08X} {arg3:08X}\r\n'
+
+
+def read_records(data, ring):
+    """Return list of record tuples in write order"""
+    if not ring:
+        count = len(data) // RECORD.size
+        return [RECORD.unpack_from(data, i * RECORD.size) for i in range(count)]
+
+    wr_idx, _ = struct.unpack_from('<II', data, 0)
+    size = (len(data) - 8) // RECORD.size
+    # wr_idx is free-running, ring holds the latest 'size' records
+    count = min(wr_idx, size)
+    first = wr_idx - count
+    return [RECORD.unpack_from(data, 8 + ((first + i) % size) * RECORD.size) for i in range(count)]
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('file', help='binary trace file, - for stdin')
+    parser.add_argument('--ring', action='store_true', help='file is a memory dump of trace ring')
+    parser.add_argument('--time', action='store_true', help='prefix each record with its time stamp')
+    parser.add_argument('--usbd-drivers', default='', help='comma separated device driver names in driver id order')
+    parser.add_argument('--usbh-drivers', default='', help='comma separated host driver names in driver id order')
+    args = parser.parse_args()
+
+    if args.file == '-':
+        data = sys.stdin.buffer.read()
+    else:
+        with open(args.file, 'rb') as f:
+            data = f.read()
+
+    decoder = Decoder([d for d in args.usbd_drivers.split(',') if d],
+                      [d for d in args.usbh_drivers.split(',') if d])
+
+    out = sys.stdout.buffer
+    for time, rec_id, arg0, arg1, arg2, arg3 in read_records(data, args.ring):
+        text = decoder.decode(rec_id, arg0, arg1, arg2, arg3)
+        if args.time:
+            # keep leading blank line of SETUP before time stamp
+            body = text.lstrip('\r\n')
+            text = text[:len(text) - len(body)] + f'[{time:10}] ' + body
+        out.write(text.encode())
+
+
+if __name__ == '__main__':
+    main()